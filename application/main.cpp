@@ -45,7 +45,7 @@ int main()
     // auto tree_root = make_primitive_node_by_move(extrude);
 
     std::cout << "Setting environments..." << std::endl;
-    setting_descriptor setting_desc{21, 1e-5};
+    setting_descriptor setting_desc{21, 1e-5, 0};
     update_setting(setting_desc);
     update_environment(&tree_root);
 
@@ -54,6 +54,15 @@ int main()
     std::cout << "Surface integral result: " << result.surf_int_result << std::endl;
     std::cout << "Volume integral result: " << result.vol_int_result << std::endl;
 
+    const auto statistics = get_solver_statistics();
+    std::cout << "Active functions per tet:";
+    for (const auto& tet_count : statistics.tets_by_active_function_count) std::cout << " " << tet_count;
+    std::cout << std::endl;
+    std::cout << "Arrangements from the LUT: " << statistics.lut_hits << ", untabulated: " << statistics.lut_misses
+              << " (cache hits: " << statistics.cache_hits << ", misses: " << statistics.cache_misses << ")" << std::endl;
+    std::cout << "Tets with coplanar planes: " << statistics.coplanar_tet_count
+              << ", degenerate vertices: " << statistics.degenerate_vertex_count << std::endl;
+
     std::cout << "Time statistics: " << std::endl;
     print_statistics();
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <mutex>
 #include <vector>
 #include <stack>
 
@@ -8,12 +9,26 @@
 #include "blobtree.h"
 #include "internal_structs.hpp"
 
+// all nodes of all blobtrees live in node_pool, a structure only remembers where its root is
 struct blobtree_t {
-    std::vector<node_t, tbb::tbb_allocator<node_t>>     nodes{};
-    std::vector<uint32_t, tbb::tbb_allocator<uint32_t>> leaf_index{};
+    uint32_t root_index{invalid_node_index}; // index into node_pool
 };
 
+extern std::vector<node_t, tbb::tbb_allocator<node_t>>                          node_pool;
+extern std::vector<uint32_t, tbb::tbb_allocator<uint32_t>>                      node_children_pool; // of n-ary nodes
 extern std::vector<blobtree_t, tbb::tbb_allocator<blobtree_t>>                  structures;
 extern std::vector<aabb_t, tbb::tbb_allocator<aabb_t>>                          aabbs;
 extern std::vector<primitive_node_t, tbb::tbb_allocator<primitive_node_t>>      primitives;
-extern std::stack<uint32_t, std::deque<uint32_t, tbb::tbb_allocator<uint32_t>>> free_structure_list;
\ No newline at end of file
+extern std::stack<uint32_t, std::deque<uint32_t, tbb::tbb_allocator<uint32_t>>> free_structure_list;
+extern std::stack<uint32_t, std::deque<uint32_t, tbb::tbb_allocator<uint32_t>>> free_node_list;
+// primitive index of each instance base by the handle given out for it, or invalid_primitive_index once it is released;
+// compact_blobtree keeps the bases that are not released and remaps their entries
+extern std::vector<uint32_t, tbb::tbb_allocator<uint32_t>>                      instance_bases;
+
+// HINT: every public function modifying the globals above holds this lock; reading a tree while other threads still
+// modify the globals is not safe, as the vectors may be reallocated
+extern std::mutex blobtree_mutex;
+
+// slot allocation, reusing freed slots first
+uint32_t allocate_structure(uint32_t root_index);
+uint32_t allocate_node(); // the node is reset to standard_new_node
\ No newline at end of file
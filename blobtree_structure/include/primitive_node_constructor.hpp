@@ -67,26 +67,74 @@ static auto extrude_desc_move_constructor = [](auto& desc, void* new_desc) {
 
 // ========================================================================================================
 
+// the bounding box of a disk only extends by radius * sin(angle between the coordinate axis and the disk normal) along
+// each axis, so that disks facing an axis do not pad it at all
+static inline void extend_by_disk(aabb_t& aabb, const Eigen::Vector3d& center, const Eigen::Vector3d& axis, double radius)
+{
+    const auto            squared_length = axis.squaredNorm();
+    const Eigen::Vector3d half_size =
+        squared_length > 0
+            ? (radius * (Eigen::Vector3d::Ones() - axis.cwiseAbs2() / squared_length).cwiseMax(0.).cwiseSqrt()).eval()
+            : Eigen::Vector3d::Constant(std::abs(radius)); // no orientation, fall back to the bounding sphere
+    aabb.extend(center - half_size);
+    aabb.extend(center + half_size);
+}
+
+// the arc from start to end with the given bulge, i.e. tan(sweep angle / 4), which is counterclockwise around the
+// normal for a positive bulge (the DXF convention)
+static inline void extend_by_arc(aabb_t&                aabb,
+                                 const Eigen::Vector3d& start,
+                                 const Eigen::Vector3d& end,
+                                 double                 bulge,
+                                 const Eigen::Vector3d& normal)
+{
+    aabb.extend(start);
+    aabb.extend(end);
+
+    const Eigen::Vector3d chord        = end - start;
+    const auto            chord_length = chord.norm();
+    if (bulge == 0 || chord_length == 0 || normal.squaredNorm() == 0) return;
+
+    // signed distance from the chord midpoint to the center, towards the left of the chord (seen from the normal)
+    const Eigen::Vector3d left   = normal.normalized().cross(chord / chord_length);
+    const Eigen::Vector3d center = 0.5 * (start + end) + 0.25 * chord_length * (1 - bulge * bulge) / bulge * left;
+    const auto            radius = 0.25 * chord_length * (1 + bulge * bulge) / std::abs(bulge);
+    const auto            sweep  = 4 * std::atan(bulge);
+
+    // p(t) = center + radius * (cos(t) * u + sin(t) * v) for t in [0, sweep] (or [sweep, 0]); along each axis the extremes
+    // are at t = phi and t = phi + pi, which only count when the arc actually passes them
+    const Eigen::Vector3d u = (start - center).normalized();
+    const Eigen::Vector3d v = normal.normalized().cross(u);
+    for (int axis = 0; axis < 3; ++axis) {
+        const auto phi = std::atan2(v[axis], u[axis]);
+        for (const auto extreme : {phi, phi + M_PI}) {
+            // angle of the extreme measured in the direction of the sweep, in [0, 2 * pi)
+            auto angle = std::fmod(sweep > 0 ? extreme : -extreme, 2 * M_PI);
+            if (angle < 0) angle += 2 * M_PI;
+            if (angle > std::abs(sweep)) continue;
+
+            aabb.extend(center + radius * (std::cos(extreme) * u + std::sin(extreme) * v));
+        }
+    }
+}
+
 static auto plain_aabb_initer  = [](auto& desc, aabb_t& aabb) {};
 static auto sphere_aabb_initer = [](auto& desc, aabb_t& aabb) {
     Eigen::Map<const Eigen::Vector3d> center(&desc.center.x);
     aabb = {center.array() - desc.radius, center.array() + desc.radius};
 };
 static auto cylinder_aabb_initer = [](auto& desc, aabb_t& aabb) {
-    // NOTE: A rough AABB bounding box
+    // the cylinder is the convex hull of its two caps
     Eigen::Map<const Eigen::Vector3d> bottom_center(&desc.bottom_origion.x), offset(&desc.offset.x);
-    aabb.extend(bottom_center.array() + desc.radius);
-    aabb.extend(bottom_center.array() - desc.radius);
-    aabb.extend(bottom_center.array() + offset.array() + desc.radius);
-    aabb.extend(bottom_center.array() + offset.array() - desc.radius);
+    extend_by_disk(aabb, bottom_center, offset, desc.radius);
+    extend_by_disk(aabb, bottom_center + offset, offset, desc.radius);
 };
 static auto cone_aabb_initer = [](auto& desc, aabb_t& aabb) {
-    // NOTE: A rough AABB bounding box
+    // the (truncated) cone is the convex hull of its two caps
     Eigen::Map<const Eigen::Vector3d> top_point(&desc.top_point.x), bottom_point(&desc.bottom_point.x);
-    aabb.extend(top_point.array() + desc.radius1);
-    aabb.extend(top_point.array() - desc.radius1);
-    aabb.extend(bottom_point.array() + desc.radius2);
-    aabb.extend(bottom_point.array() - desc.radius2);
+    const Eigen::Vector3d             axis = top_point - bottom_point;
+    extend_by_disk(aabb, top_point, axis, desc.radius1);
+    extend_by_disk(aabb, bottom_point, axis, desc.radius2);
 };
 static auto box_aabb_initer = [](auto& desc, aabb_t& aabb) {
     Eigen::Map<const Eigen::Vector3d> center(&desc.center.x), half_size(&desc.half_size.x);
@@ -97,11 +145,63 @@ static auto mesh_aabb_initer = [](auto& desc, aabb_t& aabb) {
         aabb.extend(Eigen::Map<const Eigen::Vector3d>(&desc.points[i].x));
 };
 static auto extrude_aabb_initer = [](auto& desc, aabb_t& aabb) {
+    // the profile is a closed loop, where edge i goes from point i to point i + 1 and is an arc for a non-zero bulge; its
+    // plane normal is the extrusion direction. The solid is the profile swept along the extrusion vector, so its box is
+    // the one of the profile joined with the same box translated by the extrusion vector
     Eigen::Map<const Eigen::Vector3d> e(&desc.extusion.x);
-    // NOTE: Currently only straight edges are considered
-    for (int i = 0; i < desc.edges_number; i++) {
-        Eigen::Map<const Eigen::Vector3d> p(&desc.points[i].x);
-        aabb.extend(p);
-        aabb.extend(p + e);
+    aabb_t                            profile_aabb{};
+    for (uint32_t i = 0; i < desc.edges_number; i++) {
+        Eigen::Map<const Eigen::Vector3d> start(&desc.points[i].x), end(&desc.points[(i + 1) % desc.edges_number].x);
+        extend_by_arc(profile_aabb, start, end, desc.bulges[i], e);
     }
-};
\ No newline at end of file
+    aabb.extend(profile_aabb);
+    profile_aabb.offset(e);
+    aabb.extend(profile_aabb);
+};
+// ========================================================================================================
+
+// constants and planes are unbounded and cheap to copy, so only bounded primitives can be shared by instances
+static inline bool is_instantiable(primitive_type type)
+{
+    return type != PRIMITIVE_TYPE_CONSTANT && type != PRIMITIVE_TYPE_PLANE && type != PRIMITIVE_TYPE_INSTANCE;
+}
+
+// instances are rigid, i.e. the evaluation takes rotation^T as the inverse and keeps the distances of the base, so only
+// proper rotations (R^T * R = I within rotation_tolerance, det(R) > 0) are accepted; reflections and scalings are not
+static constexpr double rotation_tolerance = 1e-6;
+
+static inline bool is_rigid_rotation(const double (&rotation_values)[9])
+{
+    using row_major_matrix = Eigen::Matrix<double, 3, 3, Eigen::RowMajor>;
+    Eigen::Map<const row_major_matrix> rotation(rotation_values);
+    if (!rotation.allFinite()) return false;
+    return (rotation.transpose() * rotation - Eigen::Matrix3d::Identity()).cwiseAbs().maxCoeff() <= rotation_tolerance
+           && rotation.determinant() > 0;
+}
+
+// CAUTION: the functions below read the base from the globals, so they expect blobtree_mutex to be held
+static inline bool is_valid_instance_base(uint32_t base_handle)
+{
+    return base_handle < instance_bases.size() && instance_bases[base_handle] != invalid_primitive_index;
+}
+
+// the rotated box of the base, i.e. its center is moved and its half size becomes |rotation| * half size
+static auto instance_aabb_initer = [](auto& desc, aabb_t& aabb) {
+    using row_major_matrix = Eigen::Matrix<double, 3, 3, Eigen::RowMajor>;
+    Eigen::Map<const row_major_matrix> rotation(desc.rotation);
+    Eigen::Map<const Eigen::Vector3d>  translation(&desc.translation.x);
+    const auto&                        base_aabb = aabbs[desc.base_index];
+
+    const Eigen::Vector3d center    = rotation * (0.5 * (base_aabb.min + base_aabb.max)) + translation;
+    const Eigen::Vector3d half_size = rotation.cwiseAbs() * (0.5 * (base_aabb.max - base_aabb.min));
+    aabb                            = {center - half_size, center + half_size};
+};
+
+// the stored copy of an instance refers to the primitive of its base instead of the handle, so that compact_blobtree
+// renumbers it like any other primitive index
+static inline void resolve_instance_base(const primitive_node_t& primitive, aabb_t& aabb)
+{
+    auto& desc      = *static_cast<instance_descriptor_t*>(primitive.desc);
+    desc.base_index = instance_bases[desc.base_index];
+    instance_aabb_initer(desc, aabb);
+}
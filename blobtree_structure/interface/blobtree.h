@@ -13,3 +13,17 @@ typedef struct {
     uint32_t main_index;
     uint32_t inner_index;
 } virtual_node_t;
+
+// one entry of a postfix (RPN) program describing a whole scene: a primitive entry pushes the leaf of the referenced
+// primitive, and a boolean entry pops two subtrees (the second operand on top) and pushes their combination
+typedef enum {
+    SCENE_OP_PRIMITIVE,
+    SCENE_OP_UNION,
+    SCENE_OP_INTERSECTION,
+    SCENE_OP_DIFFERENCE
+} scene_op_type;
+
+typedef struct {
+    scene_op_type type;
+    uint32_t      primitive_index; // Only used by SCENE_OP_PRIMITIVE, index into the array of descriptors
+} scene_op_t;
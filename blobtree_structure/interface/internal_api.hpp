@@ -3,6 +3,7 @@
 #include <tbb/tbb.h>
 
 #include <macros.h>
+#include <container/span.hpp>
 #include <utils/eigen_alias.hpp>
 
 #include "blobtree.h"
@@ -24,17 +25,33 @@ void output_blobtree(virtual_node_t node);
 
 // Basic Operations
 
-BS_API size_t blobtree_get_node_count(uint32_t index) noexcept;
+// node indices are global to the node pool shared by all structures, so per-node arrays are sized by the whole pool
+BS_API size_t blobtree_get_node_pool_size() noexcept;
 BS_API std::vector<uint32_t, tbb::tbb_allocator<uint32_t>> blobtree_get_leaf_nodes(uint32_t index) noexcept;
 BS_API node_t&                                             blobtree_get_node(const virtual_node_t& node) noexcept;
+BS_API span<const uint32_t>                                blobtree_get_node_children(const node_t& node) noexcept;
 
 BS_API size_t                  get_primitive_count() noexcept;
 BS_API const primitive_node_t& get_primitive_node(uint32_t index) noexcept;
 BS_API const aabb_t&           get_aabb(uint32_t index) noexcept;
+// box of the solid described by the subtree, following its boolean operations and clipped by the planes it is intersected
+// with; components are infinite where the solid is unbounded, and min > max if it is empty
+BS_API aabb_t blobtree_get_bounds(const virtual_node_t& node) noexcept;
 
 BS_API void free_sub_blobtree(uint32_t index) noexcept;
 
 BS_API void clear_blobtree() noexcept;
+// reclaims the nodes and primitives that are not reachable from any live structure, and renumbers the remaining
+// primitives; handles to reclaimed nodes must not be used afterwards
+BS_API void compact_blobtree() noexcept;
+
+// Serialization
+
+// writes every structure, node and primitive to a versioned binary file; returns false if the file cannot be written
+BS_API bool blobtree_save(const char* path) noexcept;
+// replaces the current blobtree by the one stored in the file, keeping all node and structure indices, so that virtual
+// nodes taken before saving stay valid; returns false and keeps the current blobtree if the file is missing or damaged
+BS_API bool blobtree_load(const char* path) noexcept;
 
 // Geometry Generation
 
@@ -48,6 +65,7 @@ BS_API virtual_node_t blobtree_new_virtual_node(const mesh_descriptor_t& desc);
 BS_API virtual_node_t blobtree_new_virtual_node(const extrude_polyline_descriptor_t& desc);
 BS_API virtual_node_t blobtree_new_virtual_node(const extrude_arcline_descriptor_t& desc);
 BS_API virtual_node_t blobtree_new_virtual_node(const extrude_helixline_descriptor_t& desc);
+BS_API virtual_node_t blobtree_new_virtual_node(const instance_descriptor_t& desc);
 
 BS_API virtual_node_t blobtree_new_virtual_node(const constant_descriptor_t&& desc);
 BS_API virtual_node_t blobtree_new_virtual_node(const plane_descriptor_t&& desc);
@@ -59,17 +77,41 @@ BS_API virtual_node_t blobtree_new_virtual_node(const mesh_descriptor_t&& desc);
 BS_API virtual_node_t blobtree_new_virtual_node(const extrude_polyline_descriptor_t&& desc);
 BS_API virtual_node_t blobtree_new_virtual_node(const extrude_arcline_descriptor_t&& desc);
 BS_API virtual_node_t blobtree_new_virtual_node(const extrude_helixline_descriptor_t&& desc);
+BS_API virtual_node_t blobtree_new_virtual_node(const instance_descriptor_t&& desc);
+
+// builds one structure from a postfix program over the descriptors (copied), where every descriptor is referenced
+// exactly once; returns {invalid_node_index, invalid_node_index} and builds nothing if the program is malformed, a
+// descriptor has an unknown type or an instance is invalid (see below)
+BS_API virtual_node_t blobtree_new_scene(span<const primitive_node_t> descs, span<const scene_op_t> program);
+
+// Instancing
+
+// copies the descriptor into a base primitive without any node, which is then shared by the instances referring to the
+// returned handle (see instance_descriptor_t); returns invalid_primitive_index for constants, planes and instances. New
+// instances of an invalid or released base, or whose rotation is not a proper rotation (R^T * R = I up to 1e-6,
+// det(R) > 0), return {invalid_node_index, invalid_node_index}, and replacing a primitive by such an instance returns
+// false. The handle stays valid across compact_blobtree until it is released
+BS_API uint32_t blobtree_new_instance_base(const primitive_node_t& desc);
+// no new instance can refer to the base afterwards; the base is reclaimed by compact_blobtree once no live instance
+// refers to it anymore
+BS_API void     blobtree_release_instance_base(uint32_t base_index) noexcept;
 
 BS_API void blobtree_free_virtual_node(const virtual_node_t& node);
 
 // Geometry Operations
 
+// boolean operations link the operands instead of copying them, so the subtree of node2 becomes shared with the
+// structure of node1; an operand that already has a parent (or node2 == node1) is deep-copied first, sharing its primitives
 BS_API void virtual_node_boolean_union(virtual_node_t& node1, const virtual_node_t& node2);
 BS_API void virtual_node_boolean_intersect(virtual_node_t& node1, const virtual_node_t& node2);
 BS_API void virtual_node_boolean_difference(virtual_node_t& node1, const virtual_node_t& node2);
 BS_API void virtual_node_offset(virtual_node_t& node, const raw_vector3d_t& direction, const double length);
 BS_API void virtual_node_offset(virtual_node_t& node, const raw_vector3d_t& offset);
 BS_API void virtual_node_split(virtual_node_t& node, raw_vector3d_t base_point, raw_vector3d_t normal);
+// collapse chains of unions (resp. intersections) in the subtree into n-ary nodes, the given node keeps its index
+// HINT: the subtree is modified in place and keeps the solid it describes; the roots of other live structures linked
+// into it are never absorbed, and flattening a flat subtree leaves the node pools untouched
+BS_API void virtual_node_flatten(const virtual_node_t& node);
 
 // Tree Node Operations
 
@@ -77,6 +119,8 @@ BS_API bool virtual_node_set_parent(const virtual_node_t& node, const virtual_no
 BS_API bool virtual_node_set_left_child(const virtual_node_t& node, const virtual_node_t& child);
 BS_API bool virtual_node_set_right_child(const virtual_node_t& node, const virtual_node_t& child);
 BS_API bool virtual_node_add_child(const virtual_node_t& node, const virtual_node_t& child);
+// the detached subtree stays in the node pool until compact_blobtree reclaims it; an n-ary node left with two children
+// becomes binary again
 BS_API bool virtual_node_remove_child(const virtual_node_t& node, const virtual_node_t& child);
 
 // Node Replacement Operation
@@ -91,6 +135,7 @@ BS_API bool virtual_node_replace_primitive(const virtual_node_t& node, const mes
 BS_API bool virtual_node_replace_primitive(const virtual_node_t& node, const extrude_polyline_descriptor_t& desc);
 BS_API bool virtual_node_replace_primitive(const virtual_node_t& node, const extrude_arcline_descriptor_t& desc);
 BS_API bool virtual_node_replace_primitive(const virtual_node_t& node, const extrude_helixline_descriptor_t& desc);
+BS_API bool virtual_node_replace_primitive(const virtual_node_t& node, const instance_descriptor_t& desc);
 
 BS_API bool virtual_node_replace_primitive(const virtual_node_t& node, const constant_descriptor_t&& desc);
 BS_API bool virtual_node_replace_primitive(const virtual_node_t& node, const plane_descriptor_t&& desc);
@@ -102,3 +147,4 @@ BS_API bool virtual_node_replace_primitive(const virtual_node_t& node, const mes
 BS_API bool virtual_node_replace_primitive(const virtual_node_t& node, const extrude_polyline_descriptor_t&& desc);
 BS_API bool virtual_node_replace_primitive(const virtual_node_t& node, const extrude_arcline_descriptor_t&& desc);
 BS_API bool virtual_node_replace_primitive(const virtual_node_t& node, const extrude_helixline_descriptor_t&& desc);
+BS_API bool virtual_node_replace_primitive(const virtual_node_t& node, const instance_descriptor_t&& desc);
@@ -34,6 +34,12 @@ struct polyline {
 };
 
 struct helixline {
+    helixline() = default;
+    // the cached constants are derived on construction, so a helix built through these is always consistent
+    helixline(double radius, double total_theta, double height) noexcept;
+    // from the public descriptor, in the local frame of the axis, i.e. starting at the origin and advancing along +Z
+    explicit helixline(const helixline_descriptor_t& desc) noexcept;
+
     // Eigen::Vector3d start_point{};
     // Eigen::Vector3d axis_direction{};
     // Eigen::Vector3d base_direction_u{};
@@ -41,8 +47,35 @@ struct helixline {
     double radius{};
     double total_theta{};
     double height{};
+
+    // cached per-helix constants, refreshed by update_cached_constants() whenever the fields above change
+    double inv_total_theta{};
+    double height_per_radian{}; // i.e. pitch / (2 * pi)
 };
 
+inline void update_cached_constants(helixline& line) noexcept
+{
+    line.inv_total_theta   = line.total_theta > 0 ? 1. / line.total_theta : 0.;
+    line.height_per_radian = line.height * line.inv_total_theta;
+}
+
+inline helixline::helixline(double radius, double total_theta, double height) noexcept
+    : radius(radius), total_theta(total_theta), height(height)
+{
+    update_cached_constants(*this);
+}
+
+inline helixline::helixline(const helixline_descriptor_t& desc) noexcept
+{
+    const Eigen::Vector3d axis{desc.axis_end.x - desc.axis_start.x,
+                               desc.axis_end.y - desc.axis_start.y,
+                               desc.axis_end.z - desc.axis_start.z};
+    radius      = desc.radius;
+    height      = axis.norm();
+    total_theta = desc.advance_per_round > 0 ? 2 * EIGEN_PI * height / desc.advance_per_round : 0.;
+    update_cached_constants(*this);
+}
+
 struct extrude_polyline {
     Eigen::Transform<double, 3, Eigen::AffineCompact> world_to_axis{};
     polyline                                          axis{};
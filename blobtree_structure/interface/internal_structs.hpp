@@ -1,6 +1,6 @@
 #pragma once
 
-#include <bitset>
+#include <type_traits>
 
 #include <utils/eigen_alias.hpp>
 
@@ -12,9 +12,9 @@ struct aabb_t {
     Eigen::Vector3d min{std::numeric_limits<double>::max(),
                         std::numeric_limits<double>::max(),
                         std::numeric_limits<double>::max()};
-    Eigen::Vector3d max{std::numeric_limits<double>::min(),
-                        std::numeric_limits<double>::min(),
-                        std::numeric_limits<double>::min()};
+    Eigen::Vector3d max{std::numeric_limits<double>::lowest(),
+                        std::numeric_limits<double>::lowest(),
+                        std::numeric_limits<double>::lowest()};
 
     void extend(const Eigen::Vector3d& point)
     {
@@ -44,9 +44,9 @@ struct aabb_t {
         min = Eigen::Vector3d{std::numeric_limits<double>::max(),
                               std::numeric_limits<double>::max(),
                               std::numeric_limits<double>::max()};
-        max = Eigen::Vector3d{std::numeric_limits<double>::min(),
-                              std::numeric_limits<double>::min(),
-                              std::numeric_limits<double>::min()};
+        max = Eigen::Vector3d{std::numeric_limits<double>::lowest(),
+                              std::numeric_limits<double>::lowest(),
+                              std::numeric_limits<double>::lowest()};
     }
 };
 
@@ -54,38 +54,69 @@ struct aabb_t {
 // Node
 // ======================================================================
 
-using node_t = std::bitset<128>;
-
-static const node_t standard_new_node = [] {
-    node_t node{};
-    return node.flip();
-}();
+static constexpr uint32_t invalid_node_index      = 0xFFFFFFFFu;
+static constexpr uint32_t invalid_primitive_index = 0xFFFFFFFFu;
 
 enum class eNodeLocation : uint32_t { in = 0, out = 1, edge = 2, unset = 3 };
 enum class eNodeOperation : uint32_t { unionOp = 0, intersectionOp = 1, differenceOp = 2, unsetOp = 3 };
 
-/* getter/setter for node_t */
-template <typename _Tp>
-struct node_proxy {
-    constexpr node_proxy() = default;
-
-    constexpr node_proxy(node_t& _data, uint32_t _offset, uint32_t _mask_bits)
-        : data(_data), offset(_offset), mask((1ull << _mask_bits) - 1ull)
+// packed node record, 16 bytes, trivially copyable
+// same layout as the former std::bitset<128>: right child, left child, parent, then the flags word
+// HINT: n-ary union and intersection nodes (see virtual_node_flatten) keep their children in node_children_pool, with
+// left_child_index holding the offset of the range and right_child_index its length
+struct node_t {
+    uint32_t right_child_index{invalid_node_index};
+    uint32_t left_child_index{invalid_node_index};
+    uint32_t parent_index{invalid_node_index};
+    // [0, 24): primitive index, 24: cleared for n-ary nodes, [27, 29): eNodeLocation, [29, 31): eNodeOperation,
+    // 31: is primitive
+    uint32_t flags{0xFFFFFFFFu};
+
+    static constexpr uint32_t primitive_index_offset = 0u;
+    static constexpr uint32_t primitive_index_bits   = 24u;
+    static constexpr uint32_t binary_offset          = 24u;
+    static constexpr uint32_t in_out_offset          = 27u;
+    static constexpr uint32_t operation_offset       = 29u;
+    static constexpr uint32_t is_primitive_offset    = 31u;
+
+    constexpr uint32_t primitive_index() const noexcept { return flags & ((1u << primitive_index_bits) - 1u); }
+
+    constexpr eNodeLocation in_out() const noexcept { return static_cast<eNodeLocation>((flags >> in_out_offset) & 3u); }
+
+    constexpr eNodeOperation operation() const noexcept
     {
+        return static_cast<eNodeOperation>((flags >> operation_offset) & 3u);
     }
 
-    void reinit(node_t& _data, uint32_t _offset, uint32_t _mask_bits)
+    constexpr bool is_primitive() const noexcept { return (flags >> is_primitive_offset) & 1u; }
+
+    constexpr bool is_nary() const noexcept { return !is_primitive() && !((flags >> binary_offset) & 1u); }
+
+    // only valid for n-ary nodes
+    constexpr uint32_t children_offset() const noexcept { return left_child_index; }
+
+    constexpr uint32_t children_count() const noexcept { return right_child_index; }
+
+    friend constexpr bool operator==(const node_t& lhs, const node_t& rhs) noexcept
     {
-        data   = _data;
-        offset = _offset;
-        mask   = (1ull << _mask_bits) - 1ull;
+        return lhs.right_child_index == rhs.right_child_index && lhs.left_child_index == rhs.left_child_index
+               && lhs.parent_index == rhs.parent_index && lhs.flags == rhs.flags;
     }
 
-    void reinit(node_proxy&& other)
+    friend constexpr bool operator!=(const node_t& lhs, const node_t& rhs) noexcept { return !(lhs == rhs); }
+};
+
+static_assert(sizeof(node_t) == 16 && std::is_trivially_copyable_v<node_t>);
+
+static constexpr node_t standard_new_node{};
+
+/* getter/setter for node_t, kept as a compatibility shim over the packed record */
+// every field lives in a single 32-bit word, so a proxy is that word plus a bit range
+template <typename _Tp>
+struct node_proxy {
+    constexpr node_proxy(uint32_t& _data, uint32_t _offset, uint32_t _mask_bits)
+        : data(_data), offset(_offset), mask(_mask_bits >= 32u ? 0xFFFFFFFFu : (1u << _mask_bits) - 1u)
     {
-        data   = std::move(other.data);
-        offset = std::move(other.offset);
-        mask   = std::move(other.mask);
     }
 
     node_proxy(const node_proxy&) = delete;
@@ -98,93 +129,78 @@ struct node_proxy {
         return *this;
     }
 
-    constexpr node_proxy& operator=(node_proxy&& other)
-    {
-        const auto _mask = mask << offset;
-        data             = (data & ~_mask) | (std::forward(other.data) & _mask);
-        return *this;
-    }
-
-    template <typename _Fp, typename = std::enable_if_t<!std::is_same_v<_Fp, node_proxy>>>
+    template <typename _Fp, typename = std::enable_if_t<!std::is_same_v<std::decay_t<_Fp>, node_proxy>>>
     constexpr node_proxy& operator=(_Fp&& other)
     {
-        const auto _mask        = mask << offset;
-        const auto offset_value = node_t{static_cast<uint64_t>(std::forward<_Fp>(other))} << offset;
-        data                    = (data & ~_mask) | (offset_value & _mask);
+        const auto _mask = mask << offset;
+        data             = (data & ~_mask) | ((static_cast<uint32_t>(std::forward<_Fp>(other)) << offset) & _mask);
         return *this;
     }
 
     template <typename _Fp,
-              typename = std::enable_if_t<!std::is_same_v<_Fp, node_proxy> && //
-                                          !std::is_enum_v<_Fp> &&             //
-                                          !std::is_same_v<_Fp, bool>>>
+              typename = std::enable_if_t<!std::is_same_v<std::decay_t<_Fp>, node_proxy> && //
+                                          !std::is_enum_v<std::decay_t<_Fp>> &&             //
+                                          !std::is_same_v<std::decay_t<_Fp>, bool>>>
     constexpr node_proxy& operator+=(_Fp&& other)
     {
         const auto _mask      = mask << offset;
-        const auto low_data   = ((data & _mask) >> offset).to_ullong();
-        const auto low_result = static_cast<uint64_t>(std::forward<_Fp>(other)) + low_data;
-        data                  = (data & ~_mask) | ((node_t{low_result} << offset) & _mask);
+        const auto low_result = static_cast<uint32_t>(std::forward<_Fp>(other)) + ((data & _mask) >> offset);
+        data                  = (data & ~_mask) | ((low_result << offset) & _mask);
         return *this;
     }
 
-    constexpr operator _Tp() const { return static_cast<_Tp>((((data) >> offset) & mask).to_ulong()); }
+    constexpr operator _Tp() const { return static_cast<_Tp>((data >> offset) & mask); }
 
 protected:
-    node_t&  data;
-    uint32_t offset{};
-    node_t   mask{};
-};
-
-template <typename _Tp>
-struct const_node_proxy {
-    constexpr const_node_proxy(const node_t& _data, uint32_t _offset, uint32_t _mask_bits)
-        : data(_data), offset(_offset), mask((1ull << _mask_bits) - 1ull)
-    {
-    }
-
-    const_node_proxy(const const_node_proxy&) = delete;
-    const_node_proxy(const_node_proxy&&)      = delete;
-
-    constexpr operator _Tp() const { return static_cast<_Tp>((((data) >> offset) & mask).to_ulong()); }
-
-protected:
-    const node_t& data;
-    uint32_t      offset{};
-    node_t        mask{};
+    uint32_t& data;
+    uint32_t  offset{};
+    uint32_t  mask{};
 };
 
 // 0 for internal node, 1 for primitive node
-static constexpr inline auto node_fetch_is_primitive(node_t& node) { return node_proxy<bool>(node, 127u, 1); }
+static constexpr inline auto node_fetch_is_primitive(node_t& node)
+{
+    return node_proxy<bool>(node.flags, node_t::is_primitive_offset, 1);
+}
 
 // 0 for union, 1 for intersection, 2 for difference, 3 for unset
-static constexpr inline auto node_fetch_operation(node_t& node) { return node_proxy<eNodeOperation>(node, 125u, 2); }
+static constexpr inline auto node_fetch_operation(node_t& node)
+{
+    return node_proxy<eNodeOperation>(node.flags, node_t::operation_offset, 2);
+}
 
 // 0 for in, 1 for out, 2 for on edge, 3 for unset
-static constexpr inline auto node_fetch_in_out(node_t& node) { return node_proxy<eNodeLocation>(node, 123u, 2); }
+static constexpr inline auto node_fetch_in_out(node_t& node)
+{
+    return node_proxy<eNodeLocation>(node.flags, node_t::in_out_offset, 2);
+}
 
 // If primitive node, the index to the primitive information
-static constexpr inline auto node_fetch_primitive_index(node_t& node) { return node_proxy<uint32_t>(node, 96u, 24); }
+static constexpr inline auto node_fetch_primitive_index(node_t& node)
+{
+    return node_proxy<uint32_t>(node.flags, node_t::primitive_index_offset, node_t::primitive_index_bits);
+}
 
 // Parent node index
-static constexpr inline auto node_fetch_parent_index(node_t& node) { return node_proxy<uint32_t>(node, 64u, 32); }
+static constexpr inline auto node_fetch_parent_index(node_t& node) { return node_proxy<uint32_t>(node.parent_index, 0u, 32); }
 
-static constexpr inline auto node_is_parent_null(const node_t& node)
-{
-    return const_node_proxy<uint32_t>(node, 64u, 32) == 0xFFFFFFFFu;
-}
+static constexpr inline auto node_is_parent_null(const node_t& node) { return node.parent_index == invalid_node_index; }
 
 // Left child node index
-static constexpr inline auto node_fetch_left_child_index(node_t& node) { return node_proxy<uint32_t>(node, 32u, 32); }
-
-static constexpr inline auto node_is_left_child_null(const node_t& node)
+static constexpr inline auto node_fetch_left_child_index(node_t& node)
 {
-    return const_node_proxy<uint32_t>(node, 32u, 32) == 0xFFFFFFFFu;
+    return node_proxy<uint32_t>(node.left_child_index, 0u, 32);
 }
 
+static constexpr inline auto node_is_left_child_null(const node_t& node) { return node.left_child_index == invalid_node_index; }
+
 // Right child node index
-static constexpr inline auto node_fetch_right_child_index(node_t& node) { return node_proxy<uint32_t>(node, 0u, 32); }
+static constexpr inline auto node_fetch_right_child_index(node_t& node)
+{
+    return node_proxy<uint32_t>(node.right_child_index, 0u, 32);
+}
 
 static constexpr inline auto node_is_right_child_null(const node_t& node)
 {
-    return const_node_proxy<uint32_t>(node, 0u, 32) == 0xFFFFFFFFu;
+    return node.right_child_index == invalid_node_index;
 }
\ No newline at end of file
@@ -14,7 +14,8 @@ typedef enum {
     PRIMITIVE_TYPE_BOX,
     PRIMITIVE_TYPE_MESH,
     PRIMITIVE_TYPE_EXTRUDE_POLYLINE,
-    PRIMITIVE_TYPE_EXTRUDE_HELIXLINE
+    PRIMITIVE_TYPE_EXTRUDE_HELIXLINE,
+    PRIMITIVE_TYPE_INSTANCE
 } primitive_type;
 
 // Placeholder, currently used to represent empty body
@@ -96,4 +97,13 @@ typedef struct {
     uint32_t               profile_number; // The profiles number of the extruded solid
     polyline_descriptor_t* profiles;       // The profiles of the extruded solid
     helixline_descriptor_t axis;           // The axis of the extruded solid
-} extrude_helixline_descriptor_t;
\ No newline at end of file
+} extrude_helixline_descriptor_t;
+
+// Instance descriptor, a rigid copy of a shared base primitive, i.e. the base evaluated at rotation^T * (p - translation)
+// Note : The base is not copied, many instances of the same mesh or extrusion share a single descriptor; the copy kept
+// in the blobtree refers to the primitive index of the base instead of its handle
+typedef struct {
+    uint32_t       base_index;  // The handle of the base, as returned by blobtree_new_instance_base
+    double         rotation[9]; // The row-major rotation matrix from the base to the instance
+    raw_vector3d_t translation; // The translation from the base to the instance, applied after the rotation
+} instance_descriptor_t;
\ No newline at end of file
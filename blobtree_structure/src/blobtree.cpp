@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <cassert>
+#include <tuple>
 
 #include "internal_api.hpp"
 
@@ -6,25 +8,55 @@
 #include "primitive_node_destroyer.hpp"
 
 /* internal global variables for blobtree */
+std::vector<node_t, tbb::tbb_allocator<node_t>>                          node_pool{};
+std::vector<uint32_t, tbb::tbb_allocator<uint32_t>>                      node_children_pool{};
 std::vector<blobtree_t, tbb::tbb_allocator<blobtree_t>>                  structures{};
 std::vector<aabb_t, tbb::tbb_allocator<aabb_t>>                          aabbs{};
 std::vector<primitive_node_t, tbb::tbb_allocator<primitive_node_t>>      primitives{};
 std::stack<uint32_t, std::deque<uint32_t, tbb::tbb_allocator<uint32_t>>> free_structure_list{};
+std::stack<uint32_t, std::deque<uint32_t, tbb::tbb_allocator<uint32_t>>> free_node_list{};
+std::vector<uint32_t, tbb::tbb_allocator<uint32_t>>                      instance_bases{};
+std::mutex                                                               blobtree_mutex{};
 
 /* =============================================================================================
  * basic functionalities
  * ============================================================================================= */
 
-BS_API size_t blobtree_get_node_count(uint32_t index) noexcept { return structures[index].nodes.size(); }
+BS_API size_t blobtree_get_node_pool_size() noexcept { return node_pool.size(); }
 
 BS_API std::vector<uint32_t, tbb::tbb_allocator<uint32_t>> blobtree_get_leaf_nodes(uint32_t index) noexcept
 {
-    return structures[index].leaf_index;
+    std::vector<uint32_t, tbb::tbb_allocator<uint32_t>> leaf_indices{};
+    if (structures[index].root_index == invalid_node_index) return leaf_indices;
+
+    // depth-first, left to right
+    std::stack<uint32_t, std::vector<uint32_t, tbb::tbb_allocator<uint32_t>>> pending_nodes{};
+    pending_nodes.push(structures[index].root_index);
+    while (!pending_nodes.empty()) {
+        const auto  node_index = pending_nodes.top();
+        const auto& node       = node_pool[node_index];
+        pending_nodes.pop();
+        if (node.is_primitive()) {
+            leaf_indices.emplace_back(node_index);
+            continue;
+        }
+        if (node.is_nary()) {
+            const auto children = blobtree_get_node_children(node);
+            for (auto iter = children.rbegin(); iter != children.rend(); ++iter) pending_nodes.push(*iter);
+            continue;
+        }
+        if (!node_is_right_child_null(node)) pending_nodes.push(node.right_child_index);
+        if (!node_is_left_child_null(node)) pending_nodes.push(node.left_child_index);
+    }
+    return leaf_indices;
 }
 
-BS_API node_t& blobtree_get_node(const virtual_node_t& node) noexcept
+BS_API node_t& blobtree_get_node(const virtual_node_t& node) noexcept { return node_pool[node.inner_index]; }
+
+BS_API span<const uint32_t> blobtree_get_node_children(const node_t& node) noexcept
 {
-    return structures[node.main_index].nodes[node.inner_index];
+    assert(node.is_nary());
+    return {node_children_pool.data() + node.children_offset(), node.children_count()};
 }
 
 BS_API size_t get_primitive_count() noexcept
@@ -47,46 +79,195 @@ BS_API const aabb_t& get_aabb(uint32_t index) noexcept
 
 void shrink_primitives() { primitives.shrink_to_fit(); }
 
-virtual_node_t copy(virtual_node_t old_node, virtual_node_t new_node)
+uint32_t allocate_structure(uint32_t root_index)
 {
-    assert(old_node.main_index != new_node.main_index);
+    if (free_structure_list.empty()) {
+        structures.push_back(blobtree_t{root_index});
+        return static_cast<uint32_t>(structures.size() - 1);
+    }
 
-    // Copy a tree and its subtrees to a temporary tree
-    auto temp = structures[old_node.main_index];
+    const auto index  = free_structure_list.top();
+    structures[index] = blobtree_t{root_index};
+    free_structure_list.pop();
+    return index;
+}
 
-    // Update all index
-    const auto size = static_cast<uint32_t>(structures[new_node.main_index].nodes.size());
-    for (uint32_t i = 0; i < temp.nodes.size(); i++) {
-        if (!node_is_parent_null(temp.nodes[i])) node_fetch_parent_index(temp.nodes[i]) += size;
-        if (!node_is_left_child_null(temp.nodes[i])) node_fetch_left_child_index(temp.nodes[i]) += size;
-        if (!node_is_right_child_null(temp.nodes[i])) node_fetch_right_child_index(temp.nodes[i]) += size;
+uint32_t allocate_node()
+{
+    if (free_node_list.empty()) {
+        node_pool.emplace_back(standard_new_node);
+        return static_cast<uint32_t>(node_pool.size() - 1);
     }
-    for (uint32_t i = 0; i < temp.leaf_index.size(); i++) { temp.leaf_index[i] += size; }
 
-    // Copy the updated index tree to the array at the new location
-    structures[new_node.main_index].nodes.insert(structures[new_node.main_index].nodes.end(),
-                                                 temp.nodes.begin(),
-                                                 temp.nodes.end());
-    structures[new_node.main_index].leaf_index.insert(structures[new_node.main_index].leaf_index.end(),
-                                                      temp.leaf_index.begin(),
-                                                      temp.leaf_index.end());
+    const auto index = free_node_list.top();
+    node_pool[index] = standard_new_node;
+    free_node_list.pop();
+    return index;
+}
+
+// deep copy of the subtree rooted at root_index inside the node pool, primitives are shared with the original leaves
+// returns the index of the copied root, whose parent is left unset
+uint32_t clone_subtree(uint32_t root_index)
+{
+    auto clone_root_index = invalid_node_index;
+
+    // (source index, parent index of the clone, slot in node_children_pool if the parent is n-ary)
+    std::stack<std::tuple<uint32_t, uint32_t, uint32_t>, std::vector<std::tuple<uint32_t, uint32_t, uint32_t>>>
+        pending_nodes{};
+    pending_nodes.emplace(root_index, invalid_node_index, invalid_node_index);
+    while (!pending_nodes.empty()) {
+        const auto [source_index, parent_index, slot_index] = pending_nodes.top();
+        pending_nodes.pop();
+
+        const auto clone_index = allocate_node();
+        auto       clone       = node_pool[source_index];
+        clone.parent_index     = parent_index;
+        if (parent_index == invalid_node_index) clone_root_index = clone_index;
+        if (slot_index != invalid_node_index) {
+            node_children_pool[slot_index] = clone_index;
+        } else if (parent_index != invalid_node_index) {
+            auto& parent = node_pool[parent_index];
+            if (parent.left_child_index == source_index) {
+                parent.left_child_index = clone_index;
+            } else {
+                parent.right_child_index = clone_index;
+            }
+        }
 
-    return virtual_node_t{new_node.main_index, old_node.inner_index + size};
+        if (clone.is_nary()) {
+            // the clone gets its own child range, whose entries are redirected as the children are cloned
+            const auto children_offset = static_cast<uint32_t>(node_children_pool.size());
+            for (uint32_t i = 0; i < clone.children_count(); ++i) {
+                const auto child_index = node_children_pool[clone.children_offset() + i];
+                node_children_pool.emplace_back(child_index);
+                pending_nodes.emplace(child_index, clone_index, children_offset + i);
+            }
+            clone.left_child_index = children_offset;
+        } else {
+            if (!node_is_right_child_null(clone))
+                pending_nodes.emplace(clone.right_child_index, clone_index, invalid_node_index);
+            if (!node_is_left_child_null(clone))
+                pending_nodes.emplace(clone.left_child_index, clone_index, invalid_node_index);
+        }
+        node_pool[clone_index] = clone;
+    }
+
+    return clone_root_index;
 }
 
 BS_API void free_sub_blobtree(uint32_t index) noexcept
 {
+    std::lock_guard lock{blobtree_mutex};
+
     // 这里尽量打标记，延迟修改和删除
+    // the nodes and primitives may still be reachable from other structures, compact_blobtree reclaims them
+    if (structures[index].root_index == invalid_node_index) return;
+    structures[index].root_index = invalid_node_index;
     free_structure_list.push(index);
 }
 
+BS_API void compact_blobtree() noexcept
+{
+    std::lock_guard lock{blobtree_mutex};
+
+    // 1. mark everything reachable from the live structures
+    std::vector<bool> node_reachable(node_pool.size(), false), primitive_reachable(primitives.size(), false);
+    std::stack<uint32_t, std::vector<uint32_t, tbb::tbb_allocator<uint32_t>>> pending_nodes{};
+    for (const auto& structure : structures) {
+        if (structure.root_index == invalid_node_index || node_reachable[structure.root_index]) continue;
+
+        pending_nodes.push(structure.root_index);
+        while (!pending_nodes.empty()) {
+            const auto  node_index = pending_nodes.top();
+            const auto& node       = node_pool[node_index];
+            pending_nodes.pop();
+            if (node_reachable[node_index]) continue;
+
+            node_reachable[node_index] = true;
+            if (node.is_primitive()) {
+                primitive_reachable[node.primitive_index()] = true;
+            } else if (node.is_nary()) {
+                for (const auto& child_index : blobtree_get_node_children(node)) pending_nodes.push(child_index);
+            } else {
+                if (!node_is_left_child_null(node)) pending_nodes.push(node.left_child_index);
+                if (!node_is_right_child_null(node)) pending_nodes.push(node.right_child_index);
+            }
+        }
+    }
+
+    // the bases of live instances have no node of their own, and are kept as well, as are the bases that are not released
+    for (uint32_t i = 0; i < primitives.size(); ++i) {
+        if (primitive_reachable[i] && primitives[i].type == PRIMITIVE_TYPE_INSTANCE)
+            primitive_reachable[static_cast<const instance_descriptor_t*>(primitives[i].desc)->base_index] = true;
+    }
+    for (const auto& base_index : instance_bases)
+        if (base_index != invalid_primitive_index) primitive_reachable[base_index] = true;
+
+    // 2. renumber the live primitives, keeping their order
+    std::vector<uint32_t> new_primitive_index(primitives.size(), invalid_node_index);
+    uint32_t              primitive_count{};
+    for (uint32_t i = 0; i < primitives.size(); ++i) {
+        if (!primitive_reachable[i]) {
+            destroy_primitive_node(primitives[i]);
+            continue;
+        }
+        new_primitive_index[i]      = primitive_count;
+        primitives[primitive_count] = primitives[i];
+        aabbs[primitive_count]      = aabbs[i];
+        primitive_count++;
+    }
+    primitives.resize(primitive_count);
+    aabbs.resize(primitive_count);
+    for (auto& primitive : primitives) {
+        if (primitive.type != PRIMITIVE_TYPE_INSTANCE) continue;
+        auto desc        = static_cast<instance_descriptor_t*>(primitive.desc);
+        desc->base_index = new_primitive_index[desc->base_index];
+    }
+    for (auto& base_index : instance_bases)
+        if (base_index != invalid_primitive_index) base_index = new_primitive_index[base_index];
+
+    // 3. drop the unreachable nodes, shrinking the pool where possible and recycling the remaining holes; the child
+    // ranges of n-ary nodes are packed again on the way
+    std::vector<uint32_t, tbb::tbb_allocator<uint32_t>> packed_children_pool{};
+    for (uint32_t i = 0; i < node_pool.size(); ++i) {
+        if (!node_reachable[i]) continue;
+
+        auto& node = node_pool[i];
+        if (node.is_primitive()) {
+            node_fetch_primitive_index(node) = new_primitive_index[node.primitive_index()];
+        } else if (node.is_nary()) {
+            const auto children   = blobtree_get_node_children(node);
+            node.left_child_index = static_cast<uint32_t>(packed_children_pool.size());
+            packed_children_pool.insert(packed_children_pool.end(), children.begin(), children.end());
+        }
+    }
+    node_children_pool = std::move(packed_children_pool);
+
+    auto node_count = node_pool.size();
+    while (node_count > 0 && !node_reachable[node_count - 1]) node_count--;
+    node_pool.resize(node_count);
+
+    while (!free_node_list.empty()) free_node_list.pop();
+    for (uint32_t i = 0; i < node_count; ++i) {
+        if (node_reachable[i]) continue;
+        node_pool[i] = standard_new_node;
+        free_node_list.push(i);
+    }
+}
+
 BS_API void clear_blobtree() noexcept
 {
+    std::lock_guard lock{blobtree_mutex};
+
+    node_pool.clear();
+    node_children_pool.clear();
     structures.clear();
     aabbs.clear();
     for (auto& prim : primitives) { destroy_primitive_node(prim); }
     primitives.clear();
+    instance_bases.clear();
     while (!free_structure_list.empty()) free_structure_list.pop();
+    while (!free_node_list.empty()) free_node_list.pop();
 }
 
 // bool upward_propagation(blobtree_t& tree, const int leaf_node_index, const int root_index)
@@ -229,90 +410,69 @@ BS_API void clear_blobtree() noexcept
 
 BS_API bool virtual_node_set_parent(const virtual_node_t& node, const virtual_node_t& parent)
 {
-    auto& node_in_tree = structures[node.main_index].nodes[node.inner_index];
+    std::lock_guard lock{blobtree_mutex};
+
+    auto& node_in_tree   = node_pool[node.inner_index];
+    auto& parent_in_tree = node_pool[parent.inner_index];
     // The node's parent is not empty
     if (!node_is_parent_null(node_in_tree)) { return false; }
 
-    auto& parent_in_tree     = structures[parent.main_index].nodes[parent.inner_index];
-    auto  parent_inner_index = parent.inner_index;
-    // not on the same tree
-    if (node.main_index != parent.main_index) {
-        auto new_parent    = copy(parent, node);
-        parent_in_tree     = structures[new_parent.main_index].nodes[new_parent.inner_index];
-        parent_inner_index = new_parent.inner_index;
-    }
-    auto parent_left_child  = node_fetch_left_child_index(parent_in_tree);
-    auto parent_right_child = node_fetch_right_child_index(parent_in_tree);
-
-    // set parent index
-    node_fetch_parent_index(node_in_tree) = parent_inner_index;
+    // children of n-ary nodes are only set up by virtual_node_flatten
+    if (parent_in_tree.is_nary()) { return false; }
 
     // The parent's left child is empty
-    if (node_is_left_child_null(node_in_tree)) {
-        parent_left_child = node.inner_index;
-        return true;
+    if (node_is_left_child_null(parent_in_tree)) {
+        parent_in_tree.left_child_index = node.inner_index;
     }
     // The parent's right child is empty
-    else if (node_is_right_child_null(node_in_tree)) {
-        parent_right_child = node.inner_index;
-        return true;
+    else if (node_is_right_child_null(parent_in_tree)) {
+        parent_in_tree.right_child_index = node.inner_index;
+    } else {
+        return false;
     }
 
-    return false;
+    // set parent index
+    node_in_tree.parent_index = parent.inner_index;
+    if (structures[node.main_index].root_index == node.inner_index)
+        structures[node.main_index].root_index = structures[parent.main_index].root_index;
+
+    return true;
 }
 
 BS_API bool virtual_node_set_left_child(const virtual_node_t& node, const virtual_node_t& child)
 {
-    auto& node_in_tree = structures[node.main_index].nodes[node.inner_index];
+    std::lock_guard lock{blobtree_mutex};
+
+    auto& node_in_tree  = node_pool[node.inner_index];
+    auto& child_in_tree = node_pool[child.inner_index];
 
     // The child's parent is not empty
-    if (!node_is_parent_null(node_in_tree)) { return false; }
+    if (!node_is_parent_null(child_in_tree)) { return false; }
 
     // The node's left child is not empty
-    if (!node_is_left_child_null(node_in_tree)) { return false; }
+    if (node_in_tree.is_nary() || !node_is_left_child_null(node_in_tree)) { return false; }
 
-    auto node_left_child  = node_fetch_left_child_index(node_in_tree);
-    auto node_right_child = node_fetch_right_child_index(node_in_tree);
-
-    // On the same tree
-    if (node.main_index == child.main_index) {
-        auto& child_in_tree                    = structures[child.main_index].nodes[child.inner_index];
-        node_fetch_parent_index(child_in_tree) = node.inner_index;
-        node_left_child                        = child.inner_index;
-    } else {
-        auto  new_child                        = copy(child, node);
-        auto& child_in_tree                    = structures[new_child.main_index].nodes[new_child.inner_index];
-        node_fetch_parent_index(child_in_tree) = node.inner_index;
-        node_left_child                        = new_child.inner_index;
-    }
+    child_in_tree.parent_index    = node.inner_index;
+    node_in_tree.left_child_index = child.inner_index;
 
     return true;
 }
 
 BS_API bool virtual_node_set_right_child(const virtual_node_t& node, const virtual_node_t& child)
 {
-    auto& node_in_tree = structures[node.main_index].nodes[node.inner_index];
+    std::lock_guard lock{blobtree_mutex};
+
+    auto& node_in_tree  = node_pool[node.inner_index];
+    auto& child_in_tree = node_pool[child.inner_index];
 
     // The child's parent is not empty
-    if (!node_is_parent_null(node_in_tree)) { return false; }
+    if (!node_is_parent_null(child_in_tree)) { return false; }
 
     // The node's right child is not empty
-    if (!node_is_right_child_null(node_in_tree)) { return false; }
-
-    auto node_left_child  = node_fetch_left_child_index(node_in_tree);
-    auto node_right_child = node_fetch_right_child_index(node_in_tree);
+    if (node_in_tree.is_nary() || !node_is_right_child_null(node_in_tree)) { return false; }
 
-    // On the same tree
-    if (node.main_index == child.main_index) {
-        auto& child_in_tree                    = structures[child.main_index].nodes[child.inner_index];
-        node_fetch_parent_index(child_in_tree) = node.inner_index;
-        node_right_child                       = child.inner_index;
-    } else {
-        auto  new_child                        = copy(child, node);
-        auto& child_in_tree                    = structures[new_child.main_index].nodes[new_child.inner_index];
-        node_fetch_parent_index(child_in_tree) = node.inner_index;
-        node_right_child                       = new_child.inner_index;
-    }
+    child_in_tree.parent_index     = node.inner_index;
+    node_in_tree.right_child_index = child.inner_index;
 
     return true;
 }
@@ -330,19 +490,39 @@ BS_API bool virtual_node_add_child(const virtual_node_t& node, const virtual_nod
 
 BS_API bool virtual_node_remove_child(const virtual_node_t& node, const virtual_node_t& child)
 {
-    if (node.main_index != child.main_index) { return false; }
-
-    auto& node_in_tree     = structures[node.main_index].nodes[node.inner_index];
-    auto  node_left_child  = node_fetch_left_child_index(node_in_tree);
-    auto  node_right_child = node_fetch_right_child_index(node_in_tree);
-
-    if (node_left_child == child.inner_index) {
-        node_left_child = 0xFFFFFFFFu;
-        blobtree_free_virtual_node(child);
+    std::lock_guard lock{blobtree_mutex};
+
+    auto& node_in_tree  = node_pool[node.inner_index];
+    auto& child_in_tree = node_pool[child.inner_index];
+
+    // the detached subtree is left in the pool, reachable only through the child handle
+    if (node_in_tree.is_nary()) {
+        const auto children_begin = node_children_pool.data() + node_in_tree.children_offset();
+        auto       children       = span<uint32_t>{children_begin, node_in_tree.children_count()};
+        auto       iter           = std::find(children.begin(), children.end(), child.inner_index);
+        if (iter == children.end()) return false;
+
+        std::copy(iter + 1, children.end(), iter);
+        node_in_tree.right_child_index--;
+        child_in_tree.parent_index = invalid_node_index;
+
+        // n-ary nodes have more than two children, so the last two are kept as a binary node, which can then lose its
+        // children one at a time like any other binary node
+        if (node_in_tree.children_count() == 2) {
+            const auto left_index          = children[0];
+            const auto right_index         = children[1];
+            node_in_tree.left_child_index  = left_index;
+            node_in_tree.right_child_index = right_index;
+            node_in_tree.flags             = node_in_tree.flags | (1u << node_t::binary_offset);
+        }
         return true;
-    } else if (node_right_child == child.inner_index) {
-        node_right_child = 0xFFFFFFFFu;
-        blobtree_free_virtual_node(child);
+    } else if (node_in_tree.left_child_index == child.inner_index) {
+        node_in_tree.left_child_index = invalid_node_index;
+        child_in_tree.parent_index    = invalid_node_index;
+        return true;
+    } else if (node_in_tree.right_child_index == child.inner_index) {
+        node_in_tree.right_child_index = invalid_node_index;
+        child_in_tree.parent_index     = invalid_node_index;
         return true;
     }
 
@@ -355,20 +535,27 @@ BS_API bool virtual_node_remove_child(const virtual_node_t& node, const virtual_
 
 static inline void virtual_node_boolean_op(virtual_node_t& node1, const virtual_node_t& node2, eNodeOperation op)
 {
-    auto new_node2 = copy(node2, node1);
-
-    auto& inserted_node                         = structures[node1.main_index].nodes.emplace_back(standard_new_node);
-    node_fetch_is_primitive(inserted_node)      = false;
-    // weird bug: need to force cast, or it will be treated as uint32_t instead of eNodeOperation
-    node_fetch_operation(inserted_node)         = (eNodeOperation)op;
-    node_fetch_left_child_index(inserted_node)  = node1.inner_index;
-    node_fetch_right_child_index(inserted_node) = new_node2.inner_index;
-
-    uint32_t parent_index = structures[node1.main_index].nodes.size() - 1;
-    node_fetch_parent_index(structures[node1.main_index].nodes[node1.inner_index])         = parent_index;
-    node_fetch_parent_index(structures[new_node2.main_index].nodes[new_node2.inner_index]) = parent_index;
-
-    node1.inner_index = parent_index;
+    std::lock_guard lock{blobtree_mutex};
+
+    // a node has a single parent, so an operand is only cloned when it is already used by another tree (or node2 is
+    // node1 itself); otherwise building the new node is O(1)
+    auto left_index = node1.inner_index;
+    if (!node_is_parent_null(node_pool[left_index])) left_index = clone_subtree(left_index);
+    auto right_index = node2.inner_index;
+    if (!node_is_parent_null(node_pool[right_index]) || right_index == left_index) right_index = clone_subtree(right_index);
+
+    const auto parent_index                = allocate_node();
+    auto&      inserted_node               = node_pool[parent_index];
+    node_fetch_is_primitive(inserted_node) = false;
+    node_fetch_operation(inserted_node)    = op;
+    inserted_node.left_child_index         = left_index;
+    inserted_node.right_child_index        = right_index;
+
+    node_pool[left_index].parent_index  = parent_index;
+    node_pool[right_index].parent_index = parent_index;
+
+    node1.inner_index                       = parent_index;
+    structures[node1.main_index].root_index = parent_index;
 }
 
 BS_API void virtual_node_boolean_union(virtual_node_t& node1, const virtual_node_t& node2)
@@ -386,6 +573,117 @@ BS_API void virtual_node_boolean_difference(virtual_node_t& node1, const virtual
     virtual_node_boolean_op(node1, node2, eNodeOperation::differenceOp);
 }
 
+// links the operands as the children of an inner node, n-ary if there are more than two of them; an n-ary node keeps its
+// child range when the operands fit into it
+static inline void set_node_operands(uint32_t node_index, const std::vector<uint32_t, tbb::tbb_allocator<uint32_t>>& operands)
+{
+    auto& node_in_tree = node_pool[node_index];
+    if (operands.size() > 2) {
+        if (!node_in_tree.is_nary() || node_in_tree.children_count() < operands.size()) {
+            node_in_tree.left_child_index = static_cast<uint32_t>(node_children_pool.size());
+            node_children_pool.resize(node_children_pool.size() + operands.size());
+        }
+        node_in_tree.right_child_index = static_cast<uint32_t>(operands.size());
+        node_in_tree.flags             = node_in_tree.flags & ~(1u << node_t::binary_offset);
+        std::copy(operands.begin(), operands.end(), node_children_pool.begin() + node_in_tree.children_offset());
+    } else {
+        node_in_tree.left_child_index  = operands.front();
+        node_in_tree.right_child_index = operands.back();
+        node_in_tree.flags             = node_in_tree.flags | (1u << node_t::binary_offset);
+    }
+    for (const auto& operand_index : operands) node_pool[operand_index].parent_index = node_index;
+}
+
+BS_API void virtual_node_flatten(const virtual_node_t& node)
+{
+    std::lock_guard lock{blobtree_mutex};
+
+    std::stack<uint32_t, std::vector<uint32_t, tbb::tbb_allocator<uint32_t>>> pending_nodes{}, chain_nodes{};
+    std::vector<uint32_t, tbb::tbb_allocator<uint32_t>>                      operands{};
+
+    // the root of a live structure is never absorbed into the chain above it, so that the structure still owns its subtree
+    // and can be edited through its own handle afterwards
+    std::vector<bool> is_structure_root(node_pool.size(), false);
+    for (const auto& structure : structures)
+        if (structure.root_index != invalid_node_index) is_structure_root[structure.root_index] = true;
+    const auto is_absorbable = [&](uint32_t node_index, eNodeOperation op) {
+        const auto& operand = node_pool[node_index];
+        return !operand.is_primitive() && operand.operation() == op && !is_structure_root[node_index];
+    };
+
+    const auto push_children = [](const node_t& parent, auto& stack) {
+        if (parent.is_nary()) {
+            const auto children = blobtree_get_node_children(parent);
+            for (auto iter = children.rbegin(); iter != children.rend(); ++iter) stack.push(*iter);
+        } else {
+            if (!node_is_right_child_null(parent)) stack.push(parent.right_child_index);
+            if (!node_is_left_child_null(parent)) stack.push(parent.left_child_index);
+        }
+    };
+
+    // top-down, so that every chain of the same operation is collected in a single pass from its topmost node, and the
+    // whole flattening stays linear in the number of nodes; absorbed inner nodes are left in the pool, unreachable
+    pending_nodes.push(node.inner_index);
+    while (!pending_nodes.empty()) {
+        const auto node_index = pending_nodes.top();
+        pending_nodes.pop();
+
+        auto& node_in_tree = node_pool[node_index];
+        if (node_in_tree.is_primitive()) continue;
+
+        const auto op = node_in_tree.operation();
+        if (op == eNodeOperation::differenceOp) {
+            // ((a - b) - c) - d => a - (b | c | d), the topmost absorbed difference node is reused as the union node
+            if (node_is_left_child_null(node_in_tree) || node_is_right_child_null(node_in_tree)) continue;
+
+            auto base_index = node_in_tree.left_child_index;
+            operands.assign(1, node_in_tree.right_child_index);
+            while (!node_pool[base_index].is_nary() && is_absorbable(base_index, eNodeOperation::differenceOp)) {
+                operands.emplace_back(node_pool[base_index].right_child_index);
+                base_index = node_pool[base_index].left_child_index;
+            }
+
+            if (operands.size() > 1) {
+                const auto union_index                      = node_in_tree.left_child_index;
+                node_fetch_operation(node_pool[union_index]) = eNodeOperation::unionOp;
+                std::reverse(operands.begin(), operands.end());
+                set_node_operands(union_index, operands);
+
+                node_in_tree.left_child_index       = base_index;
+                node_in_tree.right_child_index      = union_index;
+                node_pool[base_index].parent_index  = node_index;
+                node_pool[union_index].parent_index = node_index;
+            }
+
+            pending_nodes.push(node_in_tree.right_child_index);
+            pending_nodes.push(node_in_tree.left_child_index);
+            continue;
+        }
+        if (op != eNodeOperation::unionOp && op != eNodeOperation::intersectionOp) {
+            push_children(node_in_tree, pending_nodes);
+            continue;
+        }
+
+        // the node is only rewritten when some operand is absorbed, so flattening a flat tree again changes nothing
+        bool absorbed{};
+        operands.clear();
+        push_children(node_in_tree, chain_nodes);
+        while (!chain_nodes.empty()) {
+            const auto operand_index = chain_nodes.top();
+            chain_nodes.pop();
+            if (is_absorbable(operand_index, op)) {
+                push_children(node_pool[operand_index], chain_nodes);
+                absorbed = true;
+            } else {
+                operands.emplace_back(operand_index);
+            }
+        }
+
+        if (absorbed && operands.size() > 2) set_node_operands(node_index, operands);
+        for (auto iter = operands.rbegin(); iter != operands.rend(); ++iter) pending_nodes.push(*iter);
+    }
+}
+
 void offset_primitive(primitive_node_t& node, const Eigen::Vector3d& offset)
 {
     auto offset_point = [](raw_vector3d_t& point, const Eigen::Vector3d& offset) {
@@ -435,6 +733,12 @@ void offset_primitive(primitive_node_t& node, const Eigen::Vector3d& offset)
             for (int i = 0; i < desc->edges_number; i++) { offset_point(desc->points[i], offset); }
             break;
         }
+        case PRIMITIVE_TYPE_INSTANCE: {
+            // the shared base stays where it is
+            auto desc = static_cast<instance_descriptor_t*>(node.desc);
+            offset_point(desc->translation, offset);
+            break;
+        }
         default: {
             break;
         }
@@ -449,12 +753,12 @@ BS_API void virtual_node_offset(virtual_node_t& node, const raw_vector3d_t& dire
 
 BS_API void virtual_node_offset(virtual_node_t& node, const raw_vector3d_t& offset)
 {
+    std::lock_guard lock{blobtree_mutex};
+
     Eigen::Map<const Eigen::Vector3d> offset_(&offset.x);
 
-    auto& all_leaf = structures[node.main_index].leaf_index;
-    for (const auto& leaf_index : structures[node.main_index].leaf_index) {
-        auto&          primitive_node  = structures[node.main_index].nodes[leaf_index];
-        const uint32_t primitive_index = node_fetch_primitive_index(primitive_node);
+    for (const auto& leaf_index : blobtree_get_leaf_nodes(node.main_index)) {
+        const uint32_t primitive_index = node_pool[leaf_index].primitive_index();
 
         offset_primitive(primitives[primitive_index], offset_);
         aabbs[primitive_index].offset(offset_);
@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "internal_api.hpp"
+
+#include "globals.hpp"
+
+/* =============================================================================================
+ * boolean-aware bounds
+ * ============================================================================================= */
+
+static constexpr double infinity = std::numeric_limits<double>::infinity();
+
+static inline aabb_t unbounded_aabb() { return {Eigen::Vector3d::Constant(-infinity), Eigen::Vector3d::Constant(infinity)}; }
+
+static inline bool is_empty(const aabb_t& aabb) { return (aabb.min.array() > aabb.max.array()).any(); }
+
+static inline bool is_bounded(const aabb_t& aabb) { return aabb.min.allFinite() && aabb.max.allFinite(); }
+
+static inline void intersect(aabb_t& aabb, const aabb_t& other)
+{
+    aabb.min = aabb.min.cwiseMax(other.min);
+    aabb.max = aabb.max.cwiseMin(other.max);
+}
+
+// the box of aabb ∩ {x : normal · (x - point) <= 0}, i.e. of the inside of a plane primitive
+static inline aabb_t clip_by_half_space(const aabb_t& aabb, const Eigen::Vector3d& normal, const Eigen::Vector3d& point)
+{
+    if (is_empty(aabb) || normal.isZero()) return aabb;
+
+    // an axis-aligned half-space just moves one face, which also works for unbounded boxes
+    for (int axis = 0; axis < 3; ++axis) {
+        if (normal[(axis + 1) % 3] != 0 || normal[(axis + 2) % 3] != 0) continue;
+
+        auto result = aabb;
+        if (normal[axis] > 0) {
+            result.max[axis] = std::min(result.max[axis], point[axis]);
+        } else {
+            result.min[axis] = std::max(result.min[axis], point[axis]);
+        }
+        return result;
+    }
+    if (!is_bounded(aabb)) return aabb;
+
+    // otherwise the clipped box is a convex polytope, whose vertices are the corners inside the half-space and the points
+    // where the plane cuts the edges of the box
+    Eigen::Vector3d corners[8];
+    double          distances[8];
+    for (int i = 0; i < 8; ++i) {
+        corners[i]   = {i & 1 ? aabb.max.x() : aabb.min.x(), //
+                        i & 2 ? aabb.max.y() : aabb.min.y(),
+                        i & 4 ? aabb.max.z() : aabb.min.z()};
+        distances[i] = normal.dot(corners[i] - point);
+    }
+
+    aabb_t result{};
+    for (int i = 0; i < 8; ++i) {
+        if (distances[i] <= 0) result.extend(corners[i]);
+        // the three edges leaving corner i towards the larger corners
+        for (int bit = 1; bit < 8; bit <<= 1) {
+            if (i & bit) continue;
+            const auto j = i | bit;
+            if ((distances[i] < 0) == (distances[j] < 0)) continue;
+            const auto t = distances[i] / (distances[i] - distances[j]);
+            result.extend(Eigen::Vector3d{corners[i] + t * (corners[j] - corners[i])});
+        }
+    }
+    return result;
+}
+
+static inline const plane_descriptor_t* plane_of(const node_t& node)
+{
+    if (!node.is_primitive()) return nullptr;
+    const auto& primitive = primitives[node.primitive_index()];
+    return primitive.type == PRIMITIVE_TYPE_PLANE ? static_cast<const plane_descriptor_t*>(primitive.desc) : nullptr;
+}
+
+static inline aabb_t primitive_bounds(const node_t& node)
+{
+    const auto& primitive = primitives[node.primitive_index()];
+    switch (primitive.type) {
+        // constants are either everywhere or nowhere
+        case PRIMITIVE_TYPE_CONSTANT:
+            return static_cast<const constant_descriptor_t*>(primitive.desc)->value > 0 ? aabb_t{} : unbounded_aabb();
+        // handled by their parents, where they clip the bounds of the siblings
+        case PRIMITIVE_TYPE_PLANE: return unbounded_aabb();
+        default:                   return aabbs[node.primitive_index()];
+    }
+}
+
+BS_API aabb_t blobtree_get_bounds(const virtual_node_t& node) noexcept
+{
+    // children are visited before their parents by walking a pre-order backwards
+    std::vector<uint32_t> pre_order{};
+    std::vector<uint32_t> pending_nodes{node.inner_index};
+    while (!pending_nodes.empty()) {
+        const auto  node_index = pending_nodes.back();
+        const auto& node       = node_pool[node_index];
+        pending_nodes.pop_back();
+        pre_order.emplace_back(node_index);
+        if (node.is_primitive()) continue;
+
+        if (node.is_nary()) {
+            const auto children = blobtree_get_node_children(node);
+            pending_nodes.insert(pending_nodes.end(), children.begin(), children.end());
+        } else {
+            if (!node_is_left_child_null(node)) pending_nodes.emplace_back(node.left_child_index);
+            if (!node_is_right_child_null(node)) pending_nodes.emplace_back(node.right_child_index);
+        }
+    }
+
+    std::vector<aabb_t>   node_bounds(node_pool.size());
+    std::vector<uint32_t> children{};
+    for (auto iter = pre_order.rbegin(); iter != pre_order.rend(); ++iter) {
+        const auto& current = node_pool[*iter];
+        auto&       bounds  = node_bounds[*iter];
+        if (current.is_primitive()) {
+            bounds = primitive_bounds(current);
+            continue;
+        }
+
+        children.clear();
+        if (current.is_nary()) {
+            const auto node_children = blobtree_get_node_children(current);
+            children.assign(node_children.begin(), node_children.end());
+        } else {
+            if (!node_is_left_child_null(current)) children.emplace_back(current.left_child_index);
+            if (!node_is_right_child_null(current)) children.emplace_back(current.right_child_index);
+        }
+
+        switch (current.operation()) {
+            case eNodeOperation::unionOp: {
+                bounds = aabb_t{};
+                for (const auto& child_index : children) bounds.extend(node_bounds[child_index]);
+                break;
+            }
+            case eNodeOperation::intersectionOp: {
+                // the planes are unbounded on their own, so they are applied last to clip the box of their siblings
+                bounds = unbounded_aabb();
+                for (const auto& child_index : children) intersect(bounds, node_bounds[child_index]);
+                for (const auto& child_index : children) {
+                    if (const auto plane = plane_of(node_pool[child_index]); plane)
+                        bounds = clip_by_half_space(bounds,
+                                                    Eigen::Map<const Eigen::Vector3d>(&plane->normal.x),
+                                                    Eigen::Map<const Eigen::Vector3d>(&plane->point.x));
+                }
+                break;
+            }
+            case eNodeOperation::differenceOp: {
+                // only the minuend contributes, unless the subtrahend is a plane, which keeps the outside of the plane
+                bounds = children.empty() ? aabb_t{} : node_bounds[children.front()];
+                if (children.size() < 2) break;
+                if (const auto plane = plane_of(node_pool[children.back()]); plane)
+                    bounds = clip_by_half_space(bounds,
+                                                -Eigen::Map<const Eigen::Vector3d>(&plane->normal.x),
+                                                Eigen::Map<const Eigen::Vector3d>(&plane->point.x));
+                break;
+            }
+            default: bounds = unbounded_aabb(); break;
+        }
+    }
+
+    return node_bounds[node.inner_index];
+}
@@ -83,6 +83,16 @@ void output_primitive_node(const primitive_node_t& node)
             }
             break;
         }
+        case PRIMITIVE_TYPE_INSTANCE: {
+            auto desc = static_cast<instance_descriptor_t*>(node.desc);
+            std::cout << "instance:" << std::endl;
+            std::cout << "\tbase index: " << desc->base_index << std::endl;
+            std::cout << "\trotation: ";
+            for (int i = 0; i < 9; i++) { std::cout << desc->rotation[i] << " "; }
+            std::cout << std::endl << "\ttranslation: ";
+            output_point(desc->translation);
+            break;
+        }
         // TODO : add extrude body output
         default: {
             break;
@@ -103,7 +113,7 @@ void output_blobtree(virtual_node_t node)
     index[6] = "mesh";
     index[7] = "extrude";
 
-    auto               root = structures[node.main_index].nodes[node.inner_index];
+    auto               root = node_pool[node.inner_index];
     std::queue<node_t> now, next;
     now.push(root);
 
@@ -130,11 +140,17 @@ void output_blobtree(virtual_node_t node)
             }
         }
 
-        if (!node_is_left_child_null(begin)) {
-            next.push(structures[node.main_index].nodes[node_fetch_left_child_index(begin)]);
-        }
-        if (!node_is_right_child_null(begin)) {
-            next.push(structures[node.main_index].nodes[node_fetch_right_child_index(begin)]);
+        if (begin.is_nary()) {
+            for (uint32_t i = 0; i < begin.children_count(); i++) {
+                next.push(node_pool[node_children_pool[begin.children_offset() + i]]);
+            }
+        } else {
+            if (!node_is_left_child_null(begin)) {
+                next.push(node_pool[node_fetch_left_child_index(begin)]);
+            }
+            if (!node_is_right_child_null(begin)) {
+                next.push(node_pool[node_fetch_right_child_index(begin)]);
+            }
         }
 
         if (now.empty()) {
@@ -1,5 +1,7 @@
+#include <algorithm>
 #include <functional>
 #include <iostream>
+#include <stdexcept>
 #include <type_traits>
 
 #include "blobtree.h"
@@ -7,34 +9,48 @@
 
 #include "globals.hpp"
 #include "primitive_node_constructor.hpp"
+#include "primitive_node_destroyer.hpp"
 
 /* Geometry Generation */
 
-virtual_node_t push_primitive_node(primitive_node_t&& primitive_node, const aabb_t&& aabb)
+// copies the descriptor and sets up its aabb; this only touches the new primitive, so it runs without the lock
+template <primitive_type type, typename T, typename __desc_constructor, typename __aabb_initer>
+std::pair<primitive_node_t, aabb_t> make_primitive(T&& desc, __desc_constructor&& desc_constructor, __aabb_initer&& aabb_initer)
 {
-    aabbs.emplace_back(aabb);
-    primitives.emplace_back(primitive_node);
-
-    node_t node                      = standard_new_node;
-    node_fetch_primitive_index(node) = static_cast<uint32_t>(primitives.size() - 1);
+    primitive_node_t node{type, malloc(sizeof(std::remove_cv_t<std::remove_reference_t<T>>))};
+    aabb_t           aabb{};
+    aabb_initer(aabb);
+    desc_constructor(node.desc);
+    return {node, aabb};
+}
 
-    blobtree_t tree;
-    tree.nodes.emplace_back(node);
-    tree.leaf_index.push_back(0);
+// CAUTION: the functions below expect blobtree_mutex to be held
 
-    structures.push_back(tree);
+// returns the index of the new primitive, without creating any node for it
+static inline uint32_t push_primitive(const primitive_node_t& node, const aabb_t& aabb)
+{
+    aabbs.emplace_back(aabb);
+    primitives.emplace_back(node);
+    return static_cast<uint32_t>(primitives.size() - 1);
+}
 
-    return virtual_node_t{static_cast<uint32_t>(structures.size() - 1), 0};
+static inline uint32_t push_leaf_node(uint32_t primitive_index)
+{
+    const auto node_index                             = allocate_node();
+    node_fetch_primitive_index(node_pool[node_index]) = primitive_index;
+    return node_index;
 }
 
 template <primitive_type type, typename T, typename __desc_constructor, typename __aabb_initer>
 virtual_node_t insert_primitive_node(T&& desc, __desc_constructor&& desc_constructor, __aabb_initer&& aabb_initer)
 {
-    primitive_node_t node{type, malloc(sizeof(std::remove_cv_t<std::remove_reference_t<T>>))};
-    aabb_t           aabb{};
-    aabb_initer(aabb);
-    desc_constructor(node.desc);
-    return push_primitive_node(std::move(node), std::move(aabb));
+    const auto [primitive, aabb] = make_primitive<type>(desc, desc_constructor, aabb_initer);
+
+    std::lock_guard lock{blobtree_mutex};
+    const auto      primitive_index = push_primitive(primitive, aabb);
+    const auto      node_index      = push_leaf_node(primitive_index);
+
+    return virtual_node_t{allocate_structure(node_index), node_index};
 }
 
 BS_API void blobtree_free_virtual_node(const virtual_node_t& node) { free_sub_blobtree(node.main_index); }
@@ -83,4 +99,190 @@ PRIM_NODE_MOVE_CONSTRUCTOR(box, BOX, plain_desc_move_constructor, box_aabb_inite
 PRIM_NODE_MOVE_CONSTRUCTOR(mesh, MESH, mesh_desc_move_constructor, mesh_aabb_initer);
 PRIM_NODE_MOVE_CONSTRUCTOR(extrude, EXTRUDE, extrude_desc_move_constructor, extrude_aabb_initer);
 
-#undef PRIM_NODE_MOVE_CONSTRUCTOR
\ No newline at end of file
+#undef PRIM_NODE_MOVE_CONSTRUCTOR
+
+// ==================================================================================================
+// bulk constructor
+// ==================================================================================================
+
+// the types make_primitive below can build, any other one would throw from inside the parallel copies
+static inline bool is_known_type(primitive_type type)
+{
+    switch (type) {
+        case PRIMITIVE_TYPE_CONSTANT:
+        case PRIMITIVE_TYPE_PLANE:
+        case PRIMITIVE_TYPE_SPHERE:
+        case PRIMITIVE_TYPE_CYLINDER:
+        case PRIMITIVE_TYPE_CONE:
+        case PRIMITIVE_TYPE_BOX:
+        case PRIMITIVE_TYPE_MESH:
+        case PRIMITIVE_TYPE_EXTRUDE:
+        case PRIMITIVE_TYPE_INSTANCE: return true;
+        default:                      return false;
+    }
+}
+
+// the descriptor types, the stack depth and the references of a postfix program are checked before anything is built,
+// so that a malformed program leaves the blobtree untouched
+static inline bool validate_scene_program(span<const primitive_node_t> descs, span<const scene_op_t> program)
+{
+    for (const auto& desc : descs)
+        if (!is_known_type(desc.type)) return false;
+
+    const auto        primitive_count = static_cast<uint32_t>(descs.size());
+    std::vector<bool> referenced(primitive_count, false);
+    uint32_t          depth{};
+    for (const auto& op : program) {
+        if (op.type == SCENE_OP_PRIMITIVE) {
+            // every primitive has a single leaf, so that the solver can map primitives to leaves
+            if (op.primitive_index >= primitive_count || referenced[op.primitive_index]) return false;
+            referenced[op.primitive_index] = true;
+            depth++;
+        } else if (op.type == SCENE_OP_UNION || op.type == SCENE_OP_INTERSECTION || op.type == SCENE_OP_DIFFERENCE) {
+            if (depth < 2) return false;
+            depth--;
+        } else {
+            // the type comes from C callers as a plain integer, so it may be out of the enum
+            return false;
+        }
+    }
+    return depth == 1 && std::find(referenced.begin(), referenced.end(), false) == referenced.end();
+}
+
+#define PRIM_NODE_BULK_CONSTRUCTOR(low_name, high_name, desc_constructor, aabb_initer)                                     \
+    case PRIMITIVE_TYPE_##high_name: {                                                                                     \
+        const auto& desc = *static_cast<const low_name##_descriptor_t*>(node.desc);                                        \
+        return make_primitive<PRIMITIVE_TYPE_##high_name>(desc,                                                            \
+                                                          std::bind(desc_constructor, desc, std::placeholders::_1),        \
+                                                          std::bind(aabb_initer, desc, std::placeholders::_1));            \
+    }
+
+static inline std::pair<primitive_node_t, aabb_t> make_primitive(const primitive_node_t& node)
+{
+    switch (node.type) {
+        PRIM_NODE_BULK_CONSTRUCTOR(constant, CONSTANT, plain_desc_copy_constructor, plain_aabb_initer);
+        PRIM_NODE_BULK_CONSTRUCTOR(plane, PLANE, plain_desc_copy_constructor, plain_aabb_initer);
+        PRIM_NODE_BULK_CONSTRUCTOR(sphere, SPHERE, plain_desc_copy_constructor, sphere_aabb_initer);
+        PRIM_NODE_BULK_CONSTRUCTOR(cylinder, CYLINDER, plain_desc_copy_constructor, cylinder_aabb_initer);
+        PRIM_NODE_BULK_CONSTRUCTOR(cone, CONE, plain_desc_copy_constructor, cone_aabb_initer);
+        PRIM_NODE_BULK_CONSTRUCTOR(box, BOX, plain_desc_copy_constructor, box_aabb_initer);
+        PRIM_NODE_BULK_CONSTRUCTOR(mesh, MESH, mesh_desc_copy_constructor, mesh_aabb_initer);
+        PRIM_NODE_BULK_CONSTRUCTOR(extrude, EXTRUDE, extrude_desc_copy_constructor, extrude_aabb_initer);
+        // the box of an instance depends on its base, so it is only set up once the lock is held
+        PRIM_NODE_BULK_CONSTRUCTOR(instance, INSTANCE, plain_desc_copy_constructor, plain_aabb_initer);
+        default: throw std::runtime_error("ERROR: Unknown primitive type.");
+    }
+}
+
+#undef PRIM_NODE_BULK_CONSTRUCTOR
+
+BS_API virtual_node_t blobtree_new_scene(span<const primitive_node_t> descs, span<const scene_op_t> program)
+{
+    if (!validate_scene_program(descs, program)) return {invalid_node_index, invalid_node_index};
+
+    // the descriptor copies are the expensive part, they are made in parallel and before taking the lock
+    std::vector<std::pair<primitive_node_t, aabb_t>> staged_primitives(descs.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, descs.size()), [&](const tbb::blocked_range<size_t>& range) {
+        for (auto i = range.begin(); i < range.end(); ++i) staged_primitives[i] = make_primitive(descs[i]);
+    });
+
+    std::lock_guard lock{blobtree_mutex};
+
+    // instances may only refer to bases created before, which are not part of the program
+    for (auto& [primitive, aabb] : staged_primitives) {
+        if (primitive.type != PRIMITIVE_TYPE_INSTANCE) continue;
+
+        const auto& desc = *static_cast<const instance_descriptor_t*>(primitive.desc);
+        if (!is_rigid_rotation(desc.rotation) || !is_valid_instance_base(desc.base_index)) {
+            for (auto& [staged_primitive, staged_aabb] : staged_primitives) destroy_primitive_node(staged_primitive);
+            return {invalid_node_index, invalid_node_index};
+        }
+        resolve_instance_base(primitive, aabb);
+    }
+
+    // every global vector grows once
+    const auto first_primitive_index = static_cast<uint32_t>(primitives.size());
+    primitives.reserve(primitives.size() + descs.size());
+    aabbs.reserve(aabbs.size() + descs.size());
+    node_pool.reserve(node_pool.size() + program.size());
+
+    for (const auto& [primitive, aabb] : staged_primitives) push_primitive(primitive, aabb);
+
+    std::vector<uint32_t> operands{};
+    operands.reserve(descs.size());
+    for (const auto& op : program) {
+        if (op.type == SCENE_OP_PRIMITIVE) {
+            operands.emplace_back(push_leaf_node(first_primitive_index + op.primitive_index));
+            continue;
+        }
+
+        const auto right_index = operands.back();
+        operands.pop_back();
+        const auto left_index = operands.back();
+
+        const auto parent_index                = allocate_node();
+        auto&      inserted_node               = node_pool[parent_index];
+        node_fetch_is_primitive(inserted_node) = false;
+        switch (op.type) {
+            case SCENE_OP_UNION:        node_fetch_operation(inserted_node) = eNodeOperation::unionOp; break;
+            case SCENE_OP_INTERSECTION: node_fetch_operation(inserted_node) = eNodeOperation::intersectionOp; break;
+            default:                    node_fetch_operation(inserted_node) = eNodeOperation::differenceOp; break;
+        }
+        inserted_node.left_child_index  = left_index;
+        inserted_node.right_child_index = right_index;
+
+        node_pool[left_index].parent_index  = parent_index;
+        node_pool[right_index].parent_index = parent_index;
+        operands.back()                     = parent_index;
+    }
+
+    return virtual_node_t{allocate_structure(operands.back()), operands.back()};
+}
+
+// ==================================================================================================
+// instances
+// ==================================================================================================
+
+BS_API uint32_t blobtree_new_instance_base(const primitive_node_t& desc)
+{
+    if (!is_instantiable(desc.type)) return invalid_primitive_index;
+
+    const auto [primitive, aabb] = make_primitive(desc);
+
+    std::lock_guard lock{blobtree_mutex};
+    instance_bases.emplace_back(push_primitive(primitive, aabb));
+    return static_cast<uint32_t>(instance_bases.size() - 1);
+}
+
+BS_API void blobtree_release_instance_base(uint32_t base_index) noexcept
+{
+    std::lock_guard lock{blobtree_mutex};
+    if (base_index < instance_bases.size()) instance_bases[base_index] = invalid_primitive_index;
+}
+
+// unlike the other primitives, the box of an instance is derived from its base, so it is set up under the lock
+template <typename T, typename __desc_constructor>
+virtual_node_t insert_instance_node(T&& desc, __desc_constructor&& desc_constructor)
+{
+    if (!is_rigid_rotation(desc.rotation)) return {invalid_node_index, invalid_node_index};
+
+    std::lock_guard lock{blobtree_mutex};
+    if (!is_valid_instance_base(desc.base_index)) return {invalid_node_index, invalid_node_index};
+
+    auto [primitive, aabb] = make_primitive<PRIMITIVE_TYPE_INSTANCE>(desc, desc_constructor, [](aabb_t&) {});
+    resolve_instance_base(primitive, aabb);
+    const auto primitive_index = push_primitive(primitive, aabb);
+    const auto node_index      = push_leaf_node(primitive_index);
+
+    return virtual_node_t{allocate_structure(node_index), node_index};
+}
+
+BS_API virtual_node_t blobtree_new_virtual_node(const instance_descriptor_t& desc)
+{
+    return insert_instance_node(desc, std::bind(plain_desc_copy_constructor, desc, std::placeholders::_1));
+}
+
+BS_API virtual_node_t blobtree_new_virtual_node(const instance_descriptor_t&& desc)
+{
+    return insert_instance_node(desc, std::bind(plain_desc_move_constructor, desc, std::placeholders::_1));
+}
\ No newline at end of file
@@ -10,22 +10,28 @@ bool replace_primitive_node(const virtual_node_t& node,
                             __desc_constructor&&  desc_constructor,
                             __aabb_initer&&       aabb_initer)
 {
-    auto& node_in_tree = structures[node.main_index].nodes[node.inner_index];
+    // the new descriptor is built before taking the lock, and the old one is destroyed after releasing it
+    primitive_node_t new_primitive{type, malloc(sizeof(std::remove_cv_t<std::remove_reference_t<T&&>>))};
+    aabb_t           new_aabb{};
+    aabb_initer(new_aabb);
+    desc_constructor(new_primitive.desc);
 
-    if (!node_fetch_is_primitive(node_in_tree)) { return false; }
+    bool replaced{};
+    {
+        std::lock_guard lock{blobtree_mutex};
 
-    const uint32_t primitive_index = node_fetch_primitive_index(node_in_tree);
-    auto&          primitive       = primitives[primitive_index];
-    auto&          aabb            = aabbs[primitive_index];
-
-    destroy_primitive_node(primitive);
-    primitive = {type, malloc(sizeof(std::remove_cv_t<std::remove_reference_t<T&&>>))};
-    aabb.clear();
-
-    aabb_initer(aabb);
-    desc_constructor(primitive.desc);
+        auto& node_in_tree = node_pool[node.inner_index];
+        if (node_fetch_is_primitive(node_in_tree)) {
+            const uint32_t primitive_index = node_fetch_primitive_index(node_in_tree);
+            std::swap(primitives[primitive_index], new_primitive);
+            std::swap(aabbs[primitive_index], new_aabb);
+            replaced = true;
+        }
+    }
 
-    return true;
+    // either the replaced descriptor, or the new one if the node is not a primitive node
+    destroy_primitive_node(new_primitive);
+    return replaced;
 }
 
 // ==================================================================================================
@@ -74,4 +80,44 @@ PRIM_NODE_MOVE_REPLACER(box, BOX, plain_desc_move_constructor, box_aabb_initer);
 PRIM_NODE_MOVE_REPLACER(mesh, MESH, mesh_desc_move_constructor, mesh_aabb_initer);
 PRIM_NODE_MOVE_REPLACER(extrude, EXTRUDE, extrude_desc_move_constructor, extrude_aabb_initer);
 
-#undef PRIM_NODE_MOVE_REPLACER
\ No newline at end of file
+#undef PRIM_NODE_MOVE_REPLACER
+
+// ==================================================================================================
+// instance replacer
+// ==================================================================================================
+
+// the box of an instance is derived from its base, so both are set up under the lock
+template <typename T, typename __desc_constructor>
+bool replace_instance_node(const virtual_node_t& node, T&& desc, __desc_constructor&& desc_constructor)
+{
+    if (!is_rigid_rotation(desc.rotation)) return false;
+
+    primitive_node_t new_primitive{PRIMITIVE_TYPE_INSTANCE, malloc(sizeof(instance_descriptor_t))};
+    desc_constructor(new_primitive.desc);
+
+    bool replaced{};
+    {
+        std::lock_guard lock{blobtree_mutex};
+
+        auto& node_in_tree = node_pool[node.inner_index];
+        if (node_fetch_is_primitive(node_in_tree) && is_valid_instance_base(desc.base_index)) {
+            const uint32_t primitive_index = node_fetch_primitive_index(node_in_tree);
+            resolve_instance_base(new_primitive, aabbs[primitive_index]);
+            std::swap(primitives[primitive_index], new_primitive);
+            replaced = true;
+        }
+    }
+
+    destroy_primitive_node(new_primitive);
+    return replaced;
+}
+
+BS_API bool virtual_node_replace_primitive(const virtual_node_t& node, const instance_descriptor_t& desc)
+{
+    return replace_instance_node(node, desc, std::bind(plain_desc_copy_constructor, desc, std::placeholders::_1));
+}
+
+BS_API bool virtual_node_replace_primitive(const virtual_node_t& node, const instance_descriptor_t&& desc)
+{
+    return replace_instance_node(node, desc, std::bind(plain_desc_move_constructor, desc, std::placeholders::_1));
+}
\ No newline at end of file
@@ -0,0 +1,475 @@
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+#include <memory/mapped_file.hpp>
+
+#include "internal_api.hpp"
+
+#include "globals.hpp"
+#include "primitive_node_constructor.hpp"
+#include "primitive_node_destroyer.hpp"
+
+/* =============================================================================================
+ * file layout
+ * ============================================================================================= */
+
+// a scene file is a header followed by one aligned section per global container, stored as the in-memory records;
+// descriptor pointers are replaced by byte offsets into the payload section, and the endian tag records the byte order
+static constexpr char     scene_file_magic[8]   = {'B', 'L', 'O', 'B', 'T', 'R', 'E', 'E'};
+static constexpr uint32_t scene_file_version    = 2;
+static constexpr uint32_t scene_file_endian_tag = 0x01020304u;
+static constexpr uint64_t section_alignment     = 64;
+static constexpr uint64_t payload_alignment     = 8;
+
+enum scene_section_t : uint32_t {
+    SECTION_NODES,           // node_t
+    SECTION_NODE_CHILDREN,   // uint32_t, children of n-ary nodes
+    SECTION_STRUCTURES,      // uint32_t, root index of each structure
+    SECTION_FREE_STRUCTURES, // uint32_t, bottom to top
+    SECTION_FREE_NODES,      // uint32_t, bottom to top
+    SECTION_INSTANCE_BASES,  // uint32_t, primitive index of each base handle
+    SECTION_AABBS,           // 6 doubles, min then max
+    SECTION_PRIMITIVES,      // scene_primitive_record_t
+    SECTION_PAYLOAD,         // descriptor structs and their arrays
+    SECTION_COUNT
+};
+
+struct scene_section_entry_t {
+    uint64_t offset{}; // in bytes, from the start of the file
+    uint64_t size{};   // in bytes
+};
+
+struct scene_file_header_t {
+    char                  magic[8]{};
+    uint32_t              version{};
+    uint32_t              endian_tag{};
+    uint32_t              node_size{}; // sizeof(node_t), so that files of a different node layout are refused
+    uint32_t              section_count{};
+    scene_section_entry_t sections[SECTION_COUNT]{};
+};
+
+struct scene_primitive_record_t {
+    uint32_t type{};
+    uint32_t desc_size{};
+    uint64_t desc_offset{}; // into the payload section
+};
+
+static_assert(std::is_trivially_copyable_v<scene_file_header_t> && std::is_trivially_copyable_v<scene_primitive_record_t>);
+static_assert(std::is_trivially_copyable_v<blobtree_t> && sizeof(blobtree_t) == sizeof(uint32_t));
+static_assert(sizeof(aabb_t) == 6 * sizeof(double));
+static_assert(sizeof(void*) == sizeof(uint64_t), "descriptor pointers are stored as 64-bit payload offsets");
+
+static inline uint64_t align_up(uint64_t value, uint64_t alignment) { return (value + alignment - 1) / alignment * alignment; }
+
+static inline uint32_t descriptor_size(uint32_t type)
+{
+    switch (type) {
+        case PRIMITIVE_TYPE_CONSTANT: return sizeof(constant_descriptor_t);
+        case PRIMITIVE_TYPE_PLANE:    return sizeof(plane_descriptor_t);
+        case PRIMITIVE_TYPE_SPHERE:   return sizeof(sphere_descriptor_t);
+        case PRIMITIVE_TYPE_CYLINDER: return sizeof(cylinder_descriptor_t);
+        case PRIMITIVE_TYPE_CONE:     return sizeof(cone_descriptor_t);
+        case PRIMITIVE_TYPE_BOX:      return sizeof(box_descriptor_t);
+        case PRIMITIVE_TYPE_MESH:     return sizeof(mesh_descriptor_t);
+        case PRIMITIVE_TYPE_EXTRUDE:  return sizeof(extrude_descriptor_t);
+        case PRIMITIVE_TYPE_INSTANCE: return sizeof(instance_descriptor_t);
+        default:                      return 0;
+    }
+}
+
+// the array lengths owned by a descriptor, the same as the ones copied by primitive_node_constructor.hpp
+static inline uint64_t mesh_index_count(const mesh_descriptor_t& desc)
+{
+    // summed in 64 bits, so that damaged face records cannot wrap the count around
+    uint64_t count{};
+    for (uint32_t i = 0; i < desc.face_number; ++i) count += desc.faces[i].vertex_count;
+    return count;
+}
+
+static inline uint32_t extrude_point_count(const extrude_descriptor_t& desc)
+{
+    return desc.edges_number > 0 ? desc.edges_number - 1 : 0;
+}
+
+/* =============================================================================================
+ * save
+ * ============================================================================================= */
+
+// appends a block to the payload and returns its offset
+static inline uint64_t append_payload(std::vector<char>& payload, const void* data, uint64_t size)
+{
+    const auto offset = align_up(payload.size(), payload_alignment);
+    payload.resize(offset + size);
+    if (size > 0) std::memcpy(payload.data() + offset, data, size);
+    return offset;
+}
+
+template <typename T>
+static inline T* offset_to_pointer(uint64_t offset)
+{
+    return reinterpret_cast<T*>(static_cast<uintptr_t>(offset));
+}
+
+static inline bool append_primitive(std::vector<char>&                     payload,
+                                    std::vector<scene_primitive_record_t>& records,
+                                    const primitive_node_t&                primitive)
+{
+    auto& record = records.emplace_back(scene_primitive_record_t{primitive.type, descriptor_size(primitive.type), 0});
+    if (record.desc_size == 0) return false;
+
+    switch (primitive.type) {
+        case PRIMITIVE_TYPE_MESH: {
+            auto image    = *static_cast<const mesh_descriptor_t*>(primitive.desc);
+            image.indices = offset_to_pointer<uint32_t>(
+                append_payload(payload, image.indices, mesh_index_count(image) * sizeof(uint32_t)));
+            image.points = offset_to_pointer<raw_vector3d_t>(
+                append_payload(payload, image.points, uint64_t{image.point_number} * sizeof(raw_vector3d_t)));
+            image.faces = offset_to_pointer<polygon_face_descriptor_t>(
+                append_payload(payload, image.faces, uint64_t{image.face_number} * sizeof(polygon_face_descriptor_t)));
+            record.desc_offset = append_payload(payload, &image, sizeof(image));
+            break;
+        }
+        case PRIMITIVE_TYPE_EXTRUDE: {
+            auto image   = *static_cast<const extrude_descriptor_t*>(primitive.desc);
+            image.points = offset_to_pointer<raw_vector3d_t>(
+                append_payload(payload, image.points, uint64_t{extrude_point_count(image)} * sizeof(raw_vector3d_t)));
+            image.bulges = offset_to_pointer<double>(
+                append_payload(payload, image.bulges, uint64_t{image.edges_number} * sizeof(double)));
+            record.desc_offset = append_payload(payload, &image, sizeof(image));
+            break;
+        }
+        default: record.desc_offset = append_payload(payload, primitive.desc, record.desc_size); break;
+    }
+    return true;
+}
+
+template <typename Container>
+static inline std::vector<uint32_t> stack_to_vector(Container stack)
+{
+    std::vector<uint32_t> result(stack.size());
+    for (auto iter = result.rbegin(); iter != result.rend(); ++iter) {
+        *iter = stack.top();
+        stack.pop();
+    }
+    return result;
+}
+
+BS_API bool blobtree_save(const char* path) noexcept
+{
+    std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+
+    std::lock_guard lock{blobtree_mutex};
+
+    std::vector<char>                     payload{};
+    std::vector<scene_primitive_record_t> records{};
+    records.reserve(primitives.size());
+    for (const auto& primitive : primitives)
+        if (!append_primitive(payload, records, primitive)) return false;
+
+    std::vector<double> aabb_values{};
+    aabb_values.reserve(aabbs.size() * 6);
+    for (const auto& aabb : aabbs) {
+        aabb_values.insert(aabb_values.end(), aabb.min.data(), aabb.min.data() + 3);
+        aabb_values.insert(aabb_values.end(), aabb.max.data(), aabb.max.data() + 3);
+    }
+
+    const auto free_structures = stack_to_vector(free_structure_list);
+    const auto free_nodes      = stack_to_vector(free_node_list);
+
+    const std::pair<const void*, uint64_t> section_data[SECTION_COUNT] = {
+        {node_pool.data(),          node_pool.size() * sizeof(node_t)                },
+        {node_children_pool.data(), node_children_pool.size() * sizeof(uint32_t)     },
+        {structures.data(),         structures.size() * sizeof(blobtree_t)           },
+        {free_structures.data(),    free_structures.size() * sizeof(uint32_t)        },
+        {free_nodes.data(),         free_nodes.size() * sizeof(uint32_t)             },
+        {instance_bases.data(),     instance_bases.size() * sizeof(uint32_t)         },
+        {aabb_values.data(),        aabb_values.size() * sizeof(double)              },
+        {records.data(),            records.size() * sizeof(scene_primitive_record_t)},
+        {payload.data(),            payload.size()                                   }
+    };
+
+    scene_file_header_t header{};
+    std::memcpy(header.magic, scene_file_magic, sizeof(scene_file_magic));
+    header.version       = scene_file_version;
+    header.endian_tag    = scene_file_endian_tag;
+    header.node_size     = sizeof(node_t);
+    header.section_count = SECTION_COUNT;
+    uint64_t file_size   = sizeof(header);
+    for (uint32_t i = 0; i < SECTION_COUNT; ++i) {
+        header.sections[i] = {align_up(file_size, section_alignment), section_data[i].second};
+        file_size          = header.sections[i].offset + header.sections[i].size;
+    }
+
+    static constexpr char padding[section_alignment]{};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    uint64_t position = sizeof(header);
+    for (uint32_t i = 0; i < SECTION_COUNT; ++i) {
+        out.write(padding, static_cast<std::streamsize>(header.sections[i].offset - position));
+        out.write(static_cast<const char*>(section_data[i].first), static_cast<std::streamsize>(section_data[i].second));
+        position = header.sections[i].offset + header.sections[i].size;
+    }
+    return static_cast<bool>(out.flush());
+}
+
+/* =============================================================================================
+ * load
+ * ============================================================================================= */
+
+// a section of the mapped file, viewed as an array of T
+template <typename T>
+static inline span<const T> section_view(const mapped_file_t& file, const scene_section_entry_t& section)
+{
+    return {reinterpret_cast<const T*>(file.data() + section.offset), static_cast<size_t>(section.size / sizeof(T))};
+}
+
+static inline bool validate_header(const mapped_file_t& file, const scene_file_header_t& header)
+{
+    static constexpr uint64_t element_sizes[SECTION_COUNT] = {sizeof(node_t),
+                                                              sizeof(uint32_t),
+                                                              sizeof(blobtree_t),
+                                                              sizeof(uint32_t),
+                                                              sizeof(uint32_t),
+                                                              sizeof(uint32_t),
+                                                              6 * sizeof(double),
+                                                              sizeof(scene_primitive_record_t),
+                                                              1};
+
+    if (std::memcmp(header.magic, scene_file_magic, sizeof(scene_file_magic)) != 0) return false;
+    if (header.version != scene_file_version || header.endian_tag != scene_file_endian_tag) return false;
+    if (header.node_size != sizeof(node_t) || header.section_count != SECTION_COUNT) return false;
+    for (uint32_t i = 0; i < SECTION_COUNT; ++i) {
+        const auto& section = header.sections[i];
+        // the alignment check also keeps the typed views below aligned, as mappings start at a page boundary
+        if (section.offset % section_alignment != 0 || section.size % element_sizes[i] != 0) return false;
+        if (section.offset > file.size() || section.size > file.size() - section.offset) return false;
+    }
+    return header.sections[SECTION_AABBS].size / element_sizes[SECTION_AABBS]
+           == header.sections[SECTION_PRIMITIVES].size / element_sizes[SECTION_PRIMITIVES];
+}
+
+// every index stored in the nodes, structures and free lists must be in range, so that a damaged file cannot make the
+// solver read out of bounds later on
+static inline bool validate_indices(span<const node_t>   nodes,
+                                    span<const uint32_t> node_children,
+                                    span<const uint32_t> structure_roots,
+                                    span<const uint32_t> free_structures,
+                                    span<const uint32_t> free_nodes,
+                                    size_t               primitive_count)
+{
+    const auto is_node_index = [&](uint32_t index) { return index == invalid_node_index || index < nodes.size(); };
+
+    for (const auto& node : nodes) {
+        if (!is_node_index(node.parent_index)) return false;
+        if (node.is_primitive()) {
+            if (node.primitive_index() >= primitive_count && node != standard_new_node) return false;
+        } else if (node.is_nary()) {
+            if (node.children_offset() > node_children.size()
+                || node.children_count() > node_children.size() - node.children_offset())
+                return false;
+        } else if (!is_node_index(node.left_child_index) || !is_node_index(node.right_child_index)) {
+            return false;
+        }
+    }
+    for (const auto& child_index : node_children)
+        if (child_index >= nodes.size()) return false;
+    for (const auto& root_index : structure_roots)
+        if (!is_node_index(root_index)) return false;
+    for (const auto& index : free_structures)
+        if (index >= structure_roots.size()) return false;
+    for (const auto& index : free_nodes)
+        if (index >= nodes.size()) return false;
+    return true;
+}
+
+// the live structures must be trees, i.e. no node is reached through a cycle or from two parents, as the traversals
+// of the solver recurse without any visited set; expects the indices to be validated already
+static inline bool validate_tree_shape(span<const node_t>   nodes,
+                                       span<const uint32_t> node_children,
+                                       span<const uint32_t> structure_roots,
+                                       span<const uint32_t> free_structures)
+{
+    enum : uint8_t { unvisited, on_stack, finished };
+    std::vector<uint8_t> state(nodes.size(), unvisited);
+    std::vector<uint8_t> parent_count(nodes.size(), 0);
+    std::vector<bool>    is_free_structure(structure_roots.size(), false);
+    for (const auto& index : free_structures) is_free_structure[index] = true;
+
+    const auto children_of = [&](const node_t& node) -> std::vector<uint32_t> {
+        if (node.is_primitive()) return {};
+        if (node.is_nary())
+            return {node_children.begin() + node.children_offset(),
+                    node_children.begin() + node.children_offset() + node.children_count()};
+        return {node.left_child_index, node.right_child_index};
+    };
+
+    // iterative depth first search, a node is finished once all of its children are
+    std::vector<std::pair<uint32_t, std::vector<uint32_t>>> stack{};
+    for (uint32_t i = 0; i < structure_roots.size(); ++i) {
+        const auto root_index = structure_roots[i];
+        if (is_free_structure[i] || root_index == invalid_node_index || state[root_index] != unvisited) continue;
+
+        state[root_index] = on_stack;
+        stack.emplace_back(root_index, children_of(nodes[root_index]));
+        while (!stack.empty()) {
+            auto& pending = stack.back().second;
+            if (pending.empty()) {
+                state[stack.back().first] = finished;
+                stack.pop_back();
+                continue;
+            }
+
+            const auto child_index = pending.back();
+            pending.pop_back();
+            if (child_index == invalid_node_index) continue;
+            if (state[child_index] == on_stack || ++parent_count[child_index] > 1) return false;
+            if (state[child_index] == unvisited) {
+                state[child_index] = on_stack;
+                stack.emplace_back(child_index, children_of(nodes[child_index]));
+            }
+        }
+    }
+    return true;
+}
+
+// copies the bytes [offset, offset + size) of the payload into a new allocation, as primitive_node_destroyer.hpp
+// expects every descriptor array to be owned by malloc
+template <typename T>
+static inline bool copy_payload(span<const char> payload, const T* offset_pointer, uint64_t count, T*& target)
+{
+    const auto offset = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(offset_pointer));
+    if (count > payload.size() / sizeof(T)) return false;
+    const auto size = count * sizeof(T);
+    if (offset > payload.size() || size > payload.size() - offset) return false;
+
+    target = static_cast<T*>(malloc(size > 0 ? size : 1));
+    std::memcpy(target, payload.data() + offset, size);
+    return true;
+}
+
+// the faces must lie inside the index array, and the indices inside the point array, as the evaluation trusts both
+static inline bool validate_mesh(const mesh_descriptor_t& desc)
+{
+    const auto index_count = mesh_index_count(desc);
+    for (uint32_t i = 0; i < desc.face_number; ++i)
+        if (uint64_t{desc.faces[i].begin_index} + desc.faces[i].vertex_count > index_count) return false;
+    for (uint64_t i = 0; i < index_count; ++i)
+        if (desc.indices[i] >= desc.point_number) return false;
+    return true;
+}
+
+static inline bool load_primitive(span<const char> payload, const scene_primitive_record_t& record, primitive_node_t& primitive)
+{
+    if (record.desc_size == 0 || record.desc_size != descriptor_size(record.type)) return false;
+    if (record.desc_offset > payload.size() || record.desc_size > payload.size() - record.desc_offset) return false;
+
+    primitive = {static_cast<primitive_type>(record.type), malloc(record.desc_size)};
+    std::memcpy(primitive.desc, payload.data() + record.desc_offset, record.desc_size);
+
+    // the arrays are set to null first, so that a half-loaded descriptor can still be destroyed
+    switch (record.type) {
+        case PRIMITIVE_TYPE_MESH: {
+            auto       desc    = static_cast<mesh_descriptor_t*>(primitive.desc);
+            const auto points  = desc->points;
+            const auto indices = desc->indices;
+            const auto faces   = desc->faces;
+            desc->points       = nullptr;
+            desc->indices      = nullptr;
+            desc->faces        = nullptr;
+            return copy_payload(payload, faces, desc->face_number, desc->faces)
+                   && copy_payload(payload, points, desc->point_number, desc->points)
+                   && copy_payload(payload, indices, mesh_index_count(*desc), desc->indices) && validate_mesh(*desc);
+        }
+        case PRIMITIVE_TYPE_EXTRUDE: {
+            auto       desc   = static_cast<extrude_descriptor_t*>(primitive.desc);
+            const auto points = desc->points;
+            const auto bulges = desc->bulges;
+            desc->points      = nullptr;
+            desc->bulges      = nullptr;
+            return copy_payload(payload, points, extrude_point_count(*desc), desc->points)
+                   && copy_payload(payload, bulges, desc->edges_number, desc->bulges);
+        }
+        default: return true;
+    }
+}
+
+// the same rules as for new instances, their bases must be loaded as well
+static inline bool validate_instance_bases(span<const primitive_node_t> loaded_primitives, span<const uint32_t> base_handles)
+{
+    const auto is_base = [&](uint32_t index) {
+        return index < loaded_primitives.size() && is_instantiable(loaded_primitives[index].type);
+    };
+
+    for (const auto& base_index : base_handles)
+        if (base_index != invalid_primitive_index && !is_base(base_index)) return false;
+    for (const auto& primitive : loaded_primitives) {
+        if (primitive.type != PRIMITIVE_TYPE_INSTANCE) continue;
+
+        const auto& desc = *static_cast<const instance_descriptor_t*>(primitive.desc);
+        if (!is_rigid_rotation(desc.rotation) || !is_base(desc.base_index)) return false;
+    }
+    return true;
+}
+
+BS_API bool blobtree_load(const char* path) noexcept
+{
+    // every byte is read exactly once, front to back
+    const mapped_file_t file(path, file_access_pattern_t::sequential);
+    if (file.data() == nullptr || file.size() < sizeof(scene_file_header_t)) return false;
+
+    scene_file_header_t header{};
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (!validate_header(file, header)) return false;
+
+    const auto nodes           = section_view<node_t>(file, header.sections[SECTION_NODES]);
+    const auto node_children   = section_view<uint32_t>(file, header.sections[SECTION_NODE_CHILDREN]);
+    const auto structure_roots = section_view<uint32_t>(file, header.sections[SECTION_STRUCTURES]);
+    const auto free_structures = section_view<uint32_t>(file, header.sections[SECTION_FREE_STRUCTURES]);
+    const auto free_nodes      = section_view<uint32_t>(file, header.sections[SECTION_FREE_NODES]);
+    const auto base_handles    = section_view<uint32_t>(file, header.sections[SECTION_INSTANCE_BASES]);
+    const auto aabb_values     = section_view<double>(file, header.sections[SECTION_AABBS]);
+    const auto records         = section_view<scene_primitive_record_t>(file, header.sections[SECTION_PRIMITIVES]);
+    const auto payload         = section_view<char>(file, header.sections[SECTION_PAYLOAD]);
+    if (!validate_indices(nodes, node_children, structure_roots, free_structures, free_nodes, records.size())
+        || !validate_tree_shape(nodes, node_children, structure_roots, free_structures))
+        return false;
+
+    // the descriptors are rebuilt before taking the lock, and the current blobtree is kept if any of them is damaged
+    std::vector<primitive_node_t, tbb::tbb_allocator<primitive_node_t>> loaded_primitives(records.size());
+    for (size_t i = 0; i < records.size(); ++i) {
+        if (load_primitive(payload, records[i], loaded_primitives[i])) continue;
+
+        for (size_t j = 0; j <= i; ++j)
+            if (loaded_primitives[j].desc != nullptr) destroy_primitive_node(loaded_primitives[j]);
+        return false;
+    }
+    if (!validate_instance_bases(loaded_primitives, base_handles)) {
+        for (auto& primitive : loaded_primitives) destroy_primitive_node(primitive);
+        return false;
+    }
+
+    std::lock_guard lock{blobtree_mutex};
+
+    for (auto& primitive : primitives) destroy_primitive_node(primitive);
+    primitives = std::move(loaded_primitives);
+
+    node_pool.assign(nodes.begin(), nodes.end());
+    node_children_pool.assign(node_children.begin(), node_children.end());
+    structures.resize(structure_roots.size());
+    for (size_t i = 0; i < structures.size(); ++i) structures[i].root_index = structure_roots[i];
+
+    aabbs.resize(records.size());
+    for (size_t i = 0; i < aabbs.size(); ++i) {
+        aabbs[i].min = Eigen::Map<const Eigen::Vector3d>(aabb_values.data() + 6 * i);
+        aabbs[i].max = Eigen::Map<const Eigen::Vector3d>(aabb_values.data() + 6 * i + 3);
+    }
+
+    while (!free_structure_list.empty()) free_structure_list.pop();
+    for (const auto& index : free_structures) free_structure_list.push(index);
+    while (!free_node_list.empty()) free_node_list.pop();
+    for (const auto& index : free_nodes) free_node_list.push(index);
+    instance_bases.assign(base_handles.begin(), base_handles.end());
+
+    return true;
+}
@@ -0,0 +1,240 @@
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include <internal_api.hpp>
+#include <globals.hpp>
+#include <utils/test_check.hpp>
+
+// checks the node operations on the shared node pool, i.e. linking, cloning and reusing nodes across structures
+// usage: blobtree_structure.node.operation_test
+
+// every child of an inner node must point back to it, and leaves are counted on the way
+static size_t check_subtree_links(uint32_t main_index, uint32_t node_index)
+{
+    const auto& node = blobtree_get_node({main_index, node_index});
+    if (node.is_primitive()) return 1;
+
+    std::vector<uint32_t> children{};
+    if (node.is_nary()) {
+        const auto node_children = blobtree_get_node_children(node);
+        children.assign(node_children.begin(), node_children.end());
+    } else {
+        // a binary node may have lost one of its children
+        if (!node_is_left_child_null(node)) children.emplace_back(node.left_child_index);
+        if (!node_is_right_child_null(node)) children.emplace_back(node.right_child_index);
+    }
+
+    size_t leaf_count{};
+    for (const auto& child_index : children) {
+        check(blobtree_get_node({main_index, child_index}).parent_index == node_index, "child links back to its parent");
+        leaf_count += check_subtree_links(main_index, child_index);
+    }
+    return leaf_count;
+}
+
+static virtual_node_t new_sphere(double x) { return blobtree_new_virtual_node(sphere_descriptor_t{{x, 0., 0.}, 1.}); }
+
+static void test_shared_subtree()
+{
+    clear_blobtree();
+
+    auto a = new_sphere(0.);
+    auto b = new_sphere(1.);
+    auto c = new_sphere(2.);
+
+    // b is linked into a without a copy
+    virtual_node_boolean_union(a, b);
+    const auto a_root = a.inner_index;
+    check(blobtree_get_node(b).parent_index == a_root, "b is linked into a");
+
+    // b already has a parent, so it is copied for c and stays where it is in a
+    virtual_node_boolean_intersect(c, b);
+    check(blobtree_get_node(c).right_child_index != b.inner_index, "b is cloned as the right operand");
+    check(blobtree_get_node(b).parent_index == a_root, "b keeps its parent in a");
+
+    // b is now the left operand while being part of a, so it is copied as well instead of being moved out of a
+    auto b_handle = b;
+    virtual_node_boolean_difference(b_handle, c);
+    check(blobtree_get_node(b).parent_index == a_root, "b keeps its parent in a after being a left operand");
+    check(blobtree_get_node(b_handle).left_child_index != b.inner_index, "b is cloned as the left operand");
+    check(blobtree_get_node(b_handle).parent_index == invalid_node_index, "the new root of b has no parent");
+
+    // the same subtree on both sides
+    auto d = new_sphere(3.);
+    virtual_node_boolean_union(d, d);
+    check(blobtree_get_node(d).left_child_index != blobtree_get_node(d).right_child_index, "self operands are cloned");
+
+    check(check_subtree_links(a.main_index, a.inner_index) == 2, "a keeps its two leaves");
+    check(check_subtree_links(c.main_index, c.inner_index) == 2, "c has two leaves");
+    check(check_subtree_links(b_handle.main_index, b_handle.inner_index) == 3, "b has three leaves");
+    check(check_subtree_links(d.main_index, d.inner_index) == 2, "d has two leaves");
+
+    // compaction keeps every node that is still reachable from one of the structures
+    compact_blobtree();
+    check(check_subtree_links(a.main_index, a.inner_index) == 2, "a survives compaction");
+    check(check_subtree_links(b_handle.main_index, b_handle.inner_index) == 3, "b survives compaction");
+}
+
+static void test_repeated_flatten()
+{
+    clear_blobtree();
+
+    // (s0 | s1 | ... | s7) - s8 - s9 - s10, built as binary chains like a scene made of many small edits
+    auto tree = new_sphere(0.);
+    for (int i = 1; i < 8; ++i) virtual_node_boolean_union(tree, new_sphere(i));
+    for (int i = 8; i < 11; ++i) virtual_node_boolean_difference(tree, new_sphere(i));
+
+    virtual_node_flatten(tree);
+    const auto node_count     = node_pool.size();
+    const auto children_count = node_children_pool.size();
+    check(children_count == 8 + 3, "both chains become n-ary");
+    check(check_subtree_links(tree.main_index, tree.inner_index) == 11, "flattening keeps the leaves");
+
+    // every solve flattens the tree again, which must not grow the pools
+    for (int i = 0; i < 4; ++i) virtual_node_flatten(tree);
+    check(node_pool.size() == node_count, "node pool is stable over repeated flattening");
+    check(node_children_pool.size() == children_count, "children pool is stable over repeated flattening");
+    check(check_subtree_links(tree.main_index, tree.inner_index) == 11, "repeated flattening keeps the leaves");
+}
+
+static void test_edit_after_flatten()
+{
+    clear_blobtree();
+
+    // a = ((s0 | b) | s3) | s4 with b = s1 | s2, where b keeps its own handle while it is linked into a
+    auto a = new_sphere(0.);
+    auto b = new_sphere(1.);
+    virtual_node_boolean_union(b, new_sphere(2.));
+    const virtual_node_t s2 = {b.main_index, blobtree_get_node(b).right_child_index};
+    virtual_node_boolean_union(a, b);
+    virtual_node_boolean_union(a, new_sphere(3.));
+    virtual_node_boolean_union(a, new_sphere(4.));
+
+    // as the solver does before every solve
+    virtual_node_flatten(a);
+    check(blobtree_get_node(a).is_nary() && blobtree_get_node(a).children_count() == 4, "the chain of a is flattened");
+    check(blobtree_get_node(b).parent_index == a.inner_index, "b is not absorbed into a");
+    check(blobtree_get_node(s2).parent_index == b.inner_index, "the leaves of b keep their parent");
+
+    // editing b afterwards is seen by a, and b can still be detached from a
+    check(virtual_node_remove_child(b, s2), "b can be edited after flattening a");
+    check(check_subtree_links(a.main_index, a.inner_index) == 4, "a sees the edit of b");
+    check(virtual_node_remove_child(a, b), "b can be detached from a");
+    check(check_subtree_links(a.main_index, a.inner_index) == 3, "a keeps its other leaves");
+    check(check_subtree_links(b.main_index, b.inner_index) == 1, "b keeps its remaining leaf");
+}
+
+static void test_remove_nary_children()
+{
+    clear_blobtree();
+
+    auto tree = new_sphere(0.);
+    virtual_node_boolean_union(tree, new_sphere(1.));
+    virtual_node_boolean_union(tree, new_sphere(2.));
+    virtual_node_flatten(tree);
+    check(blobtree_get_node(tree).is_nary() && blobtree_get_node(tree).children_count() == 3, "the union is n-ary");
+
+    // 3 -> 2 -> 1 -> 0 children, where an n-ary node never keeps fewer than 3 of them
+    const auto leaves = blobtree_get_leaf_nodes(tree.main_index);
+    for (size_t i = 0; i < leaves.size(); ++i) {
+        check(virtual_node_remove_child(tree, {tree.main_index, leaves[i]}), "a child is removed");
+        const auto& node = blobtree_get_node(tree);
+        check(!node.is_nary() || node.children_count() > 2, "an n-ary node keeps more than two children");
+        check(check_subtree_links(tree.main_index, tree.inner_index) == leaves.size() - i - 1, "the other children are kept");
+    }
+    check(!blobtree_get_node(tree).is_nary(), "the emptied node is binary");
+    check(blobtree_get_leaf_nodes(tree.main_index).empty(), "no leaf is left");
+}
+
+static void test_reuse_after_remove()
+{
+    clear_blobtree();
+
+    // ((s0 | s1) | s2), the leaf handles of s1 and s2 are given up once they are linked
+    auto tree = new_sphere(0.);
+    auto s1   = new_sphere(1.);
+    auto s2   = new_sphere(2.);
+    virtual_node_boolean_union(tree, s1);
+    virtual_node_boolean_union(tree, s2);
+    blobtree_free_virtual_node(s1);
+    blobtree_free_virtual_node(s2);
+    const auto node_count      = node_pool.size();
+    const auto structure_count = structures.size();
+
+    // the detached leaf is only reclaimed by compaction, as it is unreachable from any structure
+    check(virtual_node_remove_child(tree, s2), "s2 is detached");
+    check(!virtual_node_remove_child(tree, s2), "s2 is detached only once");
+    check(get_primitive_count() == 3, "removing a child frees nothing");
+    compact_blobtree();
+    check(get_primitive_count() == 2, "compaction reclaims the primitive of s2");
+    check(check_subtree_links(tree.main_index, tree.inner_index) == 2, "the tree keeps s0 and s1");
+
+    // the new leaf takes the slots of s2, and can be linked where s2 was
+    auto s3 = new_sphere(3.);
+    check(s3.inner_index == s2.inner_index, "the node of s2 is reused");
+    check(node_pool.size() == node_count, "the node pool does not grow");
+    check(structures.size() == structure_count, "the structure slots are reused");
+    check(virtual_node_add_child(tree, s3), "s3 takes the place of s2");
+    check(check_subtree_links(tree.main_index, tree.inner_index) == 3, "the tree has three leaves again");
+
+    const auto leaves = blobtree_get_leaf_nodes(tree.main_index);
+    check(std::all_of(leaves.begin(),
+                      leaves.end(),
+                      [&](uint32_t leaf_index) {
+                          return blobtree_get_node({tree.main_index, leaf_index}).primitive_index() < get_primitive_count();
+                      }),
+          "every leaf refers to a live primitive");
+}
+
+static void test_concurrent_inserts()
+{
+    clear_blobtree();
+
+    // every thread builds its own union chain, while all of them allocate from the same pools
+    static constexpr uint32_t thread_count = 8, primitives_per_thread = 500;
+
+    std::vector<virtual_node_t> trees(thread_count);
+    std::vector<std::thread>    threads{};
+    for (uint32_t i = 0; i < thread_count; ++i) {
+        threads.emplace_back([&trees, i] {
+            const auto y    = static_cast<double>(i);
+            auto       tree = blobtree_new_virtual_node(sphere_descriptor_t{{0., y, 0.}, 1.});
+            for (uint32_t j = 1; j < primitives_per_thread; ++j) {
+                auto leaf = blobtree_new_virtual_node(sphere_descriptor_t{{static_cast<double>(j), y, 0.}, 1.});
+                virtual_node_boolean_union(tree, leaf);
+                blobtree_free_virtual_node(leaf);
+            }
+            trees[i] = tree;
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    check(get_primitive_count() == thread_count * primitives_per_thread, "every insert got its own primitive");
+
+    // the trees are disjoint, and each of them only holds the spheres of its own thread
+    std::vector<bool> primitive_used(get_primitive_count(), false);
+    for (uint32_t i = 0; i < thread_count; ++i) {
+        check(check_subtree_links(trees[i].main_index, trees[i].inner_index) == primitives_per_thread,
+              "each tree has all of its leaves");
+        for (const auto& leaf_index : blobtree_get_leaf_nodes(trees[i].main_index)) {
+            const auto  primitive_index = blobtree_get_node({trees[i].main_index, leaf_index}).primitive_index();
+            const auto& desc = *static_cast<const sphere_descriptor_t*>(get_primitive_node(primitive_index).desc);
+            check(!primitive_used[primitive_index], "a primitive is used by a single leaf");
+            check(desc.center.y == static_cast<double>(i), "a tree only holds the primitives of its thread");
+            primitive_used[primitive_index] = true;
+        }
+    }
+}
+
+int main()
+{
+    test_shared_subtree();
+    test_repeated_flatten();
+    test_edit_after_flatten();
+    test_remove_nary_children();
+    test_reuse_after_remove();
+    test_concurrent_inserts();
+
+    return test_exit_code("node operation");
+}
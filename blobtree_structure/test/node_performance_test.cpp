@@ -0,0 +1,200 @@
+#include <bitset>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <timer/scoped_timer.hpp>
+
+#include <internal_structs.hpp>
+
+// compares tree traversals over the packed node record against the former std::bitset<128> based layout
+// usage: blobtree_structure.node.performance_test
+
+namespace legacy
+{
+using node_t = std::bitset<128>;
+
+template <typename _Tp>
+struct node_proxy {
+    node_proxy(node_t& _data, uint32_t _offset, uint32_t _mask_bits)
+        : data(_data), offset(_offset), mask((1ull << _mask_bits) - 1ull)
+    {
+    }
+
+    node_proxy& operator=(uint64_t other)
+    {
+        const auto _mask = mask << offset;
+        data             = (data & ~_mask) | ((node_t{other} << offset) & _mask);
+        return *this;
+    }
+
+    node_proxy& operator+=(uint64_t other)
+    {
+        const auto _mask    = mask << offset;
+        const auto low_data = ((data & _mask) >> offset).to_ullong();
+        data                = (data & ~_mask) | ((node_t{other + low_data} << offset) & _mask);
+        return *this;
+    }
+
+    operator _Tp() const { return static_cast<_Tp>(((data >> offset) & mask).to_ulong()); }
+
+    node_t&  data;
+    uint32_t offset{};
+    node_t   mask{};
+};
+
+static inline auto fetch_is_primitive(node_t& node) { return node_proxy<bool>(node, 127u, 1); }
+
+static inline auto fetch_operation(node_t& node) { return node_proxy<eNodeOperation>(node, 125u, 2); }
+
+static inline auto fetch_primitive_index(node_t& node) { return node_proxy<uint32_t>(node, 96u, 24); }
+
+static inline auto fetch_parent_index(node_t& node) { return node_proxy<uint32_t>(node, 64u, 32); }
+
+static inline auto fetch_left_child_index(node_t& node) { return node_proxy<uint32_t>(node, 32u, 32); }
+
+static inline auto fetch_right_child_index(node_t& node) { return node_proxy<uint32_t>(node, 0u, 32); }
+} // namespace legacy
+
+// =========================================================================================================================
+
+static constexpr uint32_t leaf_count  = 50'000; // i.e. 10^5 nodes in total
+static constexpr uint32_t round_count = 20;
+
+// balanced union/intersection tree over leaf_count leaves, leaves first, root last
+template <typename Node, typename Setter>
+static std::vector<Node> build_tree(const Node& new_node, Setter&& setter)
+{
+    std::vector<Node> nodes(leaf_count, new_node);
+    for (uint32_t i = 0; i < leaf_count; ++i) setter(nodes[i], true, i, 0, 0, i);
+
+    std::vector<uint32_t> level(leaf_count), next_level{};
+    for (uint32_t i = 0; i < leaf_count; ++i) level[i] = i;
+    while (level.size() > 1) {
+        next_level.clear();
+        for (size_t i = 0; i + 1 < level.size(); i += 2) {
+            const auto index = static_cast<uint32_t>(nodes.size());
+            nodes.emplace_back(new_node);
+            setter(nodes.back(), false, 0, level[i], level[i + 1], index % 2);
+            setter.set_parent(nodes[level[i]], index);
+            setter.set_parent(nodes[level[i + 1]], index);
+            next_level.emplace_back(index);
+        }
+        if (level.size() % 2 == 1) next_level.emplace_back(level.back());
+        std::swap(level, next_level);
+    }
+    return nodes;
+}
+
+struct packed_setter {
+    void operator()(node_t& node, bool is_primitive, uint32_t primitive, uint32_t left, uint32_t right, uint32_t op) const
+    {
+        node_fetch_is_primitive(node) = is_primitive;
+        if (is_primitive) {
+            node_fetch_primitive_index(node) = primitive;
+        } else {
+            node_fetch_operation(node)         = static_cast<eNodeOperation>(op);
+            node_fetch_left_child_index(node)  = left;
+            node_fetch_right_child_index(node) = right;
+        }
+    }
+
+    void set_parent(node_t& node, uint32_t parent) const { node_fetch_parent_index(node) = parent; }
+};
+
+struct legacy_setter {
+    void operator()(legacy::node_t& node, bool is_primitive, uint32_t primitive, uint32_t left, uint32_t right, uint32_t op)
+        const
+    {
+        legacy::fetch_is_primitive(node) = is_primitive;
+        if (is_primitive) {
+            legacy::fetch_primitive_index(node) = primitive;
+        } else {
+            legacy::fetch_operation(node)         = op;
+            legacy::fetch_left_child_index(node)  = left;
+            legacy::fetch_right_child_index(node) = right;
+        }
+    }
+
+    void set_parent(legacy::node_t& node, uint32_t parent) const { legacy::fetch_parent_index(node) = parent; }
+};
+
+// walk from every leaf up to the root, like PatchPropagator::filter_cells_by_boolean does
+static uint64_t upward_walk(std::vector<node_t>& nodes)
+{
+    uint64_t checksum{};
+    for (uint32_t i = 0; i < leaf_count; ++i) {
+        for (auto index = i; !node_is_parent_null(nodes[index]); index = node_fetch_parent_index(nodes[index]))
+            checksum += static_cast<uint32_t>(static_cast<eNodeOperation>(node_fetch_operation(nodes[index])));
+    }
+    return checksum;
+}
+
+static uint64_t upward_walk(std::vector<legacy::node_t>& nodes)
+{
+    uint64_t checksum{};
+    for (uint32_t i = 0; i < leaf_count; ++i) {
+        for (auto index = i; legacy::fetch_parent_index(nodes[index]) != 0xFFFFFFFFu;
+             index      = legacy::fetch_parent_index(nodes[index]))
+            checksum += static_cast<uint32_t>(static_cast<eNodeOperation>(legacy::fetch_operation(nodes[index])));
+    }
+    return checksum;
+}
+
+// shift every index by a constant offset, like the subtree copy in blobtree.cpp does
+static void reindex(std::vector<node_t>& nodes, uint32_t offset)
+{
+    for (auto& node : nodes) {
+        if (!node_is_parent_null(node)) node_fetch_parent_index(node) += offset;
+        if (!node_is_left_child_null(node)) node_fetch_left_child_index(node) += offset;
+        if (!node_is_right_child_null(node)) node_fetch_right_child_index(node) += offset;
+    }
+}
+
+static void reindex(std::vector<legacy::node_t>& nodes, uint32_t offset)
+{
+    for (auto& node : nodes) {
+        if (legacy::fetch_parent_index(node) != 0xFFFFFFFFu) legacy::fetch_parent_index(node) += offset;
+        if (legacy::fetch_left_child_index(node) != 0xFFFFFFFFu) legacy::fetch_left_child_index(node) += offset;
+        if (legacy::fetch_right_child_index(node) != 0xFFFFFFFFu) legacy::fetch_right_child_index(node) += offset;
+    }
+}
+
+int main()
+{
+    labelled_timers_manager timer{};
+
+    auto packed_nodes = build_tree(standard_new_node, packed_setter{});
+    auto legacy_nodes = build_tree(legacy::node_t{}.flip(), legacy_setter{});
+    std::cout << "node count: " << packed_nodes.size() << std::endl;
+
+    uint64_t packed_checksum{}, legacy_checksum{};
+    for (uint32_t round = 0; round < round_count; ++round) {
+        timer.push_timer("leaf-to-root walks (bitset<128>)");
+        legacy_checksum += upward_walk(legacy_nodes);
+        timer.pop_timer("leaf-to-root walks (bitset<128>)");
+
+        timer.push_timer("leaf-to-root walks (packed)");
+        packed_checksum += upward_walk(packed_nodes);
+        timer.pop_timer("leaf-to-root walks (packed)");
+
+        // shift forth and back, so that the next round still walks a valid tree
+        timer.push_timer("reindex x2 (bitset<128>)");
+        reindex(legacy_nodes, leaf_count);
+        reindex(legacy_nodes, 0u - leaf_count);
+        timer.pop_timer("reindex x2 (bitset<128>)");
+
+        timer.push_timer("reindex x2 (packed)");
+        reindex(packed_nodes, leaf_count);
+        reindex(packed_nodes, 0u - leaf_count);
+        timer.pop_timer("reindex x2 (packed)");
+    }
+
+    if (packed_checksum != legacy_checksum) {
+        std::cerr << "Error: traversal results differ between node layouts" << std::endl;
+        return 1;
+    }
+    timer.print();
+
+    return 0;
+}
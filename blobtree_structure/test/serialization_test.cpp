@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <internal_api.hpp>
+#include <utils/test_check.hpp>
+
+// checks that damaged scene files, including trees with cycles or shared nodes, are refused by blobtree_load, and that
+// the current blobtree survives them
+// usage: blobtree_structure.serialization.load_test
+
+static std::vector<char> read_file(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+static void write_file(const std::string& path, const std::vector<char>& bytes)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+// the arrays of a descriptor are stored verbatim in the payload, so they can be found by their contents
+template <typename T, size_t N>
+static size_t find_array(const std::vector<char>& bytes, const T (&array)[N])
+{
+    const auto begin = reinterpret_cast<const char*>(array);
+    const auto iter  = std::search(bytes.begin(), bytes.end(), begin, begin + sizeof(array));
+    return static_cast<size_t>(iter - bytes.begin());
+}
+
+template <typename T>
+static void patch(std::vector<char>& bytes, size_t offset, const T& value)
+{
+    std::memcpy(bytes.data() + offset, &value, sizeof(T));
+}
+
+// a cube with quads, whose index and face arrays are unique byte patterns in the file
+static raw_vector3d_t            cube_points[8]   = {{-1., -1., -1.},
+                                                     {1., -1., -1.},
+                                                     {1., 1., -1.},
+                                                     {-1., 1., -1.},
+                                                     {-1., -1., 1.},
+                                                     {1., -1., 1.},
+                                                     {1., 1., 1.},
+                                                     {-1., 1., 1.}};
+static uint32_t                  cube_indices[24] = {0, 3, 2, 1, 4, 5, 6, 7, 0, 1, 5, 4, 1, 2, 6, 5, 2, 3, 7, 6, 3, 0, 4, 7};
+static polygon_face_descriptor_t cube_faces[6]    = {{0, 4}, {4, 4}, {8, 4}, {12, 4}, {16, 4}, {20, 4}};
+
+// the blobtree held while loading the damaged files, which must stay as it is
+static void check_blobtree_kept(const char* message)
+{
+    const auto& desc = *static_cast<const mesh_descriptor_t*>(get_primitive_node(1).desc);
+    check(get_primitive_count() == 2 && desc.face_number == 6 && desc.indices[23] == 7, message);
+}
+
+int main()
+{
+    const auto path = (std::filesystem::temp_directory_path() / "blobtree_serialization_test.bin").string();
+
+    clear_blobtree();
+    auto tree = blobtree_new_virtual_node(sphere_descriptor_t{{0., 0., 0.}, 1.});
+    virtual_node_boolean_union(tree, blobtree_new_virtual_node(mesh_descriptor_t{8, 6, cube_points, cube_indices, cube_faces}));
+    check(blobtree_save(path.c_str()), "the scene is saved");
+    const auto original = read_file(path);
+
+    check(blobtree_load(path.c_str()), "an intact file is loaded");
+    check_blobtree_kept("an intact file restores the scene");
+
+    const auto index_offset = find_array(original, cube_indices);
+    const auto face_offset  = find_array(original, cube_faces);
+    check(index_offset < original.size() && face_offset < original.size(), "the mesh arrays are found in the file");
+
+    // every section is checked against the file size
+    for (const auto size : {original.size() / 2, original.size() - 1, size_t{16}}) {
+        write_file(path, std::vector<char>(original.begin(), original.begin() + static_cast<std::ptrdiff_t>(size)));
+        check(!blobtree_load(path.c_str()), "a truncated file is refused");
+        check_blobtree_kept("a truncated file keeps the blobtree");
+    }
+
+    // an index beyond the points
+    auto damaged = original;
+    patch(damaged, index_offset + 5 * sizeof(uint32_t), uint32_t{8});
+    write_file(path, damaged);
+    check(!blobtree_load(path.c_str()), "an index out of the points is refused");
+    check_blobtree_kept("an index out of the points keeps the blobtree");
+
+    // a face reaching beyond the indices, while the total index count is unchanged
+    damaged = original;
+    patch(damaged, face_offset + 5 * sizeof(polygon_face_descriptor_t), polygon_face_descriptor_t{22, 4});
+    write_file(path, damaged);
+    check(!blobtree_load(path.c_str()), "a face out of the indices is refused");
+    check_blobtree_kept("a face out of the indices keeps the blobtree");
+
+    // vertex counts whose 32-bit sum wraps around to the stored index count
+    damaged = original;
+    patch(damaged, face_offset, polygon_face_descriptor_t{0, 4u + (1u << 31)});
+    patch(damaged, face_offset + sizeof(polygon_face_descriptor_t), polygon_face_descriptor_t{4, 4u + (1u << 31)});
+    write_file(path, damaged);
+    check(!blobtree_load(path.c_str()), "wrapping vertex counts are refused");
+    check_blobtree_kept("wrapping vertex counts keep the blobtree");
+
+    // the root reached again through its own child, and a node reached from both sides of the root
+    const auto root        = blobtree_get_node(tree);
+    const auto root_bytes  = reinterpret_cast<const char*>(&root);
+    const auto root_iter   = std::search(original.begin(), original.end(), root_bytes, root_bytes + sizeof(node_t));
+    const auto root_offset = static_cast<size_t>(root_iter - original.begin());
+    check(root_offset < original.size() && !root.is_primitive() && !root.is_nary(), "the binary root is found in the file");
+
+    auto cyclic             = root;
+    cyclic.left_child_index = tree.inner_index;
+    damaged                 = original;
+    patch(damaged, root_offset, cyclic);
+    write_file(path, damaged);
+    check(!blobtree_load(path.c_str()), "a cycle through the root is refused");
+    check_blobtree_kept("a cycle through the root keeps the blobtree");
+
+    auto shared              = root;
+    shared.right_child_index = root.left_child_index;
+    damaged                  = original;
+    patch(damaged, root_offset, shared);
+    write_file(path, damaged);
+    check(!blobtree_load(path.c_str()), "a node with two parents is refused");
+    check_blobtree_kept("a node with two parents keeps the blobtree");
+
+    std::filesystem::remove(path);
+
+    return test_exit_code("serialization");
+}
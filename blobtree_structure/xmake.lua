@@ -3,4 +3,27 @@ add_requires("eigen-latest")
 internal_library("blobtree_structure", "BS", os.scriptdir())
     add_rules("config.indirect_predicates.flags")
     add_deps("shared_module")
-    add_packages("eigen-latest", {public = true})
\ No newline at end of file
+    add_packages("eigen-latest", {public = true})
+
+target("blobtree_structure.node.performance_test")
+    set_kind("binary")
+    add_rules("config.indirect_predicates.flags")
+    add_deps("blobtree_structure")
+    add_files("./test/node_performance_test.cpp")
+target_end()
+
+target("blobtree_structure.node.operation_test")
+    set_kind("binary")
+    add_rules("config.indirect_predicates.flags")
+    add_deps("blobtree_structure")
+    -- the test also watches the sizes of the internal node pools
+    add_includedirs("./include")
+    add_files("./test/node_operation_test.cpp")
+target_end()
+
+target("blobtree_structure.serialization.load_test")
+    set_kind("binary")
+    add_rules("config.indirect_predicates.flags")
+    add_deps("blobtree_structure")
+    add_files("./test/serialization_test.cpp")
+target_end()
\ No newline at end of file
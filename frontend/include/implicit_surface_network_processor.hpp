@@ -17,11 +17,16 @@ struct ImplicitSurfaceNetworkProcessor {
     PatchPropagator       patch_propagator{};
 
     /* intermediate */
-    stl_vector_mp<uint32_t> leaf_index_of_primitive{};
+    // only the primitives reachable from the solved tree take part in a solve, they are called functions here
+    stl_vector_mp<uint32_t> primitive_of_function{};
+    stl_vector_mp<uint32_t> leaf_indices{};
+    stl_vector_mp<uint32_t> function_of_leaf{}; ///< Leaves sharing a primitive share its function.
 
     /* output fields */
     // topology results
     stl_vector_mp<raw_point_t> iso_vertices{}; ///< Vertices at the surface network mesh
     stl_vector_mp<uint32_t>    polygon_faces{};
     stl_vector_mp<uint32_t>    vertex_counts_of_face{};
+    // statistics of the last run
+    solver_statistics_t        statistics{};
 };
\ No newline at end of file
@@ -11,7 +11,9 @@ class PatchPropagator
 {
 public:
     solve_result_t execute(const virtual_node_t&                         tree_root,
-                           const stl_vector_mp<uint32_t>&                leaf_index_of_primitive,
+                           const stl_vector_mp<uint32_t>&                primitive_of_function,
+                           const stl_vector_mp<uint32_t>&                leaf_indices,
+                           const stl_vector_mp<uint32_t>&                function_of_leaf,
                            const stl_vector_mp<raw_point_t>&             vertices,
                            const stl_vector_mp<polygon_face_t>&          faces,
                            const stl_vector_mp<stl_vector_mp<uint32_t>>& patches,
@@ -31,9 +33,11 @@ private:
                           const stl_vector_mp<uint32_t>&                shell_of_half_patch,
                           const stl_vector_mp<stl_vector_mp<uint32_t>>& shells,
                           const stl_vector_mp<uint32_t>&                shell_to_cell,
+                          const stl_vector_mp<uint32_t>&                primitive_of_function,
                           stl_vector_mp<dynamic_bitset_mp<>>&           function_cell_labels);
 
     dynamic_bitset_mp<> filter_cells_by_boolean(const virtual_node_t&                     tree_root,
-                                                const stl_vector_mp<uint32_t>&            leaf_index_of_primitive,
+                                                const stl_vector_mp<uint32_t>&            leaf_indices,
+                                                const stl_vector_mp<uint32_t>&            function_of_leaf,
                                                 const stl_vector_mp<dynamic_bitset_mp<>>& function_cell_labels);
 };
\ No newline at end of file
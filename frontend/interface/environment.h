@@ -8,8 +8,10 @@
 typedef struct sSetting {
     uint32_t resolution;        // will split the background mesh into (resolution + 1)^3 grids
     double   scene_aabb_margin; // margin to add to the scene AABB to avoid artifacts
+    uint32_t iso_vertex_projection_steps; // Newton steps snapping iso-vertices on tet edges to the surface, 0 to disable
 } setting_descriptor;
 
 EXTERN_C API void update_setting(const setting_descriptor desc);
 // apply updated settings to the environment
+// the tree is flattened in place (see virtual_node_flatten)
 EXTERN_C API void update_environment(const virtual_node_t* tree_node);
\ No newline at end of file
@@ -20,10 +20,28 @@ typedef struct {
     bool       success;
 } solve_result_t;
 
-EXTERN_C API solve_result_t execute_solver(const virtual_node_t* tree_node);
+// statistics of the implicit arrangements of the last solve
+typedef struct {
+    uint32_t tets_by_active_function_count[8]; // tets with i active functions at index i, with 7 or more at index 7
+    uint32_t degenerate_vertex_count;          // background vertices on the zero set of some function
+    uint64_t lut_hits;                         // arrangements taken from the lookup table
+    uint64_t lut_misses;                       // arrangements of planes that the lookup table lacks
+    uint64_t cache_hits;                       // untabulated arrangements of 3 or more planes shared from the cache
+    uint64_t cache_misses;                     // untabulated arrangements of 3 or more planes computed plane by plane
+    uint32_t coplanar_tet_count;               // tets where some planes are coplanar
+    uint32_t coplanar_plane_count;             // planes merged into a coplanar one in those tets
+    uint64_t arrangement_vertex_count;         // vertices of the arrangements, summed over all tets
+    uint64_t arrangement_face_count;           // faces of the arrangements, summed over all tets
+    uint64_t arrangement_cell_count;           // cells of the arrangements, summed over all tets
+    uint32_t max_arrangement_face_count;       // faces of the largest arrangement
+} solver_statistics_t;
+
+EXTERN_C API solve_result_t      execute_solver(const virtual_node_t* tree_node);
 // clear the cache of previous solver results
 // CAUTION: output result should be invalid after calling this function
-EXTERN_C API void           clear_solver_cache();
+EXTERN_C API void                clear_solver_cache();
 // output time usage statistics to console
-EXTERN_C API void           print_statistics();
-EXTERN_C API void           clear_statistics();
\ No newline at end of file
+EXTERN_C API void                print_statistics();
+EXTERN_C API void                clear_statistics();
+// statistics of the implicit arrangements of the last solve, to tune the resolution from
+EXTERN_C API solver_statistics_t get_solver_statistics();
\ No newline at end of file
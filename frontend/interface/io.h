@@ -22,6 +22,26 @@ EXTERN_C_BEGIN
  */
 API void free_blobtree();
 
+/**
+ * @brief Reclaim the nodes and primitives which are no longer reachable from the root of any live blobtree, and
+ * renumber the remaining primitives
+ */
+API void shrink_blobtree();
+
+/**
+ * @brief Save the entire blobtree to a binary file, which can be loaded much faster than rebuilding the scene
+ * @param[in] path		The path of the file
+ * @return True if the operation is successful
+ */
+API bool save_blobtree(const char* path);
+
+/**
+ * @brief Replace the entire blobtree by the one saved in a binary file, virtual nodes taken before saving stay valid
+ * @param[in] path		The path of the file
+ * @return True if the operation is successful, otherwise the current blobtree is kept
+ */
+API bool load_blobtree(const char* path);
+
 // Tree Node Operations
 
 /**
@@ -33,6 +53,37 @@ API void free_blobtree();
 API virtual_node_t blobtree_new_node_by_copy(const copyable_descriptor_t desc, primitive_type type);
 API virtual_node_t blobtree_new_node_by_move(const movable_descriptor_t desc, primitive_type type);
 
+/**
+ * @brief Create a whole scene in one call, which is much faster than creating the nodes one by one for large scenes
+ * @param[in] descs			The primitives (type and descriptor), the descriptors are copied
+ * @param[in] desc_count	The number of primitives
+ * @param[in] program		Postfix program of the boolean operations, every primitive must be referenced exactly once
+ * @param[in] program_size	The number of entries in the program
+ * @return The virtual node pointing to the root of the scene, or {0xFFFFFFFF, 0xFFFFFFFF} if the program is malformed
+ */
+API virtual_node_t blobtree_new_scene(const primitive_node_t* descs,
+                                      uint32_t                desc_count,
+                                      const scene_op_t*       program,
+                                      uint32_t                program_size);
+
+/**
+ * @brief Create a base primitive shared by many instances, which is not part of any blobtree itself; instances are
+ * created like any other primitive from an instance_descriptor_t referring to the returned handle, and only store a
+ * rigid transform instead of a copy of the descriptor
+ * @param[in] desc		The descriptor of the base, must be consistent with the type, it is copied once
+ * @param[in] type		The type of the base, constants, planes and instances cannot be shared
+ * @return The handle of the base, which stays valid across compact_blobtree until it is released, or 0xFFFFFFFF if the
+ * type cannot be shared
+ */
+API uint32_t blobtree_new_instance_base(const copyable_descriptor_t desc, primitive_type type);
+
+/**
+ * @brief Release a base created by blobtree_new_instance_base, no new instance can refer to it afterwards; existing
+ * instances are kept, and the base is reclaimed by compact_blobtree once none of them is alive anymore
+ * @param[in] base_index		The handle of the base
+ */
+API void release_instance_base(uint32_t base_index);
+
 /**
  * @brief Union two virtual node, result will be writen to first node
  * @param[in] node1		The first virtual node
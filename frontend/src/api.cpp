@@ -25,4 +25,6 @@ EXTERN_C API void clear_solver_cache() { g_processor.clear(); }
 
 EXTERN_C API void clear_statistics() { g_timers_manager.clear(); }
 
-EXTERN_C API void print_statistics() { g_timers_manager.print(); }
\ No newline at end of file
+EXTERN_C API void print_statistics() { g_timers_manager.print(); }
+
+EXTERN_C API solver_statistics_t get_solver_statistics() { return g_processor.statistics; }
\ No newline at end of file
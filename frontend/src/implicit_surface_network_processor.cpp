@@ -1,3 +1,6 @@
+#include <numeric>
+#include <tuple>
+
 #include <algorithm/glue_algorithm.hpp>
 
 #include <extract_patch.hpp>
@@ -17,22 +20,43 @@ ImplicitSurfaceNetworkProcessor g_processor{};
 
 void ImplicitSurfaceNetworkProcessor::preinit(const virtual_node_t& tree_node) noexcept
 {
-    auto           leaf_indices = blobtree_get_leaf_nodes(tree_node.main_index);
-    virtual_node_t pointer      = tree_node;
+    // collapse long union/intersection chains (e.g. many holes subtracted from one block) before labelling cells
+    // HINT: this flattens the caller's tree in place, but keeps the roots of its sub-structures so that they can still be
+    // edited after the solve
+    virtual_node_flatten(tree_node);
+
+    virtual_node_t pointer = tree_node;
+    leaf_indices           = blobtree_get_leaf_nodes(tree_node.main_index);
 
     // 1. merge aabbs
-    // 2. build mapping: primitive index -> leaf node index
-    aabb_t scene_aabb{};
-    leaf_index_of_primitive.resize(get_primitive_count());
+    // 2. build mapping: function index -> primitive index, leaf node -> function index
+    // leaves sharing a primitive (e.g. the copies of an operand used twice) share its function, since coincident functions
+    // are degenerate for the arrangements
+    aabb_t                  scene_aabb{};
+    stl_vector_mp<uint32_t> function_of_primitive(get_primitive_count(), invalid_primitive_index);
+    primitive_of_function.clear();
+    function_of_leaf.clear();
     for (const auto& leaf_index : leaf_indices) {
-        pointer.inner_index                      = leaf_index;
-        const uint32_t primitive_index           = node_fetch_primitive_index(blobtree_get_node(pointer));
-        leaf_index_of_primitive[primitive_index] = leaf_index;
+        pointer.inner_index            = leaf_index;
+        const uint32_t primitive_index = node_fetch_primitive_index(blobtree_get_node(pointer));
+        auto&          function_index  = function_of_primitive[primitive_index];
+        if (function_index == invalid_primitive_index) {
+            function_index = static_cast<uint32_t>(primitive_of_function.size());
+            primitive_of_function.emplace_back(primitive_index);
 
-        const auto& type = get_primitive_node(primitive_index).type;
-        if (type != PRIMITIVE_TYPE_CONSTANT && type != PRIMITIVE_TYPE_PLANE) scene_aabb.extend(get_aabb(primitive_index));
+            const auto& type = get_primitive_node(primitive_index).type;
+            if (type != PRIMITIVE_TYPE_CONSTANT && type != PRIMITIVE_TYPE_PLANE) scene_aabb.extend(get_aabb(primitive_index));
+        }
+        function_of_leaf.emplace_back(function_index);
     }
 
+    // the bounds through the boolean operations are much smaller for intersections, differences and split bodies; where
+    // they are unbounded (e.g. in the direction of a lone half-space) the union of the leaf boxes above is kept
+    const auto            tree_aabb   = blobtree_get_bounds(tree_node);
+    const Eigen::Vector3d clamped_min = tree_aabb.min.cwiseMax(scene_aabb.min);
+    const Eigen::Vector3d clamped_max = tree_aabb.max.cwiseMin(scene_aabb.max);
+    if ((clamped_min.array() <= clamped_max.array()).all()) scene_aabb = {clamped_min, clamped_max};
+
     // update background mesh using scene aabb
     // EDIT: scene aabb with a little margin
     this->background_mesh_manager.generate(scene_aabb.min - g_settings.scene_aabb_margin * Eigen::Vector3d::Ones(),
@@ -57,7 +81,8 @@ solve_result_t ImplicitSurfaceNetworkProcessor::run(const virtual_node_t& tree_n
 
     const auto num_vert  = background_vertices.size();
     const auto num_tets  = background_indices.size();
-    const auto num_funcs = get_primitive_count();
+    const auto num_funcs = primitive_of_function.size();
+    statistics           = {};
 
     // temporary geometry results
     stl_vector_mp<polygon_face_t>          iso_faces{}; ///< Polygonal faces at the surface network mesh
@@ -86,7 +111,7 @@ solve_result_t ImplicitSurfaceNetworkProcessor::run(const virtual_node_t& tree_n
         for (uint32_t i = 0; i < num_vert; ++i) {
             const auto& point = background_vertices[i];
             for (uint32_t j = 0; j < num_funcs; ++j) {
-                vertex_scalar_values[i][j] = evaluate(j, point);
+                vertex_scalar_values[i][j] = evaluate(primitive_of_function[j], point);
                 const auto sign            = scalar_field_sign(vertex_scalar_values[i][j]);
                 switch (sign) {
                     case -1: is_negative_scalar_field_sign[i * num_funcs + j] = true; break;
@@ -100,6 +125,9 @@ solve_result_t ImplicitSurfaceNetworkProcessor::run(const virtual_node_t& tree_n
             }
         }
         g_timers_manager.pop_timer("identify sdf signs");
+        if (has_degenerate_vertex)
+            statistics.degenerate_vertex_count =
+                static_cast<uint32_t>(std::count(is_degenerate_vertex.begin(), is_degenerate_vertex.end(), true));
     }
 
     // filter active functions in each tetrahedron
@@ -131,54 +159,97 @@ solve_result_t ImplicitSurfaceNetworkProcessor::run(const virtual_node_t& tree_n
 
     // compute arrangement in each tet
     // HINT: we skip robust test for this part for now
-    stl_vector_mp<std::shared_ptr<arrangement_t>> cut_results{};
-    uint32_t                                      num_1_func    = 0;
-    uint32_t                                      num_2_func    = 0;
-    uint32_t                                      num_more_func = 0;
+    // the tets are grouped by their number of active functions, and each group is computed in batches
+    stl_vector_mp<std::shared_ptr<const compact_arrangement_t>> cut_results(num_tets);
+    uint32_t                                                    num_1_func    = 0;
+    uint32_t                                                    num_2_func    = 0;
+    uint32_t                                                    num_more_func = 0;
     {
         // g_timers_manager.push_timer("implicit arrangements calculation in total");
-        cut_results.reserve(num_intersecting_tet);
-        stl_vector_mp<plane_t> planes{};
-        planes.reserve(3);
+        static constexpr uint32_t arrangement_batch_size = 1024;
 
+        // counting sort of the tets by their number of active functions, in CRS vector format
+        stl_vector_mp<uint32_t> tets_by_func_count(num_tets);
+        stl_vector_mp<uint32_t> start_index_of_func_count{};
         for (uint32_t i = 0; i < num_tets; ++i) {
-            const auto start_index              = start_index_of_tet[i];
-            const auto active_funcs_in_curr_tet = start_index_of_tet[i + 1] - start_index;
-            if (active_funcs_in_curr_tet == 0) {
-                cut_results.emplace_back(nullptr);
-                continue;
-            }
-            g_timers_manager.push_timer(active_funcs_in_curr_tet == 1
-                                            ? "implicit arrangements calculation (1 func)"
-                                            : (active_funcs_in_curr_tet == 2
-                                                   ? "implicit arrangments calculation (2 funcs)"
-                                                   : "implicit arrangements calculation (>= 3 funcs)"));
-            const auto& tet = background_indices[i];
-            planes.clear();
-            for (uint32_t j = 0; j < active_funcs_in_curr_tet; ++j) {
-                const auto fid = active_functions_in_tet[start_index + j];
-                planes.emplace_back(plane_t{-vertex_scalar_values[tet[0]][fid],
-                                            -vertex_scalar_values[tet[1]][fid],
-                                            -vertex_scalar_values[tet[2]][fid],
-                                            -vertex_scalar_values[tet[3]][fid]});
+            const auto active_funcs_in_curr_tet = start_index_of_tet[i + 1] - start_index_of_tet[i];
+            if (active_funcs_in_curr_tet + 2 > start_index_of_func_count.size())
+                start_index_of_func_count.resize(active_funcs_in_curr_tet + 2, 0);
+            start_index_of_func_count[active_funcs_in_curr_tet + 1]++;
+        }
+        const size_t max_func_count_bin = std::size(statistics.tets_by_active_function_count) - 1;
+        for (uint32_t func_count = 0; func_count + 1 < start_index_of_func_count.size(); ++func_count)
+            statistics.tets_by_active_function_count[std::min<size_t>(func_count, max_func_count_bin)] +=
+                start_index_of_func_count[func_count + 1];
+        std::partial_sum(start_index_of_func_count.begin(), start_index_of_func_count.end(), start_index_of_func_count.begin());
+        {
+            auto next_index_of_func_count = start_index_of_func_count;
+            for (uint32_t i = 0; i < num_tets; ++i)
+                tets_by_func_count[next_index_of_func_count[start_index_of_tet[i + 1] - start_index_of_tet[i]]++] = i;
+        }
+
+        stl_vector_mp<double>                                       coefficients{};
+        stl_vector_mp<std::shared_ptr<const compact_arrangement_t>> batch_results{};
+        // the counters are global and cumulative, so only their increase is reported
+        const auto                                                  initial_counters = get_arrangement_cache_counters();
+        for (uint32_t func_count = 1; func_count + 1 < start_index_of_func_count.size(); ++func_count) {
+            const auto group_start = start_index_of_func_count[func_count];
+            const auto group_end   = start_index_of_func_count[func_count + 1];
+            if (group_start == group_end) continue;
+
+            const auto timer_label = func_count == 1 ? "implicit arrangements calculation (1 func)"
+                                                     : (func_count == 2 ? "implicit arrangments calculation (2 funcs)"
+                                                                        : "implicit arrangements calculation (>= 3 funcs)");
+            g_timers_manager.push_timer(timer_label);
+            for (auto batch_start = group_start; batch_start < group_end; batch_start += arrangement_batch_size) {
+                const auto batch_size = std::min(arrangement_batch_size, group_end - batch_start);
+                coefficients.resize(4 * func_count * batch_size);
+                for (uint32_t t = 0; t < batch_size; ++t) {
+                    const auto  tet_index   = tets_by_func_count[batch_start + t];
+                    const auto& tet         = background_indices[tet_index];
+                    const auto  start_index = start_index_of_tet[tet_index];
+                    for (uint32_t j = 0; j < func_count; ++j) {
+                        const auto fid = active_functions_in_tet[start_index + j];
+                        for (uint32_t k = 0; k < 4; ++k)
+                            coefficients[(4 * j + k) * batch_size + t] = -vertex_scalar_values[tet[k]][fid];
+                    }
+                }
+
+                batch_results.resize(batch_size);
+                compute_shared_arrangements(func_count, coefficients, batch_results);
+                for (uint32_t t = 0; t < batch_size; ++t)
+                    cut_results[tets_by_func_count[batch_start + t]] = std::move(batch_results[t]);
             }
-            cut_results.emplace_back(std::make_shared<arrangement_t>(std::move(compute_arrangement(planes))));
-            switch (active_funcs_in_curr_tet) {
-                case 1:
-                    g_timers_manager.pop_timer("implicit arrangements calculation (1 func)");
-                    ++num_1_func;
-                    break;
-                case 2:
-                    g_timers_manager.pop_timer("implicit arrangments calculation (2 funcs)");
-                    ++num_2_func;
-                    break;
-                default:
-                    g_timers_manager.pop_timer("implicit arrangements calculation (>= 3 funcs)");
-                    ++num_more_func;
-                    break;
+            g_timers_manager.pop_timer(timer_label);
+
+            switch (func_count) {
+                case 1:  num_1_func += group_end - group_start; break;
+                case 2:  num_2_func += group_end - group_start; break;
+                default: num_more_func += group_end - group_start; break;
             }
         }
         // g_timers_manager.pop_timer("implicit arrangements calculation in total");
+
+        const auto counters     = get_arrangement_cache_counters();
+        statistics.lut_hits     = counters.lut_hits - initial_counters.lut_hits;
+        statistics.lut_misses   = counters.lut_misses - initial_counters.lut_misses;
+        statistics.cache_hits   = counters.hits - initial_counters.hits;
+        statistics.cache_misses = counters.misses - initial_counters.misses;
+        for (const auto& arrangement : cut_results) {
+            if (!arrangement) continue;
+
+            const auto face_count                 = arrangement->faces().size();
+            statistics.arrangement_vertex_count   += arrangement->vertices().size();
+            statistics.arrangement_face_count     += face_count;
+            statistics.arrangement_cell_count     += arrangement->cells().size();
+            statistics.max_arrangement_face_count  = std::max(statistics.max_arrangement_face_count, face_count);
+            // the coplanar planes merged while inserting the planes, whose classes are only kept if there are any
+            if (!arrangement->unique_planes().empty()) {
+                statistics.coplanar_tet_count++;
+                statistics.coplanar_plane_count +=
+                    arrangement->unique_plane_indices().size() - arrangement->unique_planes().size();
+            }
+        }
     }
 
     // extract arrangement mesh: combining results from all tets to produce a mesh
@@ -202,6 +273,60 @@ solve_result_t ImplicitSurfaceNetworkProcessor::run(const virtual_node_t& tree_n
         g_timers_manager.pop_timer("extract arrangement & iso mesh");
     }
 
+    // snap iso-vertices on tet edges to the true iso-surface of their implicit function
+    // the vertices only move along their tet edges, between the crossings of the other functions on the same edge
+    if (g_settings.iso_vertex_projection_steps > 0) {
+        g_timers_manager.push_timer("project iso-vertices");
+        struct edge_crossing_t {
+            uint32_t edge_start_index;
+            uint32_t edge_end_index;
+            double   t;
+            uint32_t iso_vertex_index;
+        };
+
+        // the crossings are parameterized from the smaller vertex index, and sorted along their edges
+        stl_vector_mp<edge_crossing_t> crossings{};
+        for (uint32_t i = 0; i < iso_verts.size(); ++i) {
+            const auto& iso_vert = iso_verts[i];
+            if (iso_vert.header.minimal_simplex_flag != 2) continue;
+
+            const auto start_index     = std::min(iso_vert.simplex_vertex_indices[0], iso_vert.simplex_vertex_indices[1]);
+            const auto end_index       = std::max(iso_vert.simplex_vertex_indices[0], iso_vert.simplex_vertex_indices[1]);
+            const Eigen::Vector3d edge = background_vertices[end_index] - background_vertices[start_index];
+            const auto            t    = (iso_vertices[i] - background_vertices[start_index]).dot(edge) / edge.squaredNorm();
+            crossings.emplace_back(edge_crossing_t{start_index, end_index, t, i});
+        }
+        std::sort(crossings.begin(), crossings.end(), [](const edge_crossing_t& lhs, const edge_crossing_t& rhs) {
+            return std::tie(lhs.edge_start_index, lhs.edge_end_index, lhs.t)
+                   < std::tie(rhs.edge_start_index, rhs.edge_end_index, rhs.t);
+        });
+
+        const auto is_same_edge = [&](size_t lhs, size_t rhs) {
+            return crossings[lhs].edge_start_index == crossings[rhs].edge_start_index
+                   && crossings[lhs].edge_end_index == crossings[rhs].edge_end_index;
+        };
+        for (size_t k = 0; k < crossings.size(); ++k) {
+            auto& crossing = crossings[k];
+            // the previous crossing is already projected, so that the order along the edge is kept
+            const auto lower_t = k > 0 && is_same_edge(k - 1, k) ? crossings[k - 1].t : 0.0;
+            const auto upper_t = k + 1 < crossings.size() && is_same_edge(k, k + 1) ? crossings[k + 1].t : 1.0;
+
+            const auto&           edge_start      = background_vertices[crossing.edge_start_index];
+            const Eigen::Vector3d edge            = background_vertices[crossing.edge_end_index] - edge_start;
+            const auto&           iso_vert        = iso_verts[crossing.iso_vertex_index];
+            const auto            primitive_index = primitive_of_function[iso_vert.implicit_function_indices[0]];
+            auto&                 point           = iso_vertices[crossing.iso_vertex_index];
+            for (uint32_t step = 0; step < g_settings.iso_vertex_projection_steps; ++step) {
+                const auto [value, gradient] = evaluate_with_gradient(primitive_index, point);
+                const auto slope             = gradient.dot(edge);
+                if (std::abs(slope) <= std::numeric_limits<double>::epsilon() * edge.norm()) break;
+                crossing.t = std::clamp(crossing.t - value / slope, lower_t, upper_t);
+                point      = edge_start + crossing.t * edge;
+            }
+        }
+        g_timers_manager.pop_timer("project iso-vertices");
+    }
+
     //  compute iso-edges and edge-face connectivity
     stl_vector_mp<stl_vector_mp<uint32_t>> edges_of_iso_face{};
     {
@@ -368,7 +493,9 @@ solve_result_t ImplicitSurfaceNetworkProcessor::run(const virtual_node_t& tree_n
             // propagate solve result
             g_timers_manager.push_timer("arrangement cells: propagate solve result");
             result = std::move(patch_propagator.execute(tree_node,
-                                                        leaf_index_of_primitive,
+                                                        primitive_of_function,
+                                                        leaf_indices,
+                                                        function_of_leaf,
                                                         iso_vertices,
                                                         iso_faces,
                                                         patches,
@@ -6,6 +6,12 @@ EXTERN_C_BEGIN
 
 API void free_blobtree() { clear_blobtree(); }
 
+API void shrink_blobtree() { compact_blobtree(); }
+
+API bool save_blobtree(const char* path) { return blobtree_save(path); }
+
+API bool load_blobtree(const char* path) { return blobtree_load(path); }
+
 API virtual_node_t blobtree_new_node_by_copy(const copyable_descriptor_t desc, primitive_type type)
 {
     switch (type) {
@@ -17,6 +23,7 @@ API virtual_node_t blobtree_new_node_by_copy(const copyable_descriptor_t desc, p
         case PRIMITIVE_TYPE_BOX:      return blobtree_new_virtual_node(*(const box_descriptor_t*)desc.desc);
         case PRIMITIVE_TYPE_MESH:     return blobtree_new_virtual_node(*(const mesh_descriptor_t*)desc.desc);
         case PRIMITIVE_TYPE_EXTRUDE:  return blobtree_new_virtual_node(*(const extrude_descriptor_t*)desc.desc);
+        case PRIMITIVE_TYPE_INSTANCE: return blobtree_new_virtual_node(*(const instance_descriptor_t*)desc.desc);
     }
 }
 
@@ -31,9 +38,25 @@ API virtual_node_t blobtree_new_node_by_move(const movable_descriptor_t desc, pr
         case PRIMITIVE_TYPE_BOX:      return blobtree_new_virtual_node(std::move(*(const box_descriptor_t*)desc.desc));
         case PRIMITIVE_TYPE_MESH:     return blobtree_new_virtual_node(std::move(*(const mesh_descriptor_t*)desc.desc));
         case PRIMITIVE_TYPE_EXTRUDE:  return blobtree_new_virtual_node(std::move(*(const extrude_descriptor_t*)desc.desc));
+        case PRIMITIVE_TYPE_INSTANCE: return blobtree_new_virtual_node(std::move(*(const instance_descriptor_t*)desc.desc));
     }
 }
 
+API uint32_t blobtree_new_instance_base(const copyable_descriptor_t desc, primitive_type type)
+{
+    return blobtree_new_instance_base(primitive_node_t{type, desc.desc});
+}
+
+API void release_instance_base(uint32_t base_index) { blobtree_release_instance_base(base_index); }
+
+API virtual_node_t blobtree_new_scene(const primitive_node_t* descs,
+                                      uint32_t                desc_count,
+                                      const scene_op_t*       program,
+                                      uint32_t                program_size)
+{
+    return blobtree_new_scene(span<const primitive_node_t>{descs, desc_count}, span<const scene_op_t>{program, program_size});
+}
+
 API void virtual_node_boolean_union(virtual_node_t* node1, const virtual_node_t* node2)
 {
     virtual_node_boolean_union(*node1, *node2);
@@ -102,6 +125,7 @@ API bool virtual_node_replace_primitive_by_copy(const virtual_node_t*       node
         case PRIMITIVE_TYPE_BOX:      return virtual_node_replace_primitive(*node, *(const box_descriptor_t*)desc.desc);
         case PRIMITIVE_TYPE_MESH:     return virtual_node_replace_primitive(*node, *(const mesh_descriptor_t*)desc.desc);
         case PRIMITIVE_TYPE_EXTRUDE:  return virtual_node_replace_primitive(*node, *(const extrude_descriptor_t*)desc.desc);
+        case PRIMITIVE_TYPE_INSTANCE: return virtual_node_replace_primitive(*node, *(const instance_descriptor_t*)desc.desc);
     }
 }
 
@@ -123,6 +147,8 @@ API bool virtual_node_replace_primitive_by_move(const virtual_node_t*      node,
         case PRIMITIVE_TYPE_MESH: return virtual_node_replace_primitive(*node, std::move(*(const mesh_descriptor_t*)desc.desc));
         case PRIMITIVE_TYPE_EXTRUDE:
             return virtual_node_replace_primitive(*node, std::move(*(const extrude_descriptor_t*)desc.desc));
+        case PRIMITIVE_TYPE_INSTANCE:
+            return virtual_node_replace_primitive(*node, std::move(*(const instance_descriptor_t*)desc.desc));
     }
 }
 
@@ -1,3 +1,5 @@
+#include <stack>
+
 #include <container/hashmap.hpp>
 
 #include <internal_api.hpp>
@@ -5,7 +7,9 @@
 #include "patch_propagator.hpp"
 
 solve_result_t PatchPropagator::execute(const virtual_node_t&                         tree_root,
-                                        const stl_vector_mp<uint32_t>&                leaf_index_of_primitive,
+                                        const stl_vector_mp<uint32_t>&                primitive_of_function,
+                                        const stl_vector_mp<uint32_t>&                leaf_indices,
+                                        const stl_vector_mp<uint32_t>&                function_of_leaf,
                                         const stl_vector_mp<raw_point_t>&             vertices,
                                         const stl_vector_mp<polygon_face_t>&          faces,
                                         const stl_vector_mp<stl_vector_mp<uint32_t>>& patches,
@@ -23,7 +27,7 @@ solve_result_t PatchPropagator::execute(const virtual_node_t&
     result.mesh.vertices     = reinterpret_cast<const raw_vector3d_t*>(vertices.data());
     result.mesh.num_vertices = static_cast<uint32_t>(vertices.size());
 
-    const auto num_func = get_primitive_count();
+    const auto num_func = primitive_of_function.size();
 
     stl_vector_mp<uint32_t> shell_to_cell(shells.size());
     for (uint32_t i = 0; i < arrangement_cells.size(); i++) {
@@ -38,9 +42,10 @@ solve_result_t PatchPropagator::execute(const virtual_node_t&
                      shell_of_half_patch,
                      shells,
                      shell_to_cell,
+                     primitive_of_function,
                      function_cell_labels);
 
-    auto active_cell_label = filter_cells_by_boolean(tree_root, leaf_index_of_primitive, function_cell_labels);
+    auto active_cell_label = filter_cells_by_boolean(tree_root, leaf_indices, function_of_leaf, function_cell_labels);
 
     stl_vector_mp<bool>  visited_cells(arrangement_cells.size(), false);
     std::queue<uint32_t> Q{};
@@ -118,9 +123,10 @@ void PatchPropagator::propagate_labels(const stl_vector_mp<raw_point_t>&
                                        const stl_vector_mp<uint32_t>&                shell_of_half_patch,
                                        const stl_vector_mp<stl_vector_mp<uint32_t>>& shells,
                                        const stl_vector_mp<uint32_t>&                shell_to_cell,
+                                       const stl_vector_mp<uint32_t>&                primitive_of_function,
                                        stl_vector_mp<dynamic_bitset_mp<>>&           function_cell_labels)
 {
-    const auto num_func = get_primitive_count();
+    const auto num_func = primitive_of_function.size();
 
     stl_vector_mp<bool>                                   visited_cells(arrangement_cells.size(), false);
     stl_vector_mp<bool>                                   visited_functions(num_func, false);
@@ -205,74 +211,68 @@ void PatchPropagator::propagate_labels(const stl_vector_mp<raw_point_t>&
                 const auto& representative_face   = faces[representative_patch[0]];
                 const auto& representative_vertex = vertices[representative_face.vertex_indices[0]];
 
-                function_cell_labels[i][j] = get_aabb(i).contains(representative_vertex);
+                function_cell_labels[i][j] = get_aabb(primitive_of_function[i]).contains(representative_vertex);
             }
         }
     }
 }
 
 dynamic_bitset_mp<> PatchPropagator::filter_cells_by_boolean(const virtual_node_t&                     tree_root,
-                                                             const stl_vector_mp<uint32_t>&            leaf_index_of_primitive,
+                                                             const stl_vector_mp<uint32_t>&            leaf_indices,
+                                                             const stl_vector_mp<uint32_t>&            function_of_leaf,
                                                              const stl_vector_mp<dynamic_bitset_mp<>>& function_cell_labels)
 {
-    const auto                       num_funcs             = get_primitive_count();
-    const auto                       num_cells             = function_cell_labels[0].size();
-    const auto                       max_parent_node_index = tree_root.inner_index;
-    std::vector<dynamic_bitset_mp<>> node_cell_labels(blobtree_get_node_count(tree_root.main_index),
-                                                      dynamic_bitset_mp<>(num_cells));
-    std::vector<bool>                node_visited(blobtree_get_node_count(tree_root.main_index), false);
-
-    // move function cell labels to leaf node cell labels
-    for (uint32_t func_iter = 0; func_iter < num_funcs; ++func_iter) {
-        const auto& leaf_node_index       = leaf_index_of_primitive[func_iter];
-        node_cell_labels[leaf_node_index] = std::move(function_cell_labels[func_iter]);
-        node_visited[leaf_node_index]     = true;
-    }
-
-    // assume: input complete binary tree with root
-    virtual_node_t current_node_index       = tree_root;
-    uint32_t&      current_node_inner_index = current_node_index.inner_index;
-    node_t         current_node;
-    for (uint32_t func_iter = 0; func_iter < num_funcs; ++func_iter) {
-        current_node_inner_index = leaf_index_of_primitive[func_iter];
-        current_node             = blobtree_get_node(current_node_index);
-        // find first unvisited parent node
-        while (node_visited[current_node_inner_index]) {
-            current_node_inner_index = node_fetch_parent_index(current_node);
-            current_node             = blobtree_get_node(current_node_index);
+    std::vector<dynamic_bitset_mp<>> node_cell_labels(blobtree_get_node_pool_size());
+
+    // copy function cell labels to leaf node cell labels, as several leaves may share a function
+    for (uint32_t leaf_iter = 0; leaf_iter < leaf_indices.size(); ++leaf_iter)
+        node_cell_labels[leaf_indices[leaf_iter]] = function_cell_labels[function_of_leaf[leaf_iter]];
+
+    // inner nodes in pre-order, so that walking the list backwards visits every node after all of its children
+    stl_vector_mp<uint32_t>                       inner_nodes{};
+    std::stack<uint32_t, stl_vector_mp<uint32_t>> pending_nodes{};
+    pending_nodes.push(tree_root.inner_index);
+    while (!pending_nodes.empty()) {
+        const auto  node_index = pending_nodes.top();
+        const auto& node       = blobtree_get_node({tree_root.main_index, node_index});
+        pending_nodes.pop();
+        if (node.is_primitive()) continue;
+
+        inner_nodes.emplace_back(node_index);
+        if (node.is_nary()) {
+            for (const auto& child_index : blobtree_get_node_children(node)) pending_nodes.push(child_index);
+        } else {
+            pending_nodes.push(node.left_child_index);
+            pending_nodes.push(node.right_child_index);
         }
+    }
 
-        while (!node_visited[current_node_inner_index]) {
-            const uint32_t left_child_index  = node_fetch_left_child_index(current_node);
-            const uint32_t right_child_index = node_fetch_right_child_index(current_node);
-
-            // only process when both children has been processed
-            if (!node_visited[left_child_index] || !node_visited[right_child_index]) break;
-
-            node_visited[current_node_inner_index] = true;
-            switch (node_fetch_operation(current_node)) {
-                case eNodeOperation::unionOp:
-                    node_cell_labels[current_node_inner_index] =
-                        node_cell_labels[left_child_index] | node_cell_labels[right_child_index];
-                    break;
-                case eNodeOperation::intersectionOp:
-                    node_cell_labels[current_node_inner_index] =
-                        node_cell_labels[left_child_index] & node_cell_labels[right_child_index];
-                    break;
-                case eNodeOperation::differenceOp:
-                    node_cell_labels[current_node_inner_index] =
-                        node_cell_labels[left_child_index] & node_cell_labels[right_child_index].flip();
-                    break;
-                default: throw std::runtime_error("ERROR: Node operation set to unknown."); break;
+    // the labels of the children are not needed once their parent is evaluated, so they are combined in place
+    for (auto iter = inner_nodes.rbegin(); iter != inner_nodes.rend(); ++iter) {
+        const auto& node   = blobtree_get_node({tree_root.main_index, *iter});
+        auto&       labels = node_cell_labels[*iter];
+
+        if (node.is_nary()) {
+            const auto children = blobtree_get_node_children(node);
+            labels              = std::move(node_cell_labels[children.front()]);
+            for (const auto& child_index : children.subspan(1)) {
+                if (node.operation() == eNodeOperation::unionOp) {
+                    labels |= node_cell_labels[child_index];
+                } else {
+                    labels &= node_cell_labels[child_index];
+                }
             }
+            continue;
+        }
 
-            if (current_node_inner_index == tree_root.inner_index) return node_cell_labels[current_node_inner_index];
-
-            current_node_inner_index = node_fetch_parent_index(current_node);
-            current_node             = blobtree_get_node(current_node_index);
+        labels = std::move(node_cell_labels[node.left_child_index]);
+        switch (node.operation()) {
+            case eNodeOperation::unionOp:        labels |= node_cell_labels[node.right_child_index]; break;
+            case eNodeOperation::intersectionOp: labels &= node_cell_labels[node.right_child_index]; break;
+            case eNodeOperation::differenceOp:   labels -= node_cell_labels[node.right_child_index]; break;
+            default:                             throw std::runtime_error("ERROR: Node operation set to unknown."); break;
         }
     }
 
-    throw std::runtime_error("ERROR: Filter cells cannot reach root of input blobtree.");
-    return dynamic_bitset_mp<>{};
-}
\ No newline at end of file
+    return std::move(node_cell_labels[tree_root.inner_index]);
+}
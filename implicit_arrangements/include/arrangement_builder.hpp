@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+
 #include "add_plane.hpp"
 #include "implicit_arrangement.hpp"
 #include "plane.hpp"
@@ -8,9 +10,9 @@
 #include "union_find_disjoint_set.hpp"
 #include "extract_arrangement.hpp"
 
-inline ia_complex_t init_ia_complex(uint32_t num_planes)
+// resets the complex to the tet itself, reusing the storage left by the previous tet
+inline void init_ia_complex(ia_complex_t& ia_complex, uint32_t num_planes)
 {
-    ia_complex_t ia_complex{};
     ia_complex.vertices.resize(3 + 1);
 
     ia_complex.vertices[0] = {1, 2, 3};
@@ -32,44 +34,37 @@ inline ia_complex_t init_ia_complex(uint32_t num_planes)
     ia_complex.edges[4].supporting_planes = {0, 2};
     ia_complex.edges[5].supporting_planes = {0, 1};
 
+    ia_complex.face_edges.assign({5, 3, 4, 2, 1, 5, 4, 0, 2, 1, 0, 3});
     ia_complex.faces.resize(4);
-    ia_complex.faces[0].edges            = {5, 3, 4};
-    ia_complex.faces[1].edges            = {2, 1, 5};
-    ia_complex.faces[2].edges            = {4, 0, 2};
-    ia_complex.faces[3].edges            = {1, 0, 3};
-    ia_complex.faces[0].supporting_plane = 0;
-    ia_complex.faces[1].supporting_plane = 1;
-    ia_complex.faces[2].supporting_plane = 2;
-    ia_complex.faces[3].supporting_plane = 3;
-    ia_complex.faces[0].positive_cell    = 0;
-    ia_complex.faces[0].negative_cell    = INVALID_INDEX;
-    ia_complex.faces[1].positive_cell    = 0;
-    ia_complex.faces[1].negative_cell    = INVALID_INDEX;
-    ia_complex.faces[2].positive_cell    = 0;
-    ia_complex.faces[2].negative_cell    = INVALID_INDEX;
-    ia_complex.faces[3].positive_cell    = 0;
-    ia_complex.faces[3].negative_cell    = INVALID_INDEX;
+    for (uint32_t i = 0; i < 4; ++i) {
+        auto& face            = ia_complex.faces[i];
+        face.edge_offset      = 3 * i;
+        face.edge_count       = 3;
+        face.supporting_plane = i;
+        face.positive_cell    = 0;
+        face.negative_cell    = INVALID_INDEX;
+    }
 
+    ia_complex.cell_faces.assign({0, 1, 2, 3});
+    ia_complex.cell_signs.assign(num_planes, false);
+    std::fill_n(ia_complex.cell_signs.begin(), 4, true);
+    ia_complex.sign_count = num_planes;
     ia_complex.cells.resize(1);
-    ia_complex.cells[0].faces = {0, 1, 2, 3};
-    ia_complex.cells[0].signs = {true, true, true, true};
-    ia_complex.cells[0].signs.resize(num_planes, false);
-
-    return ia_complex;
+    ia_complex.cells[0] = {0, 4, 0};
 }
 
 class arrangement_builder
 {
 public:
-    arrangement_builder(const stl_vector_mp<plane_t>& planes)
+    // use_lut = false always goes through add_plane(), e.g. to tabulate new cases
+    arrangement_builder(const stl_vector_mp<plane_t>& planes, bool use_lut = true)
     {
-        const auto  num_planes = static_cast<uint32_t>(planes.size());
-        const auto* ia         = lookup(planes);
-        if (ia != nullptr) {
-            m_arrangement = *ia;
-        } else {
-            auto ia_complex = init_ia_complex(num_planes + 3 + 1);
-            m_planes        = plane_group_t(planes);
+        const auto num_planes = static_cast<uint32_t>(planes.size());
+        if (!use_lut || !extract_from_lut(planes, m_arrangement)) {
+            // the complex of the last tet of this thread, whose storage is reused
+            static thread_local ia_complex_t ia_complex{};
+            init_ia_complex(ia_complex, num_planes + 3 + 1);
+            m_planes = plane_group_t(planes);
             m_coplanar_planes.init(num_planes + 3 + 1);
             uint32_t unique_plane_count = 0;
             for (size_t i = 0; i < num_planes; i++) {
@@ -82,7 +77,7 @@ public:
                 }
             }
             
-            m_arrangement = extract_arrangement(std::move(ia_complex));
+            m_arrangement = extract_arrangement(ia_complex);
 
             if (unique_plane_count != num_planes) {
                 // Only popularize unqiue plane structure if duplicate planes are
@@ -98,39 +93,74 @@ public:
 
     auto&& export_arrangement() && noexcept { return std::move(m_arrangement); }
 
-private:
-    const arrangement_t* lookup(const stl_vector_mp<plane_t>& planes) const
+    // copies the tabulated arrangement of the planes into result, returns false if the LUT is not loaded or lacks this case
+    static bool extract_from_lut(const stl_vector_mp<plane_t>& planes, arrangement_t& result)
     {
-        extern stl_vector_mp<arrangement_t> ia_data;
-        extern stl_vector_mp<uint32_t>      ia_indices;
+        uint32_t   symmetry  = ia_identity_symmetry;
+        const auto lut_index = lookup(planes, symmetry);
+        if (lut_index == INVALID_INDEX) return false;
 
-        const auto num_planes = static_cast<uint32_t>(planes.size());
-        if (num_planes == 1) {
-            const auto outer_index = ia_compute_outer_index(planes[0]);
-            if (outer_index == INVALID_INDEX) return nullptr;
+        ia_lut.extract(lut_index, result);
+        if (symmetry != ia_identity_symmetry) ia_restore_symmetry(symmetry, result);
+        return true;
+    }
+
+    // returns the index of the tabulated arrangement of the planes from their outer index, or INVALID_INDEX if the LUT is not
+    // loaded or lacks this case. The arrangement of 3 planes is the one of their representative, which the symmetry maps back
+    static uint32_t lookup(uint32_t outer_index, const plane_t* planes, uint32_t num_planes, uint32_t& symmetry)
+    {
+        if (ia_lut.empty() || outer_index == INVALID_INDEX) return INVALID_INDEX;
 
-            const auto start_idx = ia_indices[outer_index];
-            assert(ia_indices[outer_index + 1] == start_idx + 1);
+        const auto& start_indices = ia_lut.start_indices;
+        if (num_planes == 1) {
+            const auto start_idx = start_indices[outer_index];
+            assert(start_indices[outer_index + 1] == start_idx + 1);
 
-            return &ia_data[start_idx];
+            return start_idx;
         } else if (num_planes == 2) {
-            const auto outer_index = ia_compute_outer_index(planes[0], planes[1]);
-            if (outer_index == INVALID_INDEX) return nullptr;
-
-            const auto start_idx = ia_indices[outer_index];
-            const auto end_idx   = ia_indices[outer_index + 1];
+            const auto start_idx = start_indices[outer_index];
+            const auto end_idx   = start_indices[outer_index + 1];
 
             if (end_idx == start_idx + 1) {
-                return &ia_data[start_idx];
+                return start_idx;
             } else if (end_idx > start_idx) {
                 const auto inner_index = ia_compute_inner_index(outer_index, planes[0], planes[1]);
-                if (inner_index == INVALID_INDEX) return nullptr;
+                if (inner_index == INVALID_INDEX) return INVALID_INDEX;
                 assert(inner_index < end_idx - start_idx);
-                return &ia_data[start_idx + inner_index];
+                return start_idx + inner_index;
             }
+        } else if (num_planes == 3) {
+            if (ia_lut.three_plane_symmetries.empty()) return INVALID_INDEX;
+
+            const auto& representative = ia_lut.three_plane_symmetries[outer_index];
+            const auto  rep_planes     = ia_apply_symmetry(representative.symmetry, planes[0], planes[1], planes[2]);
+            const auto  inner_index =
+                ia_compute_inner_index(representative.outer_index, rep_planes[0], rep_planes[1], rep_planes[2]);
+            if (inner_index == INVALID_INDEX) return INVALID_INDEX;
+
+            symmetry = representative.symmetry;
+            return ia_lut.find_three_planes(representative.outer_index, inner_index);
+        }
+
+        return INVALID_INDEX;
+    }
+
+private:
+    static uint32_t lookup(const stl_vector_mp<plane_t>& planes, uint32_t& symmetry)
+    {
+        if (ia_lut.empty()) return INVALID_INDEX;
+
+        const auto num_planes  = static_cast<uint32_t>(planes.size());
+        uint32_t   outer_index = INVALID_INDEX;
+        if (num_planes == 1) {
+            outer_index = ia_compute_outer_index(planes[0]);
+        } else if (num_planes == 2) {
+            outer_index = ia_compute_outer_index(planes[0], planes[1]);
+        } else if (num_planes == 3 && !ia_lut.three_plane_symmetries.empty()) {
+            outer_index = ia_compute_outer_index(planes[0], planes[1], planes[2]);
         }
 
-        return nullptr;
+        return lookup(outer_index, planes.data(), num_planes, symmetry);
     }
 
     void extract_unique_planes()
@@ -4,4 +4,5 @@
 struct arrangement_t;
 struct ia_complex_t;
 
-arrangement_t extract_arrangement(ia_complex_t&& ia_complex);
\ No newline at end of file
+// copies the arrangement out of the complex, whose storage is left for the next tet
+arrangement_t extract_arrangement(const ia_complex_t& ia_complex);
\ No newline at end of file
@@ -4,6 +4,10 @@
 #include "ia_structure.hpp"
 
 int8_t ia_cut_0_face(const plane_group_t& planes, const ia_complex_t& ia_complex, uint32_t vid, uint32_t plane_index);
+void ia_cut_0_faces(const plane_group_t&   planes,
+                    ia_complex_t&          ia_complex,
+                    uint32_t               plane_index,
+                    stl_vector_mp<int8_t>& orientations);
 std::array<uint32_t, 3> ia_cut_1_face(ia_complex_t&                ia_complex,
                                       uint32_t                     eid,
                                       uint32_t                     plane_index,
@@ -2,7 +2,11 @@
 
 #include <array>
 
+#include <container/hashmap.hpp>
+#include <container/span.hpp>
+
 #include <implicit_arrangement.hpp>
+#include <implicit_predicates.hpp>
 
 using ia_vertex_t = point_t;
 
@@ -11,21 +15,73 @@ struct ia_edge_t {
     std::array<uint32_t, 2> supporting_planes{INVALID_INDEX, INVALID_INDEX};
 };
 
+// HINT: faces and cells do not own their boundaries, which are ranges of the pools of ia_complex_t; the ranges left
+// behind by cut faces and cells are only reclaimed when the complex is compacted after each plane
 struct ia_face_t {
-    stl_vector_mp<uint32_t> edges{}; ///< ordered
-    uint32_t                supporting_plane{INVALID_INDEX};
-    uint32_t                positive_cell{INVALID_INDEX};
-    uint32_t                negative_cell{INVALID_INDEX};
+    uint32_t edge_offset{}; ///< into ia_complex_t::face_edges
+    uint32_t edge_count{};  ///< of the ordered boundary edges
+    uint32_t supporting_plane{INVALID_INDEX};
+    uint32_t positive_cell{INVALID_INDEX};
+    uint32_t negative_cell{INVALID_INDEX};
 };
 
 struct ia_cell_t {
-    stl_vector_mp<uint32_t> faces{}; ///< ordered
-    stl_vector_mp<bool>     signs{}; ///< sign of implicit functions
+    uint32_t face_offset{}; ///< into ia_complex_t::cell_faces
+    uint32_t face_count{};  ///< of the ordered boundary faces
+    uint32_t sign_offset{}; ///< into ia_complex_t::cell_signs, of the sign_count signs of the implicit functions
 };
 
+// reused for every tet of a thread (see init_ia_complex), so that its pools are not freed between tets
 struct ia_complex_t {
     stl_vector_mp<ia_vertex_t> vertices{};
     stl_vector_mp<ia_edge_t>   edges{};
     stl_vector_mp<ia_face_t>   faces{};
     stl_vector_mp<ia_cell_t>   cells{};
+
+    stl_vector_mp<uint32_t> face_edges{};
+    stl_vector_mp<uint32_t> cell_faces{};
+    stl_vector_mp<bool>     cell_signs{};
+    uint32_t                sign_count{};
+
+    span<uint32_t> edges_of(const ia_face_t& face) noexcept { return {face_edges.data() + face.edge_offset, face.edge_count}; }
+
+    span<const uint32_t> edges_of(const ia_face_t& face) const noexcept
+    {
+        return {face_edges.data() + face.edge_offset, face.edge_count};
+    }
+
+    span<uint32_t> faces_of(const ia_cell_t& cell) noexcept { return {cell_faces.data() + cell.face_offset, cell.face_count}; }
+
+    span<const uint32_t> faces_of(const ia_cell_t& cell) const noexcept
+    {
+        return {cell_faces.data() + cell.face_offset, cell.face_count};
+    }
+
+    stl_vector_mp<bool>::reference sign_of(const ia_cell_t& cell, uint32_t plane_index) noexcept
+    {
+        return cell_signs[cell.sign_offset + plane_index];
+    }
+
+    bool sign_of(const ia_cell_t& cell, uint32_t plane_index) const noexcept
+    {
+        return cell_signs[cell.sign_offset + plane_index];
+    }
+
+    /* scratch buffers of add_plane() and ia_cut_*_face(), kept only to reuse their storage */
+    stl_vector_mp<int8_t>                  orientations{};
+    stl_vector_mp<double>                  vertex_plane_values{};
+    stl_vector_mp<orientation>             vertex_orientations{};
+    stl_vector_mp<std::array<uint32_t, 3>> subedges{};
+    stl_vector_mp<std::array<uint32_t, 3>> subfaces{};
+    stl_vector_mp<std::array<uint32_t, 3>> subcells{};
+    stl_vector_mp<bool>                    active_flags{};
+    stl_vector_mp<uint32_t>                index_map{};
+    stl_vector_mp<uint32_t>                spare_indices{};
+    stl_vector_mp<bool>                    spare_signs{};
+    stl_vector_mp<uint32_t>                positive_subelements{};
+    stl_vector_mp<uint32_t>                negative_subelements{};
+    stl_vector_mp<uint32_t>                cut_edges{};
+    stl_vector_mp<uint32_t>                chained_cut_edges{};
+    stl_vector_mp<bool>                    cut_edge_orientations{};
+    flat_hash_map_mp<uint32_t, uint32_t>   vertex_to_cut_edge{};
 };
\ No newline at end of file
@@ -1,14 +1,80 @@
 #pragma once
 
+#include <container/span.hpp>
+
 #include <implicit_arrangement.hpp>
 
+// the table is stored flat (CSR): the arrays of all arrangements are concatenated, and every offset table has a
+// trailing sentinel; ia_lut.bin uses the same layout, so it is used in place from the mapped file
+struct ia_lut_arrangement_t {
+    uint32_t vertex_offset{}; // into ia_lut_t::vertices
+    uint32_t face_offset{};   // into ia_lut_t::faces
+    uint32_t cell_offset{};   // into ia_lut_t::cell_face_offsets
+};
+
+struct ia_lut_face_t {
+    uint32_t vertex_offset{}; // into ia_lut_t::face_vertices
+    uint32_t supporting_plane{INVALID_INDEX};
+    uint32_t positive_cell{INVALID_INDEX};
+    uint32_t negative_cell{INVALID_INDEX};
+};
+
+// HINT: 3 plane arrangements are only tabulated for one representative of the planes equal up to permutations of
+// the tet vertices and of the planes and plane flips; the tabulated arrangement is mapped back after extracting it
+struct ia_lut_symmetry_t {
+    uint16_t outer_index{}; // of the representative planes
+    uint16_t symmetry{};    // mapping the planes to the representative ones, see ia_apply_symmetry
+};
+
+struct ia_lut_t {
+    span<const uint32_t>             start_indices{}; // outer index -> first arrangement of the outer index
+    span<const ia_lut_arrangement_t> arrangements{};
+    span<const point_t>              vertices{};
+    span<const ia_lut_face_t>        faces{};
+    span<const uint32_t>             face_vertices{};     // local vertex indices of the arrangement
+    span<const uint32_t>             cell_face_offsets{}; // into cell_faces
+    span<const uint32_t>             cell_faces{};        // local face indices of the arrangement
+
+    span<const ia_lut_symmetry_t> three_plane_symmetries{};    // outer index -> representative
+    span<const uint32_t>          three_plane_start_indices{}; // representative outer index -> first arrangement
+    span<const uint32_t>          three_plane_inner_indices{}; // of the arrangements from three_plane_start_indices[0]
+
+    bool empty() const noexcept { return arrangements.size() < 2; }
+
+    // copies the arrangement out of the flat arrays, reusing the storage of the result
+    void extract(uint32_t index, arrangement_t& result) const;
+
+    // returns the index of the arrangement of the representative planes, or INVALID_INDEX if the case is not tabulated
+    uint32_t find_three_planes(uint32_t outer_index, uint32_t inner_index) const;
+};
+
 // Lookup table for simplicial arrangement
-extern stl_vector_mp<arrangement_t> ia_data;
-extern stl_vector_mp<uint32_t>      ia_indices;
+extern ia_lut_t ia_lut;
 
 // For 1 plane arrangement lookup.
 uint32_t ia_compute_outer_index(const plane_t& p0);
 
 // For 2 plane arrangement lookup.
 uint32_t ia_compute_outer_index(const plane_t& p0, const plane_t& p1);
-uint32_t ia_compute_inner_index(uint32_t outer_index, const plane_t& p0, const plane_t& p1);
\ No newline at end of file
+uint32_t ia_compute_inner_index(uint32_t outer_index, const plane_t& p0, const plane_t& p1);
+
+// For 3 plane arrangement lookup.
+uint32_t ia_compute_outer_index(const plane_t& p0, const plane_t& p1, const plane_t& p2);
+uint32_t ia_compute_inner_index(uint32_t outer_index, const plane_t& p0, const plane_t& p1, const plane_t& p2);
+
+// For the lookup of a batch of tets with 1 to 3 planes each, whose coefficients are stored as structure of arrays, i.e.
+// coefficient i of plane j of tet t is coefficients[(4 * j + i) * tet_count + t]. Writes the same outer index as above for
+// every tet
+void ia_compute_outer_indices(uint32_t num_planes, span<const double> coefficients, span<uint32_t> outer_indices);
+
+// For the lookup of a batch of tets with 2 planes each, stored as above, from their outer indices. Writes the index of the
+// tabulated arrangement of every tet, or INVALID_INDEX if the LUT lacks it, as arrangement_builder::lookup() finds it
+void ia_compute_two_plane_lut_indices(span<const double>   coefficients,
+                                      span<const uint32_t> outer_indices,
+                                      span<uint32_t>       lut_indices);
+
+static constexpr uint32_t ia_identity_symmetry = 0;
+
+// maps 3 planes to their representative, and the arrangement of the representative back to the one of the planes
+std::array<plane_t, 3> ia_apply_symmetry(uint32_t symmetry, const plane_t& p0, const plane_t& p1, const plane_t& p2);
+void                   ia_restore_symmetry(uint32_t symmetry, arrangement_t& arrangement);
\ No newline at end of file
@@ -1,9 +1,13 @@
 #pragma once
 
+#include <cstring>
+#include <memory>
+
 #include <tbb/tbb.h>
 
 #include <macros.h>
 #include <container/small_vector.hpp>
+#include <container/span.hpp>
 
 /**
  * A plane is defined by the barycentric plane equation:
@@ -53,6 +57,293 @@ struct arrangement_t {
     stl_vector_mp<bool>                    unique_plane_orientations{};
 };
 
+/**
+ * The read-only form of an arrangement that is kept for each tet. All its indices are stored in one contiguous buffer, with
+ * the smallest width that holds them, i.e. one byte for all but the largest arrangements, where INVALID_INDEX is stored as
+ * the largest value of that width. The accessors return views with the same members as arrangement_t, which decode the
+ * indices on the fly.
+ */
+class compact_arrangement_t
+{
+public:
+    /// A range of consecutive indices of the buffer.
+    class index_range_t
+    {
+    public:
+        /// Decodes the index on dereference and returns it by value, so that it is only an input iterator.
+        class iterator
+        {
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type        = uint32_t;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = void;
+            using reference         = uint32_t;
+
+            iterator() noexcept = default;
+
+            iterator(const uint8_t* data, uint32_t index, uint8_t index_size) noexcept
+                : m_data(data), m_index(index), m_index_size(index_size)
+            {
+            }
+
+            uint32_t operator*() const noexcept { return load(m_data, m_index, m_index_size); }
+
+            iterator& operator++() noexcept
+            {
+                ++m_index;
+                return *this;
+            }
+
+            iterator operator++(int) noexcept
+            {
+                auto result = *this;
+                ++m_index;
+                return result;
+            }
+
+            bool operator==(const iterator& other) const noexcept { return m_index == other.m_index; }
+
+            bool operator!=(const iterator& other) const noexcept { return m_index != other.m_index; }
+
+        private:
+            const uint8_t* m_data{};
+            uint32_t       m_index{};
+            uint8_t        m_index_size{1};
+        };
+
+        index_range_t() noexcept = default;
+
+        index_range_t(const uint8_t* data, uint32_t count, uint8_t index_size) noexcept
+            : m_data(data), m_count(count), m_index_size(index_size)
+        {
+        }
+
+        uint32_t size() const noexcept { return m_count; }
+
+        bool empty() const noexcept { return m_count == 0; }
+
+        uint32_t operator[](uint32_t index) const noexcept { return load(m_data, index, m_index_size); }
+
+        uint32_t front() const noexcept { return (*this)[0]; }
+
+        uint32_t back() const noexcept { return (*this)[m_count - 1]; }
+
+        iterator begin() const noexcept { return {m_data, 0, m_index_size}; }
+
+        iterator end() const noexcept { return {m_data, m_count, m_index_size}; }
+
+        static uint32_t load(const uint8_t* data, uint32_t index, uint8_t index_size) noexcept
+        {
+            switch (index_size) {
+                case 1: {
+                    const uint8_t value = data[index];
+                    return value == UINT8_MAX ? INVALID_INDEX : value;
+                }
+                case 2: {
+                    uint16_t value;
+                    std::memcpy(&value, data + 2 * index, sizeof(value));
+                    return value == UINT16_MAX ? INVALID_INDEX : value;
+                }
+                default: {
+                    uint32_t value;
+                    std::memcpy(&value, data + 4 * index, sizeof(value));
+                    return value;
+                }
+            }
+        }
+
+    private:
+        const uint8_t* m_data{};
+        uint32_t       m_count{};
+        uint8_t        m_index_size{1};
+    };
+
+    struct face_view_t {
+        index_range_t vertices{};                      ///< An ordered list of boundary vertices, as in arrangement_t.
+        uint32_t      supporting_plane{INVALID_INDEX}; ///< Plane index of the supporting plane.
+        uint32_t      positive_cell{INVALID_INDEX};    ///< The cell index on the positive side of this face.
+        uint32_t      negative_cell{INVALID_INDEX};    ///< The cell index on the negative side of this face.
+    };
+
+    struct cell_view_t {
+        index_range_t faces{};
+    };
+
+    /// A range of the vertices, faces, cells or unique planes, which are decoded when they are accessed.
+    template <typename T, T (compact_arrangement_t::*get)(uint32_t) const noexcept>
+    class element_range_t
+    {
+    public:
+        /// Decodes the element on dereference and returns a view of it by value, so that it is only an input iterator.
+        class iterator
+        {
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type        = T;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = void;
+            using reference         = T;
+
+            iterator() noexcept = default;
+
+            iterator(const compact_arrangement_t* owner, uint32_t index) noexcept : m_owner(owner), m_index(index) {}
+
+            T operator*() const noexcept { return (m_owner->*get)(m_index); }
+
+            iterator& operator++() noexcept
+            {
+                ++m_index;
+                return *this;
+            }
+
+            iterator operator++(int) noexcept
+            {
+                auto result = *this;
+                ++m_index;
+                return result;
+            }
+
+            bool operator==(const iterator& other) const noexcept { return m_index == other.m_index; }
+
+            bool operator!=(const iterator& other) const noexcept { return m_index != other.m_index; }
+
+        private:
+            const compact_arrangement_t* m_owner{};
+            uint32_t                     m_index{};
+        };
+
+        element_range_t(const compact_arrangement_t* owner, uint32_t count) noexcept : m_owner(owner), m_count(count) {}
+
+        uint32_t size() const noexcept { return m_count; }
+
+        bool empty() const noexcept { return m_count == 0; }
+
+        T operator[](uint32_t index) const noexcept { return (m_owner->*get)(index); }
+
+        iterator begin() const noexcept { return {m_owner, 0}; }
+
+        iterator end() const noexcept { return {m_owner, m_count}; }
+
+    private:
+        const compact_arrangement_t* m_owner{};
+        uint32_t                     m_count{};
+    };
+
+    compact_arrangement_t() noexcept = default;
+    IA_API explicit compact_arrangement_t(const arrangement_t& arrangement);
+
+    // the arrangement_t that was encoded
+    IA_API arrangement_t decode() const;
+
+    point_t vertex(uint32_t index) const noexcept
+    {
+        return {load(3 * index), load(3 * index + 1), load(3 * index + 2)};
+    }
+
+    face_view_t face(uint32_t index) const noexcept
+    {
+        const auto begin = load(m_face_vertex_offset + index);
+        const auto end   = load(m_face_vertex_offset + index + 1);
+        return {range(m_face_vertex_offset + m_face_count + 1 + begin, end - begin),
+                load(m_face_offset + 3 * index),
+                load(m_face_offset + 3 * index + 1),
+                load(m_face_offset + 3 * index + 2)};
+    }
+
+    cell_view_t cell(uint32_t index) const noexcept
+    {
+        const auto begin = load(m_cell_face_offset + index);
+        const auto end   = load(m_cell_face_offset + index + 1);
+        return {range(m_cell_face_offset + m_cell_count + 1 + begin, end - begin)};
+    }
+
+    // the planes coplanar to each other with the given unique plane index
+    index_range_t unique_plane(uint32_t index) const noexcept
+    {
+        const auto offset = m_unique_plane_offset + m_plane_count;
+        const auto begin  = load(offset + index);
+        const auto end    = load(offset + index + 1);
+        return range(offset + m_unique_plane_count + 1 + begin, end - begin);
+    }
+
+    element_range_t<point_t, &compact_arrangement_t::vertex> vertices() const noexcept { return {this, m_vertex_count}; }
+
+    element_range_t<face_view_t, &compact_arrangement_t::face> faces() const noexcept { return {this, m_face_count}; }
+
+    element_range_t<cell_view_t, &compact_arrangement_t::cell> cells() const noexcept { return {this, m_cell_count}; }
+
+    /* Note: the following ranges are only non-empty if input planes contain duplicates. */
+    index_range_t unique_plane_indices() const noexcept { return range(m_unique_plane_offset, m_plane_count); }
+
+    element_range_t<index_range_t, &compact_arrangement_t::unique_plane> unique_planes() const noexcept
+    {
+        return {this, m_unique_plane_count};
+    }
+
+    // 1 if the plane is oriented as the first plane of its unique plane, 0 otherwise
+    index_range_t unique_plane_orientations() const noexcept
+    {
+        return range(m_unique_plane_offset + 2 * m_plane_count + m_unique_plane_count + 1, m_plane_count);
+    }
+
+    // size of the buffer of indices
+    size_t byte_size() const noexcept { return m_data.size(); }
+
+private:
+    uint32_t load(uint32_t index) const noexcept { return index_range_t::load(m_data.data(), index, m_index_size); }
+
+    index_range_t range(uint32_t index, uint32_t count) const noexcept
+    {
+        return {m_data.data() + index * m_index_size, count, m_index_size};
+    }
+
+    // the buffer stores, in this order and in units of indices:
+    // - 3 planes per vertex,
+    // - the supporting plane, positive and negative cells of each face,
+    // - face_count + 1 offsets into the following vertices of the faces, then the vertices of the faces,
+    // - cell_count + 1 offsets into the following faces of the cells, then the faces of the cells,
+    // - if the planes contain duplicates: the unique plane index of each plane, unique_plane_count + 1 offsets into the
+    //   following planes of each unique plane, these planes, then the orientation of each plane
+    stl_vector_mp<uint8_t> m_data{};
+    uint8_t                m_index_size{1};
+    uint32_t               m_vertex_count{};
+    uint32_t               m_face_count{};
+    uint32_t               m_cell_count{};
+    uint32_t               m_plane_count{}; ///< Of the unique plane indices, 0 if the planes contain no duplicates.
+    uint32_t               m_unique_plane_count{};
+    uint32_t               m_face_offset{};
+    uint32_t               m_face_vertex_offset{};
+    uint32_t               m_cell_face_offset{};
+    uint32_t               m_unique_plane_offset{};
+};
+
+struct arrangement_cache_counters_t {
+    uint64_t hits{};       ///< Arrangements shared from the cache.
+    uint64_t misses{};     ///< Arrangements computed by inserting the planes one by one.
+    uint64_t lut_hits{};   ///< Arrangements taken from the LUT by compute_shared_arrangement(s).
+    uint64_t lut_misses{}; ///< Arrangements of planes that the LUT lacks, which go to the cache or to add_plane().
+};
+
 IA_API bool          load_lut();
+IA_API bool          generate_lut(const char* msgpack_path, const char* binary_path);
 IA_API void          lut_print_test();
-IA_API arrangement_t compute_arrangement(const stl_vector_mp<plane_t>& planes);
\ No newline at end of file
+IA_API arrangement_t compute_arrangement(const stl_vector_mp<plane_t>& planes);
+
+/**
+ * Same as compute_arrangement, but in the compact form, and the arrangements of 3 or more planes that the LUT lacks are
+ * cached by the combinatorial signature of the planes, i.e. their vertex signs and predicate outcomes up to a permutation of
+ * the tet vertices, so that planes with the same signature share the same immutable arrangement.
+ */
+IA_API std::shared_ptr<const compact_arrangement_t> compute_shared_arrangement(const stl_vector_mp<plane_t>& planes);
+IA_API arrangement_cache_counters_t                 get_arrangement_cache_counters();
+IA_API void                                         clear_arrangement_cache();
+
+/**
+ * Same as compute_shared_arrangement for a batch of tets with num_planes planes each, whose coefficients are stored as
+ * structure of arrays: coefficient i of plane j of tet t is coefficients[(4 * j + i) * results.size() + t]. The LUT indices
+ * of the whole batch are computed at once, and the tets with the same tabulated arrangement share it.
+ */
+IA_API void compute_shared_arrangements(uint32_t                                           num_planes,
+                                        span<const double>                                 coefficients,
+                                        span<std::shared_ptr<const compact_arrangement_t>> results);
\ No newline at end of file
@@ -0,0 +1,18 @@
+#include <iostream>
+
+#include <implicit_arrangement.hpp>
+
+// flattens the msgpack lookup table and tabulates the generic 3 plane cases into the binary table that load_lut() maps
+// usage: implicit_arrangements.LUT.generate [input.msgpack] [output.bin]
+int main(int argc, char** argv)
+{
+    const char* msgpack_path = argc > 1 ? argv[1] : "ia_lut.msgpack";
+    const char* binary_path  = argc > 2 ? argv[2] : "ia_lut.bin";
+
+    if (!generate_lut(msgpack_path, binary_path)) {
+        std::cerr << "Error: failed to generate " << binary_path << " from " << msgpack_path << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -21,54 +21,83 @@ inline void shrink(stl_vector_mp<T>& c, stl_vector_mp<uint32_t>& index_map, cons
     c.resize(active_count);
 }
 
+// copies the ranges of the elements, in their order, to the front of the spare pool, which then becomes the pool
+template <typename T, typename E>
+inline void compact_pool(stl_vector_mp<T>& pool,
+                         stl_vector_mp<T>& spare_pool,
+                         stl_vector_mp<E>& elements,
+                         uint32_t E::*     offset,
+                         uint32_t          count)
+{
+    spare_pool.resize(elements.size() * count);
+    uint32_t next_offset = 0;
+    for (auto& e : elements) {
+        std::copy_n(pool.begin() + (e.*offset), count, spare_pool.begin() + next_offset);
+        e.*offset = next_offset;
+        next_offset += count;
+    }
+    std::swap(pool, spare_pool);
+}
+
+template <typename T, typename E>
+inline void compact_pool(stl_vector_mp<T>& pool,
+                         stl_vector_mp<T>& spare_pool,
+                         stl_vector_mp<E>& elements,
+                         uint32_t E::*     offset,
+                         uint32_t E::*     count)
+{
+    spare_pool.clear();
+    for (auto& e : elements) {
+        const auto next_offset = static_cast<uint32_t>(spare_pool.size());
+        spare_pool.insert(spare_pool.end(), pool.begin() + (e.*offset), pool.begin() + (e.*offset + e.*count));
+        e.*offset = next_offset;
+    }
+    std::swap(pool, spare_pool);
+}
+
 /**
- * Remove unused verices and faces.
+ * Remove unused verices and faces, and the boundaries of the removed faces and cells from the pools.
  */
 inline void remove_unused_geometry(ia_complex_t& data)
 {
-    stl_vector_mp<bool>     active_geometries{};
-    stl_vector_mp<uint32_t> index_map{};
+    auto& active_geometries = data.active_flags;
+    auto& index_map         = data.index_map;
+
+    // Compact the boundaries and signs of the cells, i.e. drop the ones of the cells that were cut.
+    compact_pool(data.cell_faces, data.spare_indices, data.cells, &ia_cell_t::face_offset, &ia_cell_t::face_count);
+    compact_pool(data.cell_signs, data.spare_signs, data.cells, &ia_cell_t::sign_offset, data.sign_count);
 
     {
         // Shrink faces.
         active_geometries.assign(data.faces.size(), false);
-        for (auto& c : data.cells) {
-            for (auto fid : c.faces) { active_geometries[fid] = true; }
-        }
+        for (auto fid : data.cell_faces) { active_geometries[fid] = true; }
 
         shrink(data.faces, index_map, active_geometries);
 
-        for (auto& c : data.cells) {
-            algorithm::transform<algorithm::ExecutionPolicySelector::simd_only>(
-                c.faces.begin(),
-                c.faces.end(),
-                c.faces.begin(),
-                [&](uint32_t i) {
-                    ROBUST_ASSERT(index_map[i] != INVALID_INDEX);
-                    return index_map[i];
-                });
-        }
+        algorithm::transform<algorithm::ExecutionPolicySelector::simd_only>(data.cell_faces.begin(),
+                                                                            data.cell_faces.end(),
+                                                                            data.cell_faces.begin(),
+                                                                            [&](uint32_t i) {
+                                                                                ROBUST_ASSERT(index_map[i] != INVALID_INDEX);
+                                                                                return index_map[i];
+                                                                            });
+        compact_pool(data.face_edges, data.spare_indices, data.faces, &ia_face_t::edge_offset, &ia_face_t::edge_count);
     }
 
     // Shrink edges.
     {
         active_geometries.assign(data.edges.size(), false);
-        for (auto& f : data.faces) {
-            for (auto eid : f.edges) { active_geometries[eid] = true; }
-        }
+        for (auto eid : data.face_edges) { active_geometries[eid] = true; }
 
         shrink(data.edges, index_map, active_geometries);
 
-        for (auto& f : data.faces) {
-            algorithm::transform<algorithm::ExecutionPolicySelector::simd_only>(
-                f.edges.begin(),
-                f.edges.end(),
-                f.edges.begin(),
-                [&](uint32_t i) {
-                    ROBUST_ASSERT(index_map[i] != INVALID_INDEX);
-                    return index_map[i];
-                });
-        }
+        algorithm::transform<algorithm::ExecutionPolicySelector::simd_only>(data.face_edges.begin(),
+                                                                            data.face_edges.end(),
+                                                                            data.face_edges.begin(),
+                                                                            [&](uint32_t i) {
+                                                                                ROBUST_ASSERT(index_map[i] != INVALID_INDEX);
+                                                                                return index_map[i];
+                                                                            });
     }
 
     // Shrink vertices.
@@ -109,36 +138,36 @@ uint32_t add_plane(const plane_group_t& repo, ia_complex_t& ia_complex, uint32_t
     cells.reserve(num_cells * 2);
 
     // Step 1: handle 0-faces.
-    stl_vector_mp<int8_t> orientations{};
-    orientations.reserve(num_vertices);
-    for (uint32_t i = 0; i < num_vertices; i++) { orientations.emplace_back(ia_cut_0_face(repo, ia_complex, i, plane_index)); }
+    auto& orientations = ia_complex.orientations;
+    ia_cut_0_faces(repo, ia_complex, plane_index, orientations);
 
     // Step 2: handle 1-faces.
-    stl_vector_mp<std::array<uint32_t, 3>> subedges{};
-    subedges.reserve(num_edges);
+    auto& subedges = ia_complex.subedges;
+    subedges.clear();
     for (uint32_t i = 0; i < num_edges; i++) { subedges.emplace_back(ia_cut_1_face(ia_complex, i, plane_index, orientations)); }
 
     // Step 3: handle 2-faces.
-    stl_vector_mp<std::array<uint32_t, 3>> subfaces{};
-    subfaces.reserve(num_faces);
+    auto& subfaces = ia_complex.subfaces;
+    subfaces.clear();
     for (uint32_t i = 0; i < num_faces; i++) {
         subfaces.emplace_back(ia_cut_2_face(ia_complex, i, plane_index, orientations, subedges));
     }
 
     // Step 4: handle 3-faces.
-    stl_vector_mp<std::array<uint32_t, 3>> subcells{};
-    subcells.reserve(num_cells);
+    auto& subcells = ia_complex.subcells;
+    subcells.clear();
     for (uint32_t i = 0; i < num_cells; i++) { subcells.emplace_back(ia_cut_3_face(ia_complex, i, plane_index, subfaces)); }
 
     // Step 5: remove old cells and update cell indices
     {
-        stl_vector_mp<bool> to_keep(cells.size(), false);
+        auto& to_keep = ia_complex.active_flags;
+        to_keep.assign(cells.size(), false);
         for (const auto& subcell : subcells) {
             if (subcell[0] != INVALID_INDEX) to_keep[subcell[0]] = true;
             if (subcell[1] != INVALID_INDEX) to_keep[subcell[1]] = true;
         }
 
-        stl_vector_mp<uint32_t> index_map{};
+        auto& index_map = ia_complex.index_map;
         shrink(cells, index_map, to_keep);
 
         // Update cell indices in faces.
@@ -0,0 +1,408 @@
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+
+#include <tbb/concurrent_hash_map.h>
+
+#include <container/hashmap.hpp>
+
+#include "arrangement_builder.hpp"
+#include "implicit_predicates.hpp"
+
+/* =============================================================================================
+ * combinatorial signature
+ * ============================================================================================= */
+
+// HINT: add_plane() only branches on orient3d of the planes, so the arrangement only depends on the signs of the
+// minors det(e_A, p_S) of the tet boundaries e_i and the planes, for every |A| + |S| = 4. Those signs, packed 2 bits
+// each after the plane count, are the signature of the planes
+using arrangement_signature_t = stl_vector_mp<uint64_t>;
+
+// permuting the tet vertices with q[j][i] = p[j][vertices[i]] only permutes and negates the minors, so the signature is
+// normalized to the smallest one over all permutations, and the cached arrangement is the one of the permuted planes. But
+// add_plane() only maps to the same arrangement under such a permutation if no minor is zero: e.g. a vertex where 4 planes
+// meet is described by the first 3 planes that were inserted, so degenerate signatures are not normalized
+struct tet_vertex_permutation_t {
+    std::array<uint32_t, 4> vertices{};
+    std::array<uint8_t, 16> subset_positions{}; // A -> position of vertices(A) among the subsets of its size
+    std::array<int8_t, 16>  subset_signs{};     // det(e_A, q_S) = sign * det(e_vertices(A), p_S)
+};
+
+static constexpr uint32_t tet_vertex_permutation_count = 24;
+
+// the minors of the subsets A of a given size are stored in the order of their masks
+static constexpr std::array<std::array<uint8_t, 6>, 4> tet_subsets = {
+    {{0b0000},
+     {0b0001, 0b0010, 0b0100, 0b1000},
+     {0b0011, 0b0101, 0b0110, 0b1001, 0b1010, 0b1100},
+     {0b0111, 0b1011, 0b1101, 0b1110}}
+};
+static constexpr std::array<uint32_t, 4> tet_subset_counts = {1, 4, 6, 4};
+
+static inline uint32_t subset_position(uint32_t mask)
+{
+    const auto& subsets = tet_subsets[std::bitset<4>(mask).count()];
+    return static_cast<uint32_t>(std::find(subsets.begin(), subsets.end(), mask) - subsets.begin());
+}
+
+// +1 if the sequence is an even permutation of its sorted values, -1 otherwise
+template <size_t N>
+static inline int8_t permutation_sign(const std::array<uint32_t, N>& sequence, uint32_t size = N)
+{
+    uint32_t inversion_count = 0;
+    for (uint32_t i = 0; i < size; ++i)
+        for (uint32_t j = i + 1; j < size; ++j) inversion_count += sequence[i] > sequence[j];
+    return inversion_count % 2 == 0 ? 1 : -1;
+}
+
+static const std::array<tet_vertex_permutation_t, tet_vertex_permutation_count>& tet_vertex_permutations()
+{
+    static const auto permutations = [] {
+        std::array<tet_vertex_permutation_t, tet_vertex_permutation_count> result{};
+        std::array<uint32_t, 4>                                           vertices = {0, 1, 2, 3};
+        for (auto& permutation : result) {
+            permutation.vertices = vertices;
+            const auto sign      = permutation_sign(vertices);
+            // the 4 tet boundaries leave no column to the planes
+            for (uint32_t mask = 0; mask < 15; ++mask) {
+                std::array<uint32_t, 4> image{};
+                uint32_t                size = 0;
+                for (uint32_t i = 0; i < 4; ++i)
+                    if (mask & (1u << i)) image[size++] = vertices[i];
+
+                uint8_t image_mask = 0;
+                for (uint32_t i = 0; i < size; ++i) image_mask |= 1u << image[i];
+                permutation.subset_positions[mask] = subset_position(image_mask);
+                permutation.subset_signs[mask]     = sign * permutation_sign(image, size);
+            }
+            std::next_permutation(vertices.begin(), vertices.end());
+        }
+        return result;
+    }();
+    return permutations;
+}
+
+static inline int8_t sign_of(orientation o) { return static_cast<int8_t>(o); }
+
+// sign of det(e_A, p_S), where the tet boundaries e_A leave the minor of p_S on the remaining columns
+static int8_t compute_minor_sign(const stl_vector_mp<plane_t>& planes, const std::array<uint32_t, 4>& subset, uint32_t mask)
+{
+    // moving the rows e_A to the top left corner of the matrix takes the permutation (A, columns)
+    std::array<uint32_t, 4> order{}, columns{};
+    uint32_t                row_count = 0, column_count = 0;
+    for (uint32_t i = 0; i < 4; ++i) {
+        if (mask & (1u << i)) {
+            order[row_count++] = i;
+        } else {
+            columns[column_count++] = i;
+        }
+    }
+    std::copy_n(columns.begin(), column_count, order.begin() + row_count);
+    const auto sign = permutation_sign(order);
+
+    std::array<std::array<double, 4>, 4> minor{};
+    for (uint32_t i = 0; i < column_count; ++i)
+        for (uint32_t j = 0; j < column_count; ++j) minor[i][j] = planes[subset[i]][columns[j]];
+    switch (column_count) {
+        case 1:  return sign * (minor[0][0] > 0 ? 1 : (minor[0][0] < 0 ? -1 : 0));
+        case 2:  return sign * sign_of(det2_sign(minor[0].data(), minor[1].data()));
+        case 3:  return sign * sign_of(det3_sign(minor[0].data(), minor[1].data(), minor[2].data()));
+        default: return sign * sign_of(det4_sign(minor[0].data(), minor[1].data(), minor[2].data(), minor[3].data()));
+    }
+}
+
+// returns the index of the permutation of the tet vertices that maps the planes to the ones of the signature
+static uint32_t compute_signature(const stl_vector_mp<plane_t>& planes, arrangement_signature_t& signature)
+{
+    const auto num_planes = static_cast<uint32_t>(planes.size());
+    const auto max_size   = std::min(num_planes, 4u);
+
+    // the minors of the subsets S of the planes, by size of S and then in lexicographic order, so that the minors of the same
+    // S are consecutive
+    stl_vector_mp<int8_t>   signs{};
+    std::array<uint32_t, 5> subset_counts{};
+    for (uint32_t size = 1; size <= max_size; ++size) {
+        std::array<uint32_t, 4> subset{};
+        for (uint32_t i = 0; i < size; ++i) subset[i] = i;
+        while (true) {
+            const auto& masks = tet_subsets[4 - size];
+            for (uint32_t i = 0; i < tet_subset_counts[4 - size]; ++i)
+                signs.emplace_back(compute_minor_sign(planes, subset, masks[i]));
+            subset_counts[size]++;
+
+            // next subset of the same size
+            int32_t i = static_cast<int32_t>(size) - 1;
+            while (i >= 0 && subset[i] == num_planes - size + i) --i;
+            if (i < 0) break;
+            ++subset[i];
+            for (uint32_t j = i + 1; j < size; ++j) subset[j] = subset[j - 1] + 1;
+        }
+    }
+
+    // a permutation only reorders and negates the minors of the same S
+    const auto&           permutations = tet_vertex_permutations();
+    const bool            is_generic   = std::find(signs.begin(), signs.end(), 0) == signs.end();
+    stl_vector_mp<int8_t> best_signs(signs), permuted_signs(signs.size());
+    uint32_t              best_permutation = 0;
+    for (uint32_t k = 1; k < (is_generic ? tet_vertex_permutation_count : 1); ++k) {
+        const auto& permutation = permutations[k];
+        int32_t     order       = 0; // of the permuted minors compared to the best ones, stopping as soon as they are larger
+        size_t      offset      = 0;
+        for (uint32_t size = 1; size <= max_size && order <= 0; ++size) {
+            const auto& masks = tet_subsets[4 - size];
+            const auto  count = tet_subset_counts[4 - size];
+            for (uint32_t s = 0; s < subset_counts[size] && order <= 0; ++s, offset += count) {
+                for (uint32_t i = 0; i < count; ++i) {
+                    const auto mask            = masks[i];
+                    const auto source          = offset + permutation.subset_positions[mask];
+                    const auto sign            = permutation.subset_signs[mask] * signs[source];
+                    permuted_signs[offset + i] = static_cast<int8_t>(sign);
+                    if (order == 0) order = (sign > best_signs[offset + i]) - (sign < best_signs[offset + i]);
+                }
+            }
+        }
+        if (order < 0) {
+            std::swap(best_signs, permuted_signs);
+            best_permutation = k;
+        }
+    }
+
+    signature.assign(1 + (best_signs.size() + 31) / 32, 0);
+    signature[0] = num_planes;
+    for (size_t i = 0; i < best_signs.size(); ++i)
+        signature[1 + i / 32] |= static_cast<uint64_t>(best_signs[i] + 1) << (2 * (i % 32));
+    return best_permutation;
+}
+
+// maps the arrangement of the permuted planes back to the one of the planes
+static void restore_tet_vertex_permutation(const std::array<uint32_t, 4>& vertices, arrangement_t& arrangement)
+{
+    // plane i < 4 of the permuted planes is the tet boundary opposite to vertex vertices[i]
+    const auto restore_plane = [&](uint32_t plane) { return plane < 4 ? vertices[plane] : plane; };
+
+    // an odd permutation mirrors the tet, which reverses the orientation of the faces
+    const bool is_mirrored = permutation_sign(vertices) < 0;
+
+    for (auto& vertex : arrangement.vertices)
+        for (auto& plane : vertex) plane = restore_plane(plane);
+    for (auto& face : arrangement.faces) {
+        face.supporting_plane = restore_plane(face.supporting_plane);
+        if (is_mirrored) std::reverse(face.vertices.begin(), face.vertices.end());
+    }
+
+    if (arrangement.unique_planes.empty()) return;
+    for (auto& planes : arrangement.unique_planes)
+        for (auto& plane : planes) plane = restore_plane(plane);
+    const auto unique_plane_indices      = arrangement.unique_plane_indices;
+    const auto unique_plane_orientations = arrangement.unique_plane_orientations;
+    for (uint32_t i = 0; i < 4; ++i) {
+        arrangement.unique_plane_indices[vertices[i]]      = unique_plane_indices[i];
+        arrangement.unique_plane_orientations[vertices[i]] = unique_plane_orientations[i];
+    }
+}
+
+/* =============================================================================================
+ * arrangement cache
+ * ============================================================================================= */
+
+// the signature of n planes has O(n^4) minors, which exceeds the cost of add_plane() on more planes
+static constexpr uint32_t max_cached_plane_count       = 6;
+// the arrangements are never evicted, so the cache stops growing once it is full
+static constexpr size_t   max_cached_arrangement_count = 1u << 16;
+
+struct arrangement_signature_hash_compare {
+    size_t hash(const arrangement_signature_t& signature) const noexcept
+    {
+        uint64_t hash = 0;
+        for (const auto& word : signature) hash = (hash ^ word) * 0x9e3779b97f4a7c15ull;
+        return static_cast<size_t>(hash ^ (hash >> 32));
+    }
+
+    bool equal(const arrangement_signature_t& lhs, const arrangement_signature_t& rhs) const noexcept { return lhs == rhs; }
+};
+
+class arrangement_cache_t
+{
+public:
+    using arrangement_ptr_t = std::shared_ptr<const compact_arrangement_t>;
+
+    // returns the arrangement of the planes, which is only computed by add_plane() the first time their signature is met
+    arrangement_ptr_t find_or_compute(const stl_vector_mp<plane_t>& planes)
+    {
+        arrangement_signature_t signature{};
+        const auto              permutation_index = compute_signature(planes, signature);
+        const auto&             vertices          = tet_vertex_permutations()[permutation_index].vertices;
+
+        // the arrangement mapped back by a permutation is cached under the signature tagged with the permutation
+        signature[0] |= static_cast<uint64_t>(permutation_index) << 32;
+        if (auto arrangement = find(signature)) {
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            return arrangement;
+        }
+
+        if (permutation_index == 0) return compute(planes, vertices, std::move(signature));
+
+        auto normalized_signature = signature;
+        normalized_signature[0]   = planes.size();
+        auto arrangement          = find(normalized_signature);
+        if (arrangement) {
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            arrangement = compute(planes, vertices, std::move(normalized_signature));
+        }
+
+        auto result = arrangement->decode();
+        restore_tet_vertex_permutation(vertices, result);
+        arrangement = std::make_shared<const compact_arrangement_t>(result);
+        insert(std::move(signature), arrangement);
+        return arrangement;
+    }
+
+    // the LUT lookups are counted here too, so that all the counters are read and cleared together
+    void add_lut_lookups(uint64_t hit_count, uint64_t miss_count) noexcept
+    {
+        if (hit_count != 0) m_lut_hits.fetch_add(hit_count, std::memory_order_relaxed);
+        if (miss_count != 0) m_lut_misses.fetch_add(miss_count, std::memory_order_relaxed);
+    }
+
+    arrangement_cache_counters_t counters() const noexcept
+    {
+        return {m_hits.load(std::memory_order_relaxed),
+                m_misses.load(std::memory_order_relaxed),
+                m_lut_hits.load(std::memory_order_relaxed),
+                m_lut_misses.load(std::memory_order_relaxed)};
+    }
+
+    // not safe to call concurrently with find_or_compute()
+    void clear()
+    {
+        m_arrangements.clear();
+        m_hits       = 0;
+        m_misses     = 0;
+        m_lut_hits   = 0;
+        m_lut_misses = 0;
+    }
+
+private:
+    using map_t = tbb::concurrent_hash_map<arrangement_signature_t,
+                                           arrangement_ptr_t,
+                                           arrangement_signature_hash_compare,
+                                           tbb::tbb_allocator<std::pair<const arrangement_signature_t, arrangement_ptr_t>>>;
+
+    arrangement_ptr_t find(const arrangement_signature_t& signature) const
+    {
+        map_t::const_accessor accessor{};
+        return m_arrangements.find(accessor, signature) ? accessor->second : arrangement_ptr_t{};
+    }
+
+    // the arrangement of the planes permuted to the ones of the signature, which is cached under it
+    arrangement_ptr_t compute(const stl_vector_mp<plane_t>&  planes,
+                              const std::array<uint32_t, 4>& vertices,
+                              arrangement_signature_t&&      signature)
+    {
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+
+        auto permuted_planes = planes;
+        for (auto& plane : permuted_planes) {
+            const auto original = plane;
+            for (uint32_t i = 0; i < 4; ++i) plane[i] = original[vertices[i]];
+        }
+        arrangement_builder builder(permuted_planes, false);
+        auto                arrangement = std::make_shared<const compact_arrangement_t>(builder.get_arrangement());
+        insert(std::move(signature), arrangement);
+        return arrangement;
+    }
+
+    // another thread may have inserted the same arrangement meanwhile
+    void insert(arrangement_signature_t&& signature, const arrangement_ptr_t& arrangement)
+    {
+        if (m_arrangements.size() < max_cached_arrangement_count) m_arrangements.insert({std::move(signature), arrangement});
+    }
+
+    map_t                 m_arrangements{};
+    std::atomic<uint64_t> m_hits{};
+    std::atomic<uint64_t> m_misses{};
+    std::atomic<uint64_t> m_lut_hits{};
+    std::atomic<uint64_t> m_lut_misses{};
+};
+
+static arrangement_cache_t arrangement_cache{};
+
+// the arrangement of planes that the LUT lacks
+static std::shared_ptr<const compact_arrangement_t> compute_untabulated_arrangement(const stl_vector_mp<plane_t>& planes)
+{
+    if (planes.size() < 3 || planes.size() > max_cached_plane_count)
+        return std::make_shared<const compact_arrangement_t>(arrangement_builder(planes, false).get_arrangement());
+    return arrangement_cache.find_or_compute(planes);
+}
+
+IA_API std::shared_ptr<const compact_arrangement_t> compute_shared_arrangement(const stl_vector_mp<plane_t>& planes)
+{
+    // the tabulated arrangements are cheaper to copy than the signature is to compute
+    arrangement_t arrangement{};
+    if (arrangement_builder::extract_from_lut(planes, arrangement)) {
+        arrangement_cache.add_lut_lookups(1, 0);
+        return std::make_shared<const compact_arrangement_t>(arrangement);
+    }
+
+    arrangement_cache.add_lut_lookups(0, 1);
+    return compute_untabulated_arrangement(planes);
+}
+
+IA_API arrangement_cache_counters_t get_arrangement_cache_counters() { return arrangement_cache.counters(); }
+
+IA_API void clear_arrangement_cache() { arrangement_cache.clear(); }
+
+/* =============================================================================================
+ * batches of tets
+ * ============================================================================================= */
+
+IA_API void compute_shared_arrangements(uint32_t                                           num_planes,
+                                        span<const double>                                 coefficients,
+                                        span<std::shared_ptr<const compact_arrangement_t>> results)
+{
+    const size_t tet_count = results.size();
+    assert(num_planes > 0 && coefficients.size() == 4 * num_planes * tet_count);
+
+    // the outer indices of the whole batch are computed in one pass over the coefficients, or are invalid for planes that
+    // the LUT never tabulates
+    stl_vector_mp<uint32_t> outer_indices(tet_count, INVALID_INDEX);
+    if (!ia_lut.empty() && (num_planes < 3 || (num_planes == 3 && !ia_lut.three_plane_symmetries.empty())))
+        ia_compute_outer_indices(num_planes, coefficients, outer_indices);
+
+    // the arrangements of 2 planes are looked up for the whole batch too, so that their orientations are computed at once
+    stl_vector_mp<uint32_t> lut_indices{};
+    if (num_planes == 2) {
+        lut_indices.resize(tet_count);
+        ia_compute_two_plane_lut_indices(coefficients, outer_indices, lut_indices);
+    }
+
+    // the tets of a batch with the same tabulated arrangement and symmetry share it
+    flat_hash_map_mp<uint64_t, std::shared_ptr<const compact_arrangement_t>> tabulated_arrangements{};
+    stl_vector_mp<plane_t>                                                   planes(num_planes);
+    uint64_t                                                                 lut_miss_count = 0;
+    for (size_t t = 0; t < tet_count; ++t) {
+        for (uint32_t j = 0; j < num_planes; ++j)
+            for (uint32_t i = 0; i < 4; ++i) planes[j][i] = coefficients[(4 * j + i) * tet_count + t];
+
+        uint32_t   symmetry  = ia_identity_symmetry;
+        const auto lut_index = lut_indices.empty()
+                                   ? arrangement_builder::lookup(outer_indices[t], planes.data(), num_planes, symmetry)
+                                   : lut_indices[t];
+        if (lut_index == INVALID_INDEX) {
+            lut_miss_count++;
+            results[t] = compute_untabulated_arrangement(planes);
+            continue;
+        }
+
+        auto& arrangement = tabulated_arrangements[static_cast<uint64_t>(lut_index) << 32 | symmetry];
+        if (!arrangement) {
+            arrangement_t tabulated{};
+            ia_lut.extract(lut_index, tabulated);
+            if (symmetry != ia_identity_symmetry) ia_restore_symmetry(symmetry, tabulated);
+            arrangement = std::make_shared<const compact_arrangement_t>(tabulated);
+        }
+        results[t] = arrangement;
+    }
+    arrangement_cache.add_lut_lookups(tet_count - lut_miss_count, lut_miss_count);
+}
\ No newline at end of file
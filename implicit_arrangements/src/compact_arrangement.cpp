@@ -0,0 +1,106 @@
+#include <algorithm>
+
+#include <implicit_arrangement.hpp>
+
+IA_API compact_arrangement_t::compact_arrangement_t(const arrangement_t& arrangement)
+{
+    m_vertex_count       = static_cast<uint32_t>(arrangement.vertices.size());
+    m_face_count         = static_cast<uint32_t>(arrangement.faces.size());
+    m_cell_count         = static_cast<uint32_t>(arrangement.cells.size());
+    m_plane_count        = static_cast<uint32_t>(arrangement.unique_plane_indices.size());
+    m_unique_plane_count = static_cast<uint32_t>(arrangement.unique_planes.size());
+
+    // gathered at full width first, to find the width that holds the indices
+    static thread_local stl_vector_mp<uint32_t> indices{};
+    indices.clear();
+    for (const auto& vertex : arrangement.vertices) indices.insert(indices.end(), vertex.begin(), vertex.end());
+
+    m_face_offset = static_cast<uint32_t>(indices.size());
+    for (const auto& face : arrangement.faces) {
+        indices.emplace_back(face.supporting_plane);
+        indices.emplace_back(face.positive_cell);
+        indices.emplace_back(face.negative_cell);
+    }
+
+    m_face_vertex_offset = static_cast<uint32_t>(indices.size());
+    uint32_t offset      = 0;
+    indices.emplace_back(offset);
+    for (const auto& face : arrangement.faces) indices.emplace_back(offset += static_cast<uint32_t>(face.vertices.size()));
+    for (const auto& face : arrangement.faces) indices.insert(indices.end(), face.vertices.begin(), face.vertices.end());
+
+    m_cell_face_offset = static_cast<uint32_t>(indices.size());
+    offset             = 0;
+    indices.emplace_back(offset);
+    for (const auto& cell : arrangement.cells) indices.emplace_back(offset += static_cast<uint32_t>(cell.faces.size()));
+    for (const auto& cell : arrangement.cells) indices.insert(indices.end(), cell.faces.begin(), cell.faces.end());
+
+    m_unique_plane_offset = static_cast<uint32_t>(indices.size());
+    if (m_plane_count != 0) {
+        indices.insert(indices.end(), arrangement.unique_plane_indices.begin(), arrangement.unique_plane_indices.end());
+        offset = 0;
+        indices.emplace_back(offset);
+        for (const auto& planes : arrangement.unique_planes)
+            indices.emplace_back(offset += static_cast<uint32_t>(planes.size()));
+        for (const auto& planes : arrangement.unique_planes) indices.insert(indices.end(), planes.begin(), planes.end());
+        for (const auto orientation : arrangement.unique_plane_orientations) indices.emplace_back(orientation ? 1 : 0);
+    }
+
+    // the largest value of the width is left to INVALID_INDEX
+    uint32_t max_index = 0;
+    for (const auto index : indices)
+        if (index != INVALID_INDEX) max_index = std::max(max_index, index);
+    m_index_size = max_index < UINT8_MAX ? 1 : (max_index < UINT16_MAX ? 2 : 4);
+
+    m_data.resize(indices.size() * m_index_size);
+    switch (m_index_size) {
+        case 1:
+            std::transform(indices.begin(), indices.end(), m_data.begin(), [](uint32_t index) {
+                return index == INVALID_INDEX ? UINT8_MAX : static_cast<uint8_t>(index);
+            });
+            break;
+        case 2:
+            for (size_t i = 0; i < indices.size(); ++i) {
+                const auto value = indices[i] == INVALID_INDEX ? UINT16_MAX : static_cast<uint16_t>(indices[i]);
+                std::memcpy(m_data.data() + 2 * i, &value, sizeof(value));
+            }
+            break;
+        default: std::memcpy(m_data.data(), indices.data(), m_data.size()); break;
+    }
+}
+
+// the index ranges only have input iterators, from which vector::assign would grow the vector one index at a time
+static void assign_indices(stl_vector_mp<uint32_t>& indices, const compact_arrangement_t::index_range_t& range)
+{
+    indices.resize(range.size());
+    std::copy(range.begin(), range.end(), indices.begin());
+}
+
+IA_API arrangement_t compact_arrangement_t::decode() const
+{
+    arrangement_t result{};
+    result.vertices.reserve(m_vertex_count);
+    for (const auto vertex : vertices()) result.vertices.emplace_back(vertex);
+
+    result.faces.resize(m_face_count);
+    for (uint32_t i = 0; i < m_face_count; ++i) {
+        const auto face       = this->face(i);
+        auto&      descriptor = result.faces[i];
+        assign_indices(descriptor.vertices, face.vertices);
+        descriptor.supporting_plane = face.supporting_plane;
+        descriptor.positive_cell    = face.positive_cell;
+        descriptor.negative_cell    = face.negative_cell;
+    }
+
+    result.cells.resize(m_cell_count);
+    for (uint32_t i = 0; i < m_cell_count; ++i) assign_indices(result.cells[i].faces, cell(i).faces);
+
+    if (m_plane_count != 0) {
+        assign_indices(result.unique_plane_indices, unique_plane_indices());
+        result.unique_planes.resize(m_unique_plane_count);
+        for (uint32_t i = 0; i < m_unique_plane_count; ++i) assign_indices(result.unique_planes[i], unique_plane(i));
+        for (const auto orientation : unique_plane_orientations())
+            result.unique_plane_orientations.emplace_back(orientation != 0);
+    }
+
+    return result;
+}
\ No newline at end of file
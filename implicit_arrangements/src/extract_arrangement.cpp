@@ -2,26 +2,27 @@
 #include "ia_structure.hpp"
 #include "robust_assert.hpp"
 
-arrangement_t extract_arrangement(ia_complex_t&& ia_complex)
+arrangement_t extract_arrangement(const ia_complex_t& ia_complex)
 {
     arrangement_t ia{};
-    ia.vertices = std::move(ia_complex.vertices);
+    ia.vertices.assign(ia_complex.vertices.begin(), ia_complex.vertices.end());
 
-    auto&  edges     = ia_complex.edges;
-    auto&  faces     = ia_complex.faces;
-    size_t num_faces = faces.size();
+    const auto& edges     = ia_complex.edges;
+    const auto& faces     = ia_complex.faces;
+    size_t      num_faces = faces.size();
     ia.faces.resize(num_faces);
 
     for (size_t i = 0; i < num_faces; i++) {
-        auto&        cf           = faces[i];
+        const auto&  cf           = faces[i];
+        const auto   cf_edges     = ia_complex.edges_of(cf);
         auto&        f            = ia.faces[i];
-        const size_t num_bd_edges = cf.edges.size();
+        const size_t num_bd_edges = cf_edges.size();
         ROBUST_ASSERT(num_bd_edges >= 3);
         f.vertices.reserve(num_bd_edges);
 
         for (size_t j = 0; j < num_bd_edges; j++) {
-            auto& curr_e = edges[cf.edges[j]];
-            auto& next_e = edges[cf.edges[(j + 1) % num_bd_edges]];
+            const auto& curr_e = edges[cf_edges[j]];
+            const auto& next_e = edges[cf_edges[(j + 1) % num_bd_edges]];
             if (curr_e.vertices[0] == next_e.vertices[0] || curr_e.vertices[0] == next_e.vertices[1]) {
                 f.vertices.emplace_back(curr_e.vertices[0]);
             } else {
@@ -35,14 +36,13 @@ arrangement_t extract_arrangement(ia_complex_t&& ia_complex)
         f.supporting_plane = cf.supporting_plane;
     }
 
-    auto&  cells     = ia_complex.cells;
-    size_t num_cells = cells.size();
+    const auto& cells     = ia_complex.cells;
+    size_t      num_cells = cells.size();
     ia.cells.resize(num_cells);
 
     for (size_t i = 0; i < num_cells; i++) {
-        auto& cc = cells[i];
-        auto& c  = ia.cells[i];
-        c.faces  = std::move(cc.faces);
+        const auto cc_faces = ia_complex.faces_of(cells[i]);
+        ia.cells[i].faces.assign(cc_faces.begin(), cc_faces.end());
     }
 
     return ia;
@@ -76,4 +76,33 @@ int8_t ia_cut_0_face(const plane_group_t& planes, const ia_complex_t& ia_complex
     return signof(orient3d(p0.data(), p1.data(), p2.data(), p.data()));
 }
 
+void ia_cut_0_faces(const plane_group_t&   planes,
+                    ia_complex_t&          ia_complex,
+                    uint32_t               plane_index,
+                    stl_vector_mp<int8_t>& orientations)
+{
+    // coefficient k of the j-th plane of vertex v is values[(4 * j + k) * num_vertices + v], the inserted plane last
+    const auto num_vertices = static_cast<uint32_t>(ia_complex.vertices.size());
+    const auto p            = planes.get_plane(plane_index);
+    auto&      values       = ia_complex.vertex_plane_values;
+    values.resize(16 * static_cast<size_t>(num_vertices));
+    for (uint32_t vid = 0; vid < num_vertices; ++vid) {
+        const auto& v = ia_complex.vertices[vid];
+        for (uint32_t j = 0; j < 3; ++j) {
+            const auto plane = planes.get_plane(v[j]);
+            for (uint32_t k = 0; k < 4; ++k) values[(4 * j + k) * num_vertices + vid] = plane[k];
+        }
+        for (uint32_t k = 0; k < 4; ++k) values[(12 + k) * num_vertices + vid] = p[k];
+    }
+
+    std::array<const double*, 16> rows{};
+    for (uint32_t r = 0; r < 16; ++r) rows[r] = values.data() + static_cast<size_t>(r) * num_vertices;
+    auto& vertex_orientations = ia_complex.vertex_orientations;
+    vertex_orientations.resize(num_vertices);
+    orient3d_batch(num_vertices, rows.data(), rows.data() + 4, rows.data() + 8, rows.data() + 12, vertex_orientations.data());
+
+    orientations.clear();
+    for (const auto o : vertex_orientations) orientations.emplace_back(signof(o));
+}
+
 #endif
\ No newline at end of file
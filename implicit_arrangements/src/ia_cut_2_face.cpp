@@ -16,12 +16,14 @@ std::array<uint32_t, 3> ia_cut_2_face(ia_complex_t&
     edges.reserve(edges.size() + 1);
     faces.reserve(faces.size() + 2);
 
-    auto&        f                  = faces[fid];
-    const size_t num_boundary_edges = f.edges.size();
+    const auto   f                  = faces[fid];
+    const auto   f_edges            = ia_complex.edges_of(f);
+    const size_t num_boundary_edges = f_edges.size();
 
-    stl_vector_mp<uint32_t> positive_subedges{}, negative_subedges{};
-    positive_subedges.reserve(num_boundary_edges);
-    negative_subedges.reserve(num_boundary_edges);
+    auto& positive_subedges = ia_complex.positive_subelements;
+    auto& negative_subedges = ia_complex.negative_subelements;
+    positive_subedges.clear();
+    negative_subedges.clear();
 
     ia_edge_t cut_edge;
     uint32_t  cut_edge_index             = INVALID_INDEX;
@@ -30,8 +32,8 @@ std::array<uint32_t, 3> ia_cut_2_face(ia_complex_t&
     uint32_t  cut_edge_negative_location = INVALID_INDEX;
 
     auto get_end_vertex = [&](uint32_t local_eid) {
-        auto        curr_eid = f.edges[local_eid];
-        auto        next_eid = f.edges[(local_eid + 1) % num_boundary_edges];
+        auto        curr_eid = f_edges[local_eid];
+        auto        next_eid = f_edges[(local_eid + 1) % num_boundary_edges];
         const auto& e0       = edges[curr_eid];
         const auto& e1       = edges[next_eid];
         if (e0.vertices[0] == e1.vertices[0] || e0.vertices[0] == e1.vertices[1]) {
@@ -43,7 +45,7 @@ std::array<uint32_t, 3> ia_cut_2_face(ia_complex_t&
     };
 
     for (size_t j = 0; j < num_boundary_edges; j++) {
-        const auto eid = f.edges[j];
+        const auto eid = f_edges[j];
 
         bool last_positive      = false;
         bool last_negative      = false;
@@ -126,12 +128,17 @@ std::array<uint32_t, 3> ia_cut_2_face(ia_complex_t&
                                                                          negative_subedges.begin() + cut_edge_negative_location,
                                                                          negative_subedges.end());
     }
+    auto& face_edges = ia_complex.face_edges;
     positive_subedges.emplace_back(cut_edge_index);
-    positive_subface.edges = std::move(positive_subedges);
-    ROBUST_ASSERT(positive_subface.edges.size() > 2);
+    positive_subface.edge_offset = static_cast<uint32_t>(face_edges.size());
+    positive_subface.edge_count  = static_cast<uint32_t>(positive_subedges.size());
+    face_edges.insert(face_edges.end(), positive_subedges.begin(), positive_subedges.end());
+    ROBUST_ASSERT(positive_subface.edge_count > 2);
     negative_subedges.emplace_back(cut_edge_index);
-    negative_subface.edges = std::move(negative_subedges);
-    ROBUST_ASSERT(negative_subface.edges.size() > 2);
+    negative_subface.edge_offset = static_cast<uint32_t>(face_edges.size());
+    negative_subface.edge_count  = static_cast<uint32_t>(negative_subedges.size());
+    face_edges.insert(face_edges.end(), negative_subedges.begin(), negative_subedges.end());
+    ROBUST_ASSERT(negative_subface.edge_count > 2);
 
     faces.emplace_back(std::move(positive_subface));
     faces.emplace_back(std::move(negative_subface));
@@ -14,34 +14,34 @@ std::array<uint32_t, 3> ia_cut_3_face(ia_complex_t&
     auto& faces = ia_complex.faces;
     auto& cells = ia_complex.cells;
 
-    const auto& cell               = cells[cid];
-    const auto  num_boundary_faces = cell.faces.size();
-
-    uint32_t                cut_face_id = INVALID_INDEX;
-    stl_vector_mp<uint32_t> positive_subfaces{};
-    stl_vector_mp<uint32_t> negative_subfaces{};
-    stl_vector_mp<uint32_t> cut_edges{};
-    stl_vector_mp<bool>     cut_edge_orientations{};
-    positive_subfaces.reserve(num_boundary_faces + 1);
-    negative_subfaces.reserve(num_boundary_faces + 1);
-    cut_edges.reserve(num_boundary_faces);
-    cut_edge_orientations.reserve(num_boundary_faces);
+    const auto cell = cells[cid];
+
+    uint32_t cut_face_id           = INVALID_INDEX;
+    auto&    positive_subfaces     = ia_complex.positive_subelements;
+    auto&    negative_subfaces     = ia_complex.negative_subelements;
+    auto&    cut_edges             = ia_complex.cut_edges;
+    auto&    cut_edge_orientations = ia_complex.cut_edge_orientations;
+    positive_subfaces.clear();
+    negative_subfaces.clear();
+    cut_edges.clear();
+    cut_edge_orientations.clear();
 
     auto compute_cut_edge_orientation = [&](uint32_t fid, const std::array<uint32_t, 3>& subface) -> bool {
         ROBUST_ASSERT(subface[2] != INVALID_INDEX);
-        const auto& f = faces[fid];
-        bool        s = cell.signs[f.supporting_plane];
+        const auto& f       = faces[fid];
+        const auto  f_edges = ia_complex.edges_of(f);
+        bool        s       = ia_complex.sign_of(cell, f.supporting_plane);
 
         if (subface[0] == INVALID_INDEX || subface[1] == INVALID_INDEX) {
             // Intersection edge is on the boundary of the face.
             auto itr =
-                algorithm::find<algorithm::ExecutionPolicySelector::simd_only>(f.edges.begin(), f.edges.end(), subface[2]);
-            ROBUST_ASSERT(itr != f.edges.end());
-            size_t curr_i = itr - f.edges.begin();
-            size_t next_i = (curr_i + 1) % f.edges.size();
+                algorithm::find<algorithm::ExecutionPolicySelector::simd_only>(f_edges.begin(), f_edges.end(), subface[2]);
+            ROBUST_ASSERT(itr != f_edges.end());
+            size_t curr_i = itr - f_edges.begin();
+            size_t next_i = (curr_i + 1) % f_edges.size();
 
-            const auto& curr_e = edges[f.edges[curr_i]];
-            const auto& next_e = edges[f.edges[next_i]];
+            const auto& curr_e = edges[f_edges[curr_i]];
+            const auto& next_e = edges[f_edges[next_i]];
             bool        edge_is_consistent_with_face =
                 (curr_e.vertices[1] == next_e.vertices[0] || curr_e.vertices[1] == next_e.vertices[1]);
 
@@ -56,7 +56,7 @@ std::array<uint32_t, 3> ia_cut_3_face(ia_complex_t&
         }
     };
 
-    for (auto fid : cell.faces) {
+    for (auto fid : ia_complex.faces_of(cell)) {
         const auto& subface = subfaces[fid];
         if (subface[0] == INVALID_INDEX && subface[1] == INVALID_INDEX) { cut_face_id = fid; }
         if (subface[0] != INVALID_INDEX) { positive_subfaces.emplace_back(subface[0]); }
@@ -71,10 +71,10 @@ std::array<uint32_t, 3> ia_cut_3_face(ia_complex_t&
         // The implicit function is identical over the whole cell.
         return {INVALID_INDEX, INVALID_INDEX, INVALID_INDEX};
     } else if (positive_subfaces.empty()) {
-        cells[cid].signs[plane_index] = false;
+        ia_complex.sign_of(cell, plane_index) = false;
         return {INVALID_INDEX, cid, cut_face_id};
     } else if (negative_subfaces.empty()) {
-        cells[cid].signs[plane_index] = true;
+        ia_complex.sign_of(cell, plane_index) = true;
         return {cid, INVALID_INDEX, cut_face_id};
     }
 
@@ -82,7 +82,8 @@ std::array<uint32_t, 3> ia_cut_3_face(ia_complex_t&
     {
         size_t num_cut_edges = cut_edges.size();
         ROBUST_ASSERT(num_cut_edges >= 3);
-        flat_hash_map_mp<uint32_t, uint32_t> v2e{};
+        auto& v2e = ia_complex.vertex_to_cut_edge;
+        v2e.clear();
         v2e.reserve(num_cut_edges);
         for (size_t i = 0; i < num_cut_edges; i++) {
             const auto  eid = cut_edges[i];
@@ -93,8 +94,8 @@ std::array<uint32_t, 3> ia_cut_3_face(ia_complex_t&
                 v2e[e.vertices[1]] = i;
             }
         }
-        stl_vector_mp<uint32_t> chained_cut_edges{};
-        chained_cut_edges.reserve(num_cut_edges);
+        auto& chained_cut_edges = ia_complex.chained_cut_edges;
+        chained_cut_edges.clear();
         chained_cut_edges.emplace_back(0u);
         while (chained_cut_edges.size() < num_cut_edges) {
             const uint32_t i   = chained_cut_edges.back();
@@ -115,29 +116,45 @@ std::array<uint32_t, 3> ia_cut_3_face(ia_complex_t&
 
     // Cross cut.
     ROBUST_ASSERT(!cut_edges.empty());
+    auto&     face_edges = ia_complex.face_edges;
     ia_face_t cut_face;
-    cut_face.edges            = std::move(cut_edges);
+    cut_face.edge_offset      = static_cast<uint32_t>(face_edges.size());
+    cut_face.edge_count       = static_cast<uint32_t>(cut_edges.size());
     cut_face.supporting_plane = plane_index;
+    face_edges.insert(face_edges.end(), cut_edges.begin(), cut_edges.end());
     faces.emplace_back(std::move(cut_face));
     cut_face_id = faces.size() - 1;
 
     // Generate positive and negative subcell.
+    auto&     cell_faces = ia_complex.cell_faces;
+    auto&     cell_signs = ia_complex.cell_signs;
     ia_cell_t positive_cell, negative_cell;
-    positive_cell.faces.reserve(positive_subfaces.size() + 1);
-    negative_cell.faces.reserve(negative_subfaces.size() + 1);
 
     positive_subfaces.emplace_back(cut_face_id);
-    positive_cell.faces              = std::move(positive_subfaces);
-    positive_cell.signs              = cell.signs;
-    positive_cell.signs[plane_index] = true;
+    positive_cell.face_offset = static_cast<uint32_t>(cell_faces.size());
+    positive_cell.face_count  = static_cast<uint32_t>(positive_subfaces.size());
+    cell_faces.insert(cell_faces.end(), positive_subfaces.begin(), positive_subfaces.end());
 
     negative_subfaces.emplace_back(cut_face_id);
-    negative_cell.faces              = std::move(negative_subfaces);
-    negative_cell.signs              = cell.signs;
-    negative_cell.signs[plane_index] = false;
+    negative_cell.face_offset = static_cast<uint32_t>(cell_faces.size());
+    negative_cell.face_count  = static_cast<uint32_t>(negative_subfaces.size());
+    cell_faces.insert(cell_faces.end(), negative_subfaces.begin(), negative_subfaces.end());
+
+    // the signs of both subcells are the ones of the cell, except for the plane
+    const auto sign_count     = ia_complex.sign_count;
+    positive_cell.sign_offset = static_cast<uint32_t>(cell_signs.size());
+    negative_cell.sign_offset = positive_cell.sign_offset + sign_count;
+    cell_signs.resize(cell_signs.size() + 2 * sign_count);
+    for (uint32_t i = 0; i < sign_count; ++i) {
+        const bool sign                           = cell_signs[cell.sign_offset + i];
+        cell_signs[positive_cell.sign_offset + i] = sign;
+        cell_signs[negative_cell.sign_offset + i] = sign;
+    }
+    ia_complex.sign_of(positive_cell, plane_index) = true;
+    ia_complex.sign_of(negative_cell, plane_index) = false;
 
-    cells.emplace_back(std::move(positive_cell));
-    cells.emplace_back(std::move(negative_cell));
+    cells.emplace_back(positive_cell);
+    cells.emplace_back(negative_cell);
     uint32_t positive_cell_id = static_cast<uint32_t>(cells.size() - 2);
     uint32_t negative_cell_id = static_cast<uint32_t>(cells.size() - 1);
 
@@ -149,10 +166,7 @@ std::array<uint32_t, 3> ia_cut_3_face(ia_complex_t&
         cut_f.positive_cell = positive_cell_id;
         cut_f.negative_cell = negative_cell_id;
 
-        auto& positive_c = cells[positive_cell_id];
-        auto& negative_c = cells[negative_cell_id];
-
-        for (auto fid : positive_c.faces) {
+        for (auto fid : ia_complex.faces_of(positive_cell)) {
             if (fid == cut_face_id) continue;
             auto& f = faces[fid];
             ROBUST_ASSERT(f.positive_cell == cid || f.negative_cell == cid);
@@ -162,7 +176,7 @@ std::array<uint32_t, 3> ia_cut_3_face(ia_complex_t&
                 f.negative_cell = positive_cell_id;
             }
         }
-        for (auto fid : negative_c.faces) {
+        for (auto fid : ia_complex.faces_of(negative_cell)) {
             if (fid == cut_face_id) continue;
             auto& f = faces[fid];
             ROBUST_ASSERT(f.positive_cell == cid || f.negative_cell == cid);
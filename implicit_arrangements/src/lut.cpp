@@ -1,72 +1,476 @@
+#include <algorithm>
 #include <bitset>
+#include <cstring>
 #include <fstream>
 #include <iomanip>
+#include <map>
+#include <memory>
+#include <random>
 
 #include <nlohmann/json.hpp>
 #include <tbb/tick_count.h>
+#include <memory/mapped_file.hpp>
 
 #include "lut.hpp"
+#include "arrangement_builder.hpp"
 #include "implicit_predicates.hpp"
 
+/* =============================================================================================
+ * flat file layout
+ * ============================================================================================= */
+
+// ia_lut.bin is a header followed by one aligned section per array of ia_lut_t, in declaration order
+static constexpr char     lut_file_magic[8]   = {'I', 'A', '_', 'L', 'U', 'T', '\0', '\0'};
+static constexpr uint32_t lut_file_version    = 2;
+static constexpr uint32_t lut_file_endian_tag = 0x01020304u;
+static constexpr uint64_t section_alignment   = 64;
+
+enum lut_section_t : uint32_t {
+    LUT_SECTION_START_INDICES,
+    LUT_SECTION_ARRANGEMENTS,
+    LUT_SECTION_VERTICES,
+    LUT_SECTION_FACES,
+    LUT_SECTION_FACE_VERTICES,
+    LUT_SECTION_CELL_FACE_OFFSETS,
+    LUT_SECTION_CELL_FACES,
+    LUT_SECTION_THREE_PLANE_SYMMETRIES,
+    LUT_SECTION_THREE_PLANE_START_INDICES,
+    LUT_SECTION_THREE_PLANE_INNER_INDICES,
+    LUT_SECTION_COUNT
+};
+
+struct lut_section_entry_t {
+    uint64_t offset{}; // in bytes, from the start of the file
+    uint64_t size{};   // in bytes
+};
+
+struct lut_file_header_t {
+    char                magic[8]{};
+    uint32_t            version{};
+    uint32_t            endian_tag{};
+    uint32_t            section_count{};
+    uint32_t            reserved{};
+    lut_section_entry_t sections[LUT_SECTION_COUNT]{};
+};
+
+static constexpr uint64_t lut_element_sizes[LUT_SECTION_COUNT] = {sizeof(uint32_t),
+                                                                  sizeof(ia_lut_arrangement_t),
+                                                                  sizeof(point_t),
+                                                                  sizeof(ia_lut_face_t),
+                                                                  sizeof(uint32_t),
+                                                                  sizeof(uint32_t),
+                                                                  sizeof(uint32_t),
+                                                                  sizeof(ia_lut_symmetry_t),
+                                                                  sizeof(uint32_t),
+                                                                  sizeof(uint32_t)};
+
+static_assert(std::is_trivially_copyable_v<lut_file_header_t> && std::is_trivially_copyable_v<ia_lut_face_t>);
+static_assert(sizeof(point_t) == 3 * sizeof(uint32_t) && sizeof(ia_lut_arrangement_t) == 3 * sizeof(uint32_t));
+
+// the sign bits of 3 planes at the 4 tet vertices resp. the permutations of the vertices and planes times the flipped planes
+static constexpr uint32_t three_plane_outer_count    = 1u << 12;
+static constexpr uint32_t three_plane_symmetry_count = 24 * 6 * 8;
+
+static inline uint64_t align_up(uint64_t value, uint64_t alignment) { return (value + alignment - 1) / alignment * alignment; }
+
 /* global variables */
-stl_vector_mp<arrangement_t> ia_data{};
-stl_vector_mp<uint32_t>      ia_indices{};
+ia_lut_t ia_lut{};
 
-IA_API bool load_lut()
+// the bytes ia_lut points into, i.e. either the mapped ia_lut.bin or the image flattened from the msgpack table
+static std::unique_ptr<mapped_file_t> lut_file{};
+static stl_vector_mp<char>            lut_image{};
+
+/* =============================================================================================
+ * flat table
+ * ============================================================================================= */
+
+void ia_lut_t::extract(uint32_t index, arrangement_t& result) const
 {
-    if (!ia_data.empty() && !ia_indices.empty()) return true;
+    assert(index + 1 < arrangements.size());
+    const auto& entry = arrangements[index];
+    const auto& next  = arrangements[index + 1];
 
-    auto t0 = tbb::tick_count::now();
+    result.vertices.assign(vertices.begin() + entry.vertex_offset, vertices.begin() + next.vertex_offset);
 
-    std::ifstream fin("ia_lut.msgpack", std::ios::in | std::ios::binary);
-    if (!fin) {
-        std::cout << "Simplicial arrangement lookup table file not exist!" << std::endl;
+    result.faces.resize(next.face_offset - entry.face_offset);
+    for (uint32_t i = 0; i < result.faces.size(); ++i) {
+        const auto& face        = faces[entry.face_offset + i];
+        const auto& next_face   = faces[entry.face_offset + i + 1];
+        auto&       result_face = result.faces[i];
+        result_face.vertices.assign(face_vertices.begin() + face.vertex_offset,
+                                    face_vertices.begin() + next_face.vertex_offset);
+        result_face.supporting_plane = face.supporting_plane;
+        result_face.positive_cell    = face.positive_cell;
+        result_face.negative_cell    = face.negative_cell;
+    }
+
+    result.cells.resize(next.cell_offset - entry.cell_offset);
+    for (uint32_t i = 0; i < result.cells.size(); ++i) {
+        const auto begin = cell_face_offsets[entry.cell_offset + i];
+        const auto end   = cell_face_offsets[entry.cell_offset + i + 1];
+        result.cells[i].faces.assign(cell_faces.begin() + begin, cell_faces.begin() + end);
+    }
+
+    result.unique_plane_indices.clear();
+    result.unique_planes.clear();
+    result.unique_plane_orientations.clear();
+}
+
+uint32_t ia_lut_t::find_three_planes(uint32_t outer_index, uint32_t inner_index) const
+{
+    assert(outer_index + 1 < three_plane_start_indices.size());
+    const auto first_index = three_plane_start_indices.front();
+    const auto begin       = three_plane_inner_indices.begin() + (three_plane_start_indices[outer_index] - first_index);
+    const auto end         = three_plane_inner_indices.begin() + (three_plane_start_indices[outer_index + 1] - first_index);
+
+    const auto iter = std::lower_bound(begin, end, inner_index);
+    if (iter == end || *iter != inner_index) return INVALID_INDEX;
+    return first_index + static_cast<uint32_t>(iter - three_plane_inner_indices.begin());
+}
+
+static uint32_t apply_symmetry_to_outer_index(uint32_t symmetry, uint32_t outer_index);
+
+// every offset table must be sorted and end at the size of the array it points into, so that extract() stays in range
+static inline bool validate_lut(const ia_lut_t& lut)
+{
+    if (lut.arrangements.empty() || lut.faces.empty() || lut.cell_face_offsets.empty()) return false;
+
+    const auto arrangement_count = static_cast<uint32_t>(lut.arrangements.size() - 1);
+    for (const auto& start_index : lut.start_indices)
+        if (start_index > arrangement_count) return false;
+
+    for (size_t i = 0; i + 1 < lut.arrangements.size(); ++i) {
+        const auto& entry = lut.arrangements[i];
+        const auto& next  = lut.arrangements[i + 1];
+        if (entry.vertex_offset > next.vertex_offset || entry.face_offset > next.face_offset
+            || entry.cell_offset > next.cell_offset)
+            return false;
+    }
+    for (size_t i = 0; i + 1 < lut.faces.size(); ++i)
+        if (lut.faces[i].vertex_offset > lut.faces[i + 1].vertex_offset) return false;
+    for (size_t i = 0; i + 1 < lut.cell_face_offsets.size(); ++i)
+        if (lut.cell_face_offsets[i] > lut.cell_face_offsets[i + 1]) return false;
+
+    const auto& sentinel = lut.arrangements.back();
+    if (lut.arrangements.front().vertex_offset != 0 || lut.arrangements.front().face_offset != 0
+        || lut.arrangements.front().cell_offset != 0 || sentinel.vertex_offset != lut.vertices.size()
+        || sentinel.face_offset != lut.faces.size() - 1 || sentinel.cell_offset != lut.cell_face_offsets.size() - 1
+        || lut.faces.back().vertex_offset != lut.face_vertices.size() || lut.cell_face_offsets.back() != lut.cell_faces.size())
         return false;
+
+    // the 3 plane table is optional, e.g. it is missing when flattened from the msgpack table
+    const auto& symmetries    = lut.three_plane_symmetries;
+    const auto& starts        = lut.three_plane_start_indices;
+    const auto& inner_indices = lut.three_plane_inner_indices;
+    if (symmetries.empty() && starts.empty() && inner_indices.empty()) return true;
+    if (symmetries.size() != three_plane_outer_count || starts.size() != three_plane_outer_count + 1) return false;
+
+    // every outer index must be mapped to the outer index of its representative
+    for (uint32_t outer_index = 0; outer_index < three_plane_outer_count; ++outer_index) {
+        const auto& [representative_outer_index, symmetry] = symmetries[outer_index];
+        if (symmetry >= three_plane_symmetry_count
+            || apply_symmetry_to_outer_index(symmetry, outer_index) != representative_outer_index)
+            return false;
     }
+
+    // and the inner indices of each outer index must be strictly increasing for the binary search
+    if (starts.front() > arrangement_count || starts.back() != arrangement_count
+        || inner_indices.size() != arrangement_count - starts.front())
+        return false;
+    for (uint32_t outer_index = 0; outer_index < three_plane_outer_count; ++outer_index) {
+        if (starts[outer_index] > starts[outer_index + 1]) return false;
+        for (auto i = starts[outer_index] + 1; i < starts[outer_index + 1]; ++i)
+            if (inner_indices[i - starts.front()] <= inner_indices[i - 1 - starts.front()]) return false;
+    }
+    return true;
+}
+
+template <typename T>
+static inline span<const T> section_view(const char* data, const lut_section_entry_t& section)
+{
+    return {reinterpret_cast<const T*>(data + section.offset), static_cast<size_t>(section.size / sizeof(T))};
+}
+
+// points ia_lut into an image of ia_lut.bin, which must stay alive as long as the table is used
+static bool bind_lut(const char* data, size_t size)
+{
+    lut_file_header_t header{};
+    if (data == nullptr || size < sizeof(header)) return false;
+    std::memcpy(&header, data, sizeof(header));
+
+    if (std::memcmp(header.magic, lut_file_magic, sizeof(lut_file_magic)) != 0) return false;
+    if (header.version != lut_file_version || header.endian_tag != lut_file_endian_tag) return false;
+    if (header.section_count != LUT_SECTION_COUNT) return false;
+    for (uint32_t i = 0; i < LUT_SECTION_COUNT; ++i) {
+        const auto& section = header.sections[i];
+        // the alignment check also keeps the typed views aligned, as mappings and heap blocks are aligned to 16 bytes
+        if (section.offset % section_alignment != 0 || section.size % lut_element_sizes[i] != 0) return false;
+        if (section.offset > size || section.size > size - section.offset) return false;
+    }
+
+    ia_lut_t lut{};
+    lut.start_indices     = section_view<uint32_t>(data, header.sections[LUT_SECTION_START_INDICES]);
+    lut.arrangements      = section_view<ia_lut_arrangement_t>(data, header.sections[LUT_SECTION_ARRANGEMENTS]);
+    lut.vertices          = section_view<point_t>(data, header.sections[LUT_SECTION_VERTICES]);
+    lut.faces             = section_view<ia_lut_face_t>(data, header.sections[LUT_SECTION_FACES]);
+    lut.face_vertices     = section_view<uint32_t>(data, header.sections[LUT_SECTION_FACE_VERTICES]);
+    lut.cell_face_offsets = section_view<uint32_t>(data, header.sections[LUT_SECTION_CELL_FACE_OFFSETS]);
+    lut.cell_faces        = section_view<uint32_t>(data, header.sections[LUT_SECTION_CELL_FACES]);
+
+    lut.three_plane_symmetries =
+        section_view<ia_lut_symmetry_t>(data, header.sections[LUT_SECTION_THREE_PLANE_SYMMETRIES]);
+    lut.three_plane_start_indices =
+        section_view<uint32_t>(data, header.sections[LUT_SECTION_THREE_PLANE_START_INDICES]);
+    lut.three_plane_inner_indices =
+        section_view<uint32_t>(data, header.sections[LUT_SECTION_THREE_PLANE_INNER_INDICES]);
+    if (!validate_lut(lut)) return false;
+
+    ia_lut = lut;
+    return true;
+}
+
+#ifdef IA_EMBED_LUT
+/* =============================================================================================
+ * embedded table
+ * ============================================================================================= */
+
+// the bytes of data/ia_lut.bin, generated by the embed_ia_lut build option (see implicit_arrangements/xmake.lua)
+alignas(section_alignment) static constexpr unsigned char embedded_lut[] = {
+#include "ia_lut_embedded.inc"
+};
+
+// bound during static initialization, so that lookups hit the table even if load_lut() is never called
+static const bool embedded_lut_bound = bind_lut(reinterpret_cast<const char*>(embedded_lut), sizeof(embedded_lut));
+#endif
+
+/* =============================================================================================
+ * building the table
+ * ============================================================================================= */
+
+// the arrays of ia_lut_t, while they are filled
+struct lut_builder_t {
+    stl_vector_mp<uint32_t>             start_indices{};
+    stl_vector_mp<ia_lut_arrangement_t> arrangements{};
+    stl_vector_mp<point_t>              vertices{};
+    stl_vector_mp<ia_lut_face_t>        faces{};
+    stl_vector_mp<uint32_t>             face_vertices{}, cell_face_offsets{}, cell_faces{};
+
+    stl_vector_mp<ia_lut_symmetry_t> three_plane_symmetries{};
+    stl_vector_mp<uint32_t>          three_plane_start_indices{}, three_plane_inner_indices{};
+
+    uint32_t arrangement_count() const noexcept { return static_cast<uint32_t>(arrangements.size()); }
+
+    void append(const arrangement_t& arrangement)
+    {
+        arrangements.emplace_back(ia_lut_arrangement_t{static_cast<uint32_t>(vertices.size()),
+                                                       static_cast<uint32_t>(faces.size()),
+                                                       static_cast<uint32_t>(cell_face_offsets.size())});
+        vertices.insert(vertices.end(), arrangement.vertices.begin(), arrangement.vertices.end());
+        for (const auto& face : arrangement.faces) {
+            faces.emplace_back(ia_lut_face_t{static_cast<uint32_t>(face_vertices.size()),
+                                             face.supporting_plane,
+                                             face.positive_cell,
+                                             face.negative_cell});
+            face_vertices.insert(face_vertices.end(), face.vertices.begin(), face.vertices.end());
+        }
+        for (const auto& cell : arrangement.cells) {
+            cell_face_offsets.emplace_back(static_cast<uint32_t>(cell_faces.size()));
+            cell_faces.insert(cell_faces.end(), cell.faces.begin(), cell.faces.end());
+        }
+    }
+
+    // closes the ranges of the last entries with the sentinels, and lays the arrays out like ia_lut.bin
+    void write_image(stl_vector_mp<char>& image)
+    {
+        arrangements.emplace_back(ia_lut_arrangement_t{static_cast<uint32_t>(vertices.size()),
+                                                       static_cast<uint32_t>(faces.size()),
+                                                       static_cast<uint32_t>(cell_face_offsets.size())});
+        faces.emplace_back(ia_lut_face_t{static_cast<uint32_t>(face_vertices.size())});
+        cell_face_offsets.emplace_back(static_cast<uint32_t>(cell_faces.size()));
+
+        lut_file_header_t header{};
+        std::memcpy(header.magic, lut_file_magic, sizeof(lut_file_magic));
+        header.version       = lut_file_version;
+        header.endian_tag    = lut_file_endian_tag;
+        header.section_count = LUT_SECTION_COUNT;
+
+        image.assign(sizeof(header), 0);
+        append_section(image, header.sections[LUT_SECTION_START_INDICES], start_indices);
+        append_section(image, header.sections[LUT_SECTION_ARRANGEMENTS], arrangements);
+        append_section(image, header.sections[LUT_SECTION_VERTICES], vertices);
+        append_section(image, header.sections[LUT_SECTION_FACES], faces);
+        append_section(image, header.sections[LUT_SECTION_FACE_VERTICES], face_vertices);
+        append_section(image, header.sections[LUT_SECTION_CELL_FACE_OFFSETS], cell_face_offsets);
+        append_section(image, header.sections[LUT_SECTION_CELL_FACES], cell_faces);
+        append_section(image, header.sections[LUT_SECTION_THREE_PLANE_SYMMETRIES], three_plane_symmetries);
+        append_section(image, header.sections[LUT_SECTION_THREE_PLANE_START_INDICES], three_plane_start_indices);
+        append_section(image, header.sections[LUT_SECTION_THREE_PLANE_INNER_INDICES], three_plane_inner_indices);
+        std::memcpy(image.data(), &header, sizeof(header));
+    }
+
+private:
+    template <typename T>
+    static void append_section(stl_vector_mp<char>& image, lut_section_entry_t& section, const stl_vector_mp<T>& values)
+    {
+        section = {align_up(image.size(), section_alignment), values.size() * sizeof(T)};
+        image.resize(section.offset + section.size);
+        if (!values.empty()) std::memcpy(image.data() + section.offset, values.data(), section.size);
+    }
+};
+
+// parses the 1 and 2 plane arrangements of the msgpack table; returns false if the file cannot be read
+static bool parse_msgpack_lut(const char* msgpack_path, lut_builder_t& builder)
+{
+    std::ifstream fin(msgpack_path, std::ios::in | std::ios::binary);
+    if (!fin) return false;
     stl_vector_mp<char> msgpack(std::istreambuf_iterator<char>(fin), {});
-    nlohmann::json      json = nlohmann::json::from_msgpack(msgpack);
     fin.close();
 
-    const auto deserialize_ar = [](const nlohmann::json& entry) {
+    try {
+        const auto json       = nlohmann::json::from_msgpack(msgpack);
+        builder.start_indices = json["start_index"].get<stl_vector_mp<uint32_t>>();
+
         arrangement_t ia{};
-        ia.vertices = entry[0].get<stl_vector_mp<point_t>>();
-        assert(ia.vertices.size() > 0);
-
-        ia.faces.reserve(entry[1].size());
-        for (const auto& face_entry : entry[1]) {
-            arrangement_t::face_descriptor f{};
-            f.vertices         = face_entry[0].get<stl_vector_mp<uint32_t>>();
-            f.supporting_plane = face_entry[1].get<uint32_t>();
-            f.positive_cell    = face_entry[2].get<uint32_t>();
-            f.negative_cell    = face_entry[3].get<uint32_t>();
-            ia.faces.push_back(std::move(f));
+        for (const auto& entry : json["data"]) {
+            ia.vertices = entry[0].get<stl_vector_mp<point_t>>();
+            ia.faces.resize(entry[1].size());
+            for (size_t i = 0; i < ia.faces.size(); ++i) {
+                const auto& face_entry = entry[1][i];
+                auto&       f          = ia.faces[i];
+                f.vertices             = face_entry[0].get<stl_vector_mp<uint32_t>>();
+                f.supporting_plane     = face_entry[1].get<uint32_t>();
+                f.positive_cell        = face_entry[2].get<uint32_t>();
+                f.negative_cell        = face_entry[3].get<uint32_t>();
+            }
+            ia.cells.resize(entry[2].size());
+            for (size_t i = 0; i < ia.cells.size(); ++i) ia.cells[i].faces = entry[2][i].get<stl_vector_mp<uint32_t>>();
+            builder.append(ia);
+        }
+    } catch (const nlohmann::json::exception&) {
+        return false;
+    }
+    return true;
+}
+
+// the sampling stops after this many samples, or once no new case turned up for the stable count of samples in a row
+static constexpr uint64_t three_plane_max_sample_count    = 1ull << 26;
+static constexpr uint64_t three_plane_stable_sample_count = 1ull << 22;
+
+// the generic cases of 3 planes are sampled with a fixed seed; cases never sampled keep using add_plane() at runtime
+static void tabulate_three_planes(lut_builder_t& builder)
+{
+    // the representative of an outer index is the smallest outer index any symmetry maps it to
+    builder.three_plane_symmetries.resize(three_plane_outer_count);
+    for (uint32_t outer_index = 0; outer_index < three_plane_outer_count; ++outer_index) {
+        auto& representative = builder.three_plane_symmetries[outer_index];
+        representative       = {static_cast<uint16_t>(outer_index), static_cast<uint16_t>(ia_identity_symmetry)};
+        for (uint32_t symmetry = 0; symmetry < three_plane_symmetry_count; ++symmetry) {
+            const auto image = apply_symmetry_to_outer_index(symmetry, outer_index);
+            if (image < representative.outer_index)
+                representative = {static_cast<uint16_t>(image), static_cast<uint16_t>(symmetry)};
         }
-        assert(ia.faces.size() > 0);
+    }
+
+    std::map<uint64_t, arrangement_t>      cases{}; // (representative outer index, inner index) -> arrangement
+    std::mt19937_64                        random_engine{};
+    std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+    uint64_t                               sample_count{}, last_new_case{};
+    for (; sample_count < three_plane_max_sample_count && sample_count - last_new_case < three_plane_stable_sample_count;
+         ++sample_count) {
+        std::array<plane_t, 3> planes{};
+        for (auto& plane : planes)
+            for (auto& value : plane) value = distribution(random_engine);
+
+        const auto outer_index = ia_compute_outer_index(planes[0], planes[1], planes[2]);
+        if (outer_index == INVALID_INDEX) continue;
+        const auto [representative_outer_index, symmetry] = builder.three_plane_symmetries[outer_index];
+        const auto representative = ia_apply_symmetry(symmetry, planes[0], planes[1], planes[2]);
+        const auto inner_index =
+            ia_compute_inner_index(representative_outer_index, representative[0], representative[1], representative[2]);
+        if (inner_index == INVALID_INDEX) continue;
 
-        ia.cells.reserve(entry[2].size());
-        for (const auto& cell_entry : entry[2]) {
-            arrangement_t::cell_descriptor c{};
-            c.faces = cell_entry.get<stl_vector_mp<uint32_t>>();
-            ia.cells.push_back(std::move(c));
+        const auto key = (static_cast<uint64_t>(representative_outer_index) << 32) | inner_index;
+        if (cases.find(key) != cases.end()) continue;
+        arrangement_builder case_builder(stl_vector_mp<plane_t>(representative.begin(), representative.end()), false);
+        cases.emplace(key, std::move(case_builder).export_arrangement());
+        last_new_case = sample_count;
+    }
+
+    // the cases are sorted by outer index first, so that each outer index gets a sorted range of inner indices
+    auto iter = cases.begin();
+    for (uint32_t outer_index = 0; outer_index <= three_plane_outer_count; ++outer_index) {
+        builder.three_plane_start_indices.emplace_back(builder.arrangement_count());
+        for (; iter != cases.end() && (iter->first >> 32) == outer_index; ++iter) {
+            builder.three_plane_inner_indices.emplace_back(static_cast<uint32_t>(iter->first));
+            builder.append(iter->second);
         }
-        assert(ia.cells.size() > 0);
+    }
 
-        return ia;
-    };
+    std::cout << "Tabulated " << cases.size() << " cases of 3 planes from " << sample_count << " samples." << std::endl;
+}
+
+/* =============================================================================================
+ * APIs
+ * ============================================================================================= */
 
-    ia_indices = json["start_index"].get<stl_vector_mp<uint32_t>>();
-    ia_data.reserve(json["data"].size());
-    for (const auto& entry : json["data"]) { ia_data.emplace_back(deserialize_ar(entry)); }
+IA_API bool load_lut()
+{
+#ifdef IA_EMBED_LUT
+    // the table is compiled in, so there is neither a file to look up nor anything to parse
+    return embedded_lut_bound;
+#else
+    if (!ia_lut.empty()) return true;
+
+    // the flat table is used in place, so there is nothing to do but mapping it
+    auto file = std::make_unique<mapped_file_t>("ia_lut.bin", file_access_pattern_t::random);
+    if (bind_lut(file->data(), file->size())) {
+        lut_file = std::move(file);
+        return true;
+    }
+
+    auto t0 = tbb::tick_count::now();
+
+    lut_builder_t builder{};
+    if (!parse_msgpack_lut("ia_lut.msgpack", builder)) {
+        std::cout << "Simplicial arrangement lookup table file not exist!" << std::endl;
+        return false;
+    }
+    builder.write_image(lut_image);
+    if (!bind_lut(lut_image.data(), lut_image.size())) return false;
 
     auto t1 = tbb::tick_count::now();
-    std::cout << "Loading LUT took " << std::fixed << std::setprecision(10) << (t1 - t0).seconds() << " seconds." << std::endl;
+    std::cout << "Loading LUT took " << std::fixed << std::setprecision(10) << (t1 - t0).seconds()
+              << " seconds, generate ia_lut.bin to skip parsing." << std::endl;
 
     return true;
+#endif
+}
+
+IA_API bool generate_lut(const char* msgpack_path, const char* binary_path)
+{
+    lut_builder_t builder{};
+    if (!parse_msgpack_lut(msgpack_path, builder)) return false;
+    tabulate_three_planes(builder);
+
+    stl_vector_mp<char> image{};
+    builder.write_image(image);
+
+    // the image is checked like a loaded one, but without binding it
+    const auto saved_lut = ia_lut;
+    const auto valid     = bind_lut(image.data(), image.size());
+    ia_lut               = saved_lut;
+    if (!valid) return false;
+
+    std::ofstream out(binary_path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    out.write(image.data(), static_cast<std::streamsize>(image.size()));
+    return static_cast<bool>(out.flush());
 }
 
 IA_API void lut_print_test()
 {
-    const auto& ia = ia_data[0];
+    arrangement_t ia{};
+    ia_lut.extract(0, ia);
     std::cout << "num_vertices: " << ia.vertices.size() << std::endl;
     std::cout << "num_faces: " << ia.faces.size() << std::endl;
     std::cout << "num_cells: " << ia.cells.size() << std::endl;
@@ -125,6 +529,22 @@ uint32_t ia_compute_outer_index(const plane_t& p0, const plane_t& p1)
     return index;
 }
 
+// the inner index of 2 planes from the signs of orient1d on the edges that both planes cross, set in the bits of index
+static uint32_t two_plane_inner_index(size_t index, size_t edge_count)
+{
+    if (edge_count == 4) {
+        assert(index != 6 && index != 9); // Impossible cases.
+        if (index < 6) {
+        } else if (index < 9) {
+            index -= 1;                   // Skipping INVALID_INDEX case with index 6.
+        } else {
+            index -= 2;                   // Skipping INVALID_INDEX case with index 6 and 9.
+        }
+    }
+
+    return static_cast<uint32_t>(index);
+}
+
 uint32_t ia_compute_inner_index(uint32_t outer_index, const plane_t& p0, const plane_t& p1)
 {
     std::bitset<2> v0 = outer_index & 3;
@@ -160,15 +580,276 @@ uint32_t ia_compute_inner_index(uint32_t outer_index, const plane_t& p0, const p
     if ((v2 ^ v3).all())
         if (!add_edge(2, 3)) return INVALID_INDEX;
 
-    if (edge_count == 4) {
-        assert(index != 6 && index != 9); // Impossible cases.
-        if (index < 6) {
-        } else if (index < 9) {
-            index -= 1;                   // Skipping INVALID_INDEX case with index 6.
-        } else {
-            index -= 2;                   // Skipping INVALID_INDEX case with index 6 and 9.
+    return two_plane_inner_index(index, edge_count);
+}
+
+uint32_t ia_compute_outer_index(const plane_t& p0, const plane_t& p1, const plane_t& p2)
+{
+    // Planes must not intersect tet at vertices.
+    const std::array<const plane_t*, 3> planes = {&p0, &p1, &p2};
+
+    uint32_t index = 0;
+    for (uint32_t i = 0; i < 4; ++i) {
+        for (uint32_t j = 0; j < 3; ++j) {
+            const auto value = (*planes[j])[i];
+            if (value == 0) return INVALID_INDEX;
+            if (value > 0) index |= 1u << (3 * i + j);
         }
     }
 
     return index;
+}
+
+uint32_t ia_compute_inner_index(uint32_t outer_index, const plane_t& p0, const plane_t& p1, const plane_t& p2)
+{
+    static constexpr uint32_t edges[6][2]      = {{0, 1}, {0, 2}, {0, 3}, {1, 2}, {1, 3}, {2, 3}};
+    static constexpr uint32_t faces[4][3]      = {{1, 2, 3}, {0, 2, 3}, {0, 1, 3}, {0, 1, 2}}; // opposite to vertex 0..3
+    static constexpr uint32_t face_edges[4][3] = {{3, 4, 5}, {1, 2, 5}, {0, 2, 4}, {0, 1, 3}};
+    // the pairs of planes (a, b) with a < b, at index a + b - 1, and the third plane
+    static constexpr uint32_t pairs[3][3] = {{0, 1, 2}, {0, 2, 1}, {1, 2, 0}};
+
+    const std::array<const plane_t*, 3> planes = {&p0, &p1, &p2};
+
+    const auto is_positive = [&](uint32_t plane, uint32_t vertex) -> bool {
+        return (outer_index >> (3 * vertex + plane)) & 1;
+    };
+    const auto crosses = [&](uint32_t plane, uint32_t edge) {
+        return is_positive(plane, edges[edge][0]) != is_positive(plane, edges[edge][1]);
+    };
+
+    size_t index     = 0;
+    size_t bit_count = 0;
+
+    // HINT: with the vertex signs, the order of the zero crossings on the edges and the side of the third plane at the
+    // intersections of the other two on the faces determine the arrangement, unless one of them is degenerate
+    std::array<std::array<bool, 3>, 6> crossing_orders{}; // sign of b at the crossing of a, for the pairs on each edge
+    for (uint32_t e = 0; e < 6; ++e) {
+        const auto [i, j] = edges[e];
+        for (uint32_t p = 0; p < 3; ++p) {
+            const auto a = pairs[p][0], b = pairs[p][1];
+            if (!crosses(a, e) || !crosses(b, e)) continue;
+
+            const double pa[2] = {(*planes[a])[i], (*planes[a])[j]};
+            const double pb[2] = {(*planes[b])[i], (*planes[b])[j]};
+            const auto   s     = orient1d(pa, pb);
+            if (s == orientation::zero || s == orientation::invalid) return INVALID_INDEX;
+
+            crossing_orders[e][p] = s == orientation::positive;
+            if (crossing_orders[e][p]) index |= (1 << bit_count);
+            bit_count++;
+        }
+    }
+
+    // whether plane b is positive at the zero crossing of plane a on edge e
+    const auto sign_at_crossing = [&](uint32_t b, uint32_t a, uint32_t e) -> bool {
+        const auto [i, j] = edges[e];
+        if (!crosses(b, e)) return is_positive(b, i);
+        if (a < b) return crossing_orders[e][a + b - 1];
+        // b crosses the edge before a iff a has the sign of vertex i at the crossing of b
+        const bool b_first = crossing_orders[e][a + b - 1] == is_positive(a, i);
+        return b_first ? is_positive(b, j) : is_positive(b, i);
+    };
+
+    for (uint32_t f = 0; f < 4; ++f) {
+        const auto [i, j, k] = faces[f];
+        for (uint32_t p = 0; p < 3; ++p) {
+            const auto a = pairs[p][0], b = pairs[p][1], c = pairs[p][2];
+
+            // the zero crossings of a and b intersect on this face iff b changes sign between the two edges a crosses
+            std::array<bool, 2> signs_of_b{};
+            uint32_t            crossing_count = 0;
+            for (const auto e : face_edges[f])
+                if (crosses(a, e)) signs_of_b[crossing_count++] = sign_at_crossing(b, a, e);
+            if (crossing_count != 2 || signs_of_b[0] == signs_of_b[1]) continue;
+
+            const double pa[3] = {(*planes[a])[i], (*planes[a])[j], (*planes[a])[k]};
+            const double pb[3] = {(*planes[b])[i], (*planes[b])[j], (*planes[b])[k]};
+            const double pc[3] = {(*planes[c])[i], (*planes[c])[j], (*planes[c])[k]};
+            const auto   s     = orient2d(pa, pb, pc);
+            if (s == orientation::zero || s == orientation::invalid) return INVALID_INDEX;
+
+            if (s == orientation::positive) index |= (1 << bit_count);
+            bit_count++;
+        }
+    }
+
+    return static_cast<uint32_t>(index);
+}
+
+void ia_compute_outer_indices(uint32_t num_planes, span<const double> coefficients, span<uint32_t> outer_indices)
+{
+    assert(num_planes >= 1 && num_planes <= 3);
+    const size_t tet_count = outer_indices.size();
+    assert(coefficients.size() == 4 * num_planes * tet_count);
+
+    // one row per coefficient of a plane over all the tets; a zero coefficient sets the top bit, above every outer index
+    static constexpr uint32_t degenerate_bit = 31;
+
+    uint32_t* indices = outer_indices.data();
+    std::fill_n(indices, tet_count, 0u);
+    for (uint32_t j = 0; j < num_planes; ++j) {
+        for (uint32_t i = 0; i < 4; ++i) {
+            // the bits of a single plane are the ones of the first of 2 planes
+            const uint32_t bit = num_planes == 1 ? 2 * i : num_planes * i + j;
+            const double*  row = coefficients.data() + (4 * j + i) * tet_count;
+            for (size_t t = 0; t < tet_count; ++t)
+                indices[t] |= static_cast<uint32_t>(row[t] > 0) << bit | static_cast<uint32_t>(row[t] == 0) << degenerate_bit;
+        }
+    }
+    for (size_t t = 0; t < tet_count; ++t)
+        if (indices[t] >> degenerate_bit) indices[t] = INVALID_INDEX;
+}
+
+void ia_compute_two_plane_lut_indices(span<const double>   coefficients,
+                                      span<const uint32_t> outer_indices,
+                                      span<uint32_t>       lut_indices)
+{
+    static constexpr uint32_t edges[6][2] = {{0, 1}, {0, 2}, {0, 3}, {1, 2}, {1, 3}, {2, 3}};
+
+    const size_t tet_count = outer_indices.size();
+    assert(coefficients.size() == 8 * tet_count && lut_indices.size() == tet_count);
+
+    const auto& start_indices = ia_lut.start_indices;
+
+    // only the outer indices with several tabulated arrangements need an inner index
+    const auto is_ambiguous = [&](uint32_t outer_index) {
+        return outer_index != INVALID_INDEX && start_indices[outer_index + 1] > start_indices[outer_index] + 1;
+    };
+    // both planes change sign along the edge iff both bits of its endpoints differ
+    const auto is_crossed = [](uint32_t outer_index, uint32_t i, uint32_t j) {
+        return (((outer_index >> (2 * i)) ^ (outer_index >> (2 * j))) & 3) == 3;
+    };
+
+    // the orient1d inputs of the whole batch are gathered first, then consumed in the same order
+    std::array<stl_vector_mp<double>, 4> values{};
+    for (size_t t = 0; t < tet_count; ++t) {
+        const auto outer_index = outer_indices[t];
+        if (!is_ambiguous(outer_index)) continue;
+
+        for (const auto [i, j] : edges) {
+            if (!is_crossed(outer_index, i, j)) continue;
+            values[0].emplace_back(coefficients[i * tet_count + t]);
+            values[1].emplace_back(coefficients[j * tet_count + t]);
+            values[2].emplace_back(coefficients[(4 + i) * tet_count + t]);
+            values[3].emplace_back(coefficients[(4 + j) * tet_count + t]);
+        }
+    }
+
+    stl_vector_mp<orientation> orientations(values[0].size());
+    const double*              f0[2] = {values[0].data(), values[1].data()};
+    const double*              f1[2] = {values[2].data(), values[3].data()};
+    orient1d_batch(static_cast<uint32_t>(orientations.size()), f0, f1, orientations.data());
+
+    auto next_orientation = orientations.begin();
+    for (size_t t = 0; t < tet_count; ++t) {
+        const auto outer_index = outer_indices[t];
+        if (!is_ambiguous(outer_index)) {
+            // as in arrangement_builder::lookup(), an outer index without arrangement is not tabulated
+            if (outer_index == INVALID_INDEX || start_indices[outer_index + 1] == start_indices[outer_index])
+                lut_indices[t] = INVALID_INDEX;
+            else
+                lut_indices[t] = start_indices[outer_index];
+            continue;
+        }
+
+        size_t index = 0, edge_count = 0;
+        bool   is_degenerate = false;
+        for (const auto [i, j] : edges) {
+            if (!is_crossed(outer_index, i, j)) continue;
+
+            const auto s = *next_orientation++;
+            if (s == orientation::zero || s == orientation::invalid) is_degenerate = true;
+            if (s == orientation::positive) index |= (1 << edge_count);
+            edge_count++;
+        }
+        if (is_degenerate) {
+            lut_indices[t] = INVALID_INDEX;
+            continue;
+        }
+
+        const auto inner_index = two_plane_inner_index(index, edge_count);
+        assert(inner_index < start_indices[outer_index + 1] - start_indices[outer_index]);
+        lut_indices[t] = start_indices[outer_index] + inner_index;
+    }
+}
+
+/* =============================================================================================
+ * symmetries of 3 planes
+ * ============================================================================================= */
+
+// all permutations of the tet vertices resp. the planes, in lexicographic order
+static constexpr std::array<std::array<uint32_t, 4>, 24> vertex_permutations = {
+    {{0, 1, 2, 3}, {0, 1, 3, 2}, {0, 2, 1, 3}, {0, 2, 3, 1}, {0, 3, 1, 2}, {0, 3, 2, 1},
+     {1, 0, 2, 3}, {1, 0, 3, 2}, {1, 2, 0, 3}, {1, 2, 3, 0}, {1, 3, 0, 2}, {1, 3, 2, 0},
+     {2, 0, 1, 3}, {2, 0, 3, 1}, {2, 1, 0, 3}, {2, 1, 3, 0}, {2, 3, 0, 1}, {2, 3, 1, 0},
+     {3, 0, 1, 2}, {3, 0, 2, 1}, {3, 1, 0, 2}, {3, 1, 2, 0}, {3, 2, 0, 1}, {3, 2, 1, 0}}
+};
+static constexpr std::array<std::array<uint32_t, 3>, 6> plane_permutations = {
+    {{0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0}}
+};
+
+// HINT: symmetry = (vertex permutation * 6 + plane permutation) * 8 + flips, mapping the planes p to q with
+// q[j][i] = p[planes[j]][vertices[i]], negated if bit j of the flips is set
+struct symmetry_t {
+    const std::array<uint32_t, 4>& vertices;
+    const std::array<uint32_t, 3>& planes;
+    uint32_t                       flips{};
+};
+
+static inline symmetry_t decode_symmetry(uint32_t symmetry)
+{
+    assert(symmetry < three_plane_symmetry_count);
+    return {vertex_permutations[symmetry / 48], plane_permutations[symmetry / 8 % 6], symmetry % 8};
+}
+
+static uint32_t apply_symmetry_to_outer_index(uint32_t symmetry, uint32_t outer_index)
+{
+    const auto [vertices, planes, flips] = decode_symmetry(symmetry);
+
+    uint32_t index = 0;
+    for (uint32_t i = 0; i < 4; ++i) {
+        for (uint32_t j = 0; j < 3; ++j) {
+            const bool is_positive = (outer_index >> (3 * vertices[i] + planes[j])) & 1;
+            if (is_positive != static_cast<bool>((flips >> j) & 1)) index |= 1u << (3 * i + j);
+        }
+    }
+    return index;
+}
+
+std::array<plane_t, 3> ia_apply_symmetry(uint32_t symmetry, const plane_t& p0, const plane_t& p1, const plane_t& p2)
+{
+    const auto [vertices, planes, flips]          = decode_symmetry(symmetry);
+    const std::array<const plane_t*, 3> originals = {&p0, &p1, &p2};
+
+    std::array<plane_t, 3> result{};
+    for (uint32_t j = 0; j < 3; ++j) {
+        const auto& original = *originals[planes[j]];
+        for (uint32_t i = 0; i < 4; ++i) result[j][i] = (flips >> j) & 1 ? -original[vertices[i]] : original[vertices[i]];
+    }
+    return result;
+}
+
+void ia_restore_symmetry(uint32_t symmetry, arrangement_t& arrangement)
+{
+    const auto [vertices, planes, flips] = decode_symmetry(symmetry);
+
+    // plane i < 4 of the representative is the tet boundary opposite to vertex vertices[i], and plane 4 + j is plane
+    // 4 + planes[j], flipped if bit j of the flips is set
+    const auto restore_plane = [&](uint32_t plane) { return plane < 4 ? vertices[plane] : 4 + planes[plane - 4]; };
+
+    // an odd permutation of the tet vertices mirrors the tet
+    uint32_t inversion_count = 0;
+    for (uint32_t i = 0; i < 4; ++i)
+        for (uint32_t j = i + 1; j < 4; ++j) inversion_count += vertices[i] > vertices[j];
+    const bool is_mirrored = inversion_count % 2 == 1;
+
+    for (auto& vertex : arrangement.vertices)
+        for (auto& plane : vertex) plane = restore_plane(plane);
+    for (auto& face : arrangement.faces) {
+        const auto is_flipped = face.supporting_plane >= 4 && ((flips >> (face.supporting_plane - 4)) & 1);
+        face.supporting_plane = restore_plane(face.supporting_plane);
+        if (is_flipped) std::swap(face.positive_cell, face.negative_cell);
+        // the vertices are ordered counterclockwise seen from the positive side of the supporting plane
+        if (is_flipped != is_mirrored) std::reverse(face.vertices.begin(), face.vertices.end());
+    }
 }
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+
+#include <implicit_predicates.hpp>
+#include <timer/scoped_timer.hpp>
+
+#include "describe_arrangement.hpp"
+
+// checks the batched arrangements of tets with 1 to 5 planes against the ones of single tets, and compares their timings
+// usage: implicit_arrangements.batch.performance_test
+
+static constexpr uint32_t tet_count       = 100'000;
+static constexpr uint32_t max_plane_count = 5;
+
+int main()
+{
+    labelled_timers_manager timer{};
+    std::mt19937_64         random_engine{};
+
+    if (!load_lut()) {
+        std::cerr << "Error: failed to load the lookup table" << std::endl;
+        return 1;
+    }
+
+    // the timers keep the labels, so they are literals
+    static constexpr const char* single_labels[max_plane_count] = {"1 plane (single tets)",
+                                                                   "2 planes (single tets)",
+                                                                   "3 planes (single tets)",
+                                                                   "4 planes (single tets)",
+                                                                   "5 planes (single tets)"};
+    static constexpr const char* batch_labels[max_plane_count]  = {"1 plane (batch)",
+                                                                   "2 planes (batch)",
+                                                                   "3 planes (batch)",
+                                                                   "4 planes (batch)",
+                                                                   "5 planes (batch)"};
+
+    // random values, with a few small integers among them for degenerate planes that the LUT lacks
+    std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+    std::uniform_int_distribution<int32_t> value_distribution(-2, 2), degenerate_distribution(0, 15);
+    for (uint32_t plane_count = 1; plane_count <= max_plane_count; ++plane_count) {
+        std::vector<stl_vector_mp<plane_t>> samples{};
+        while (samples.size() < tet_count) {
+            const bool             is_degenerate = degenerate_distribution(random_engine) == 0;
+            stl_vector_mp<plane_t> planes(plane_count);
+            for (auto& plane : planes)
+                for (auto& value : plane) value = is_degenerate ? value_distribution(random_engine) : distribution(random_engine);
+            if (!std::all_of(planes.begin(), planes.end(), is_active)) continue;
+
+            // some degenerate planes are too degenerate for add_plane(), which throws on them
+            if (is_degenerate) {
+                try {
+                    compute_arrangement(planes);
+                } catch (const std::runtime_error&) {
+                    continue;
+                }
+            }
+            samples.emplace_back(std::move(planes));
+        }
+
+        stl_vector_mp<double> coefficients(4 * plane_count * tet_count);
+        for (uint32_t t = 0; t < tet_count; ++t)
+            for (uint32_t j = 0; j < plane_count; ++j)
+                for (uint32_t i = 0; i < 4; ++i) coefficients[(4 * j + i) * tet_count + t] = samples[t][j][i];
+
+        // both start from an empty cache of the arrangements of 3 or more planes
+        std::vector<std::shared_ptr<const compact_arrangement_t>> references{};
+        references.reserve(tet_count);
+        clear_arrangement_cache();
+        timer.push_timer(single_labels[plane_count - 1]);
+        for (const auto& planes : samples) references.emplace_back(compute_shared_arrangement(planes));
+        timer.pop_timer(single_labels[plane_count - 1]);
+
+        std::vector<std::shared_ptr<const compact_arrangement_t>> results(tet_count);
+        clear_arrangement_cache();
+        reset_predicate_filter_counters();
+        timer.push_timer(batch_labels[plane_count - 1]);
+        compute_shared_arrangements(plane_count, coefficients, results);
+        timer.pop_timer(batch_labels[plane_count - 1]);
+
+        // the counters stay zero unless built with the implicit_predicates_stage_stats option
+        const auto counters = get_predicate_filter_counters();
+        if (counters.filtered != 0)
+            std::cout << plane_count << " plane(s): " << counters.filtered << " determinants, " << counters.interval
+                      << " past the filter, " << counters.exact << " exact" << std::endl;
+
+        uint32_t mismatch_count{};
+        for (uint32_t t = 0; t < tet_count; ++t)
+            if (describe(*references[t]) != describe(*results[t])) mismatch_count++;
+        if (mismatch_count != 0) {
+            std::cerr << "Error: " << mismatch_count << " of " << tet_count << " batched arrangements of " << plane_count
+                      << " planes differ from the ones of single tets" << std::endl;
+            return 1;
+        }
+    }
+    timer.print();
+
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+
+#include <timer/scoped_timer.hpp>
+
+#include "describe_arrangement.hpp"
+
+// checks the cached arrangements of 3 or more planes against add_plane(), and compares their timings
+// usage: implicit_arrangements.cache.performance_test
+
+static constexpr uint32_t generic_base_count      = 64;
+static constexpr uint32_t generic_copy_count      = 1'000;
+static constexpr uint32_t degenerate_sample_count = 64'000;
+
+int main()
+{
+    labelled_timers_manager timer{};
+    std::mt19937_64         random_engine{};
+
+    // the same generic planes of 4 functions met again in other tets, i.e. with permuted tet vertices and rescaled values
+    std::vector<stl_vector_mp<plane_t>>    generic_samples{};
+    std::uniform_real_distribution<double> distribution(-1.0, 1.0), scale_distribution(0.5, 2.0);
+    for (uint32_t i = 0; i < generic_base_count; ++i) {
+        stl_vector_mp<plane_t> planes(4);
+        do {
+            for (auto& plane : planes)
+                for (auto& value : plane) value = distribution(random_engine);
+        } while (!std::all_of(planes.begin(), planes.end(), is_active));
+
+        for (uint32_t j = 0; j < generic_copy_count; ++j) {
+            std::array<uint32_t, 4> vertices = {0, 1, 2, 3};
+            std::shuffle(vertices.begin(), vertices.end(), random_engine);
+
+            stl_vector_mp<plane_t> copy(planes.size());
+            for (size_t k = 0; k < planes.size(); ++k) {
+                const auto scale = scale_distribution(random_engine);
+                for (uint32_t l = 0; l < 4; ++l) copy[k][l] = scale * planes[k][vertices[l]];
+            }
+            generic_samples.emplace_back(std::move(copy));
+        }
+    }
+    std::shuffle(generic_samples.begin(), generic_samples.end(), random_engine);
+
+    // 3 to 5 functions with small integer values, i.e. with zero predicates and duplicate planes that the LUT lacks, which
+    // rarely repeat. Some of them are too degenerate for add_plane(), which throws on them whether they are cached or not
+    std::vector<stl_vector_mp<plane_t>>    degenerate_samples{};
+    std::uniform_int_distribution<int32_t> value_distribution(-2, 2), count_distribution(3, 5);
+    while (degenerate_samples.size() < degenerate_sample_count) {
+        stl_vector_mp<plane_t> planes(count_distribution(random_engine));
+        for (auto& plane : planes)
+            for (auto& value : plane) value = value_distribution(random_engine);
+        if (!std::all_of(planes.begin(), planes.end(), is_active)) continue;
+
+        try {
+            compute_arrangement(planes);
+        } catch (const std::runtime_error&) {
+            continue;
+        }
+        degenerate_samples.emplace_back(std::move(planes));
+    }
+
+    if (!load_lut()) {
+        std::cerr << "Error: failed to load the lookup table" << std::endl;
+        return 1;
+    }
+
+    // the timers keep the labels, which are thus literals
+    const auto check_samples = [&](const std::vector<stl_vector_mp<plane_t>>& samples,
+                                   const char*                                add_plane_label,
+                                   const char*                                cache_label) {
+        std::vector<arrangement_t> references{};
+        references.reserve(samples.size());
+        timer.push_timer(add_plane_label);
+        for (const auto& planes : samples) references.emplace_back(compute_arrangement(planes));
+        timer.pop_timer(add_plane_label);
+
+        std::vector<std::shared_ptr<const compact_arrangement_t>> results{};
+        results.reserve(samples.size());
+        timer.push_timer(cache_label);
+        for (const auto& planes : samples) results.emplace_back(compute_shared_arrangement(planes));
+        timer.pop_timer(cache_label);
+
+        uint32_t mismatch_count{};
+        for (size_t i = 0; i < samples.size(); ++i)
+            if (describe(references[i]) != describe(*results[i])) mismatch_count++;
+        if (mismatch_count != 0) {
+            std::cerr << "Error: " << mismatch_count << " of " << samples.size() << " arrangements of " << cache_label
+                      << " differ from add_plane()" << std::endl;
+            return false;
+        }
+        return true;
+    };
+    if (!check_samples(generic_samples, "repeated generic planes (add_plane)", "repeated generic planes (cache)")) return 1;
+    if (!check_samples(degenerate_samples, "degenerate planes (add_plane)", "degenerate planes (cache)")) return 1;
+
+    const auto counters = get_arrangement_cache_counters();
+    std::cout << "cache hits: " << counters.hits << ", misses: " << counters.misses << std::endl;
+    timer.print();
+
+    return 0;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <implicit_arrangement.hpp>
+
+// a plane crosses the tet unless its values at the 4 vertices all have the same sign, as only the planes of active
+// functions are passed to the arrangements
+inline bool is_active(const plane_t& plane)
+{
+    const auto positive_count = std::count_if(plane.begin(), plane.end(), [](double value) { return value > 0; });
+    const auto negative_count = std::count_if(plane.begin(), plane.end(), [](double value) { return value < 0; });
+    return positive_count < 4 && negative_count < 4;
+}
+
+// describes an arrangement independently of the order of its vertices, faces and cells: a vertex by its sorted planes, a
+// face by its supporting plane, its vertex loop (starting at the smallest vertex, keeping the orientation) and its cells,
+// and a cell by its sorted faces
+inline std::string describe(const arrangement_t& arrangement)
+{
+    std::vector<std::string> vertex_keys{}, face_keys{}, cell_keys{}, face_records{};
+    for (auto planes : arrangement.vertices) {
+        std::sort(planes.begin(), planes.end());
+        vertex_keys.emplace_back(std::to_string(planes[0]) + "." + std::to_string(planes[1]) + "." + std::to_string(planes[2]));
+    }
+    for (const auto& face : arrangement.faces) {
+        std::vector<std::string> loop{};
+        for (const auto& vertex : face.vertices) loop.emplace_back(vertex_keys[vertex]);
+        std::rotate(loop.begin(), std::min_element(loop.begin(), loop.end()), loop.end());
+
+        auto key = std::to_string(face.supporting_plane) + "[";
+        for (const auto& vertex_key : loop) key += vertex_key + " ";
+        face_keys.emplace_back(key + "]");
+    }
+    for (const auto& cell : arrangement.cells) {
+        std::vector<std::string> faces{};
+        for (const auto& face : cell.faces) faces.emplace_back(face_keys[face]);
+        std::sort(faces.begin(), faces.end());
+
+        std::string key = "{";
+        for (const auto& face_key : faces) key += face_key;
+        cell_keys.emplace_back(key + "}");
+    }
+
+    const auto cell_key = [&](uint32_t cell) { return cell == INVALID_INDEX ? std::string("-") : cell_keys[cell]; };
+    for (size_t i = 0; i < arrangement.faces.size(); ++i) {
+        const auto& face = arrangement.faces[i];
+        face_records.emplace_back(face_keys[i] + " +" + cell_key(face.positive_cell) + " -" + cell_key(face.negative_cell));
+    }
+    std::sort(face_records.begin(), face_records.end());
+
+    std::string description{};
+    for (const auto& record : face_records) description += record + "\n";
+
+    // the duplicate planes by their sorted sets, and whether each plane is oriented like the smallest one of its set
+    std::vector<std::string> unique_plane_records{};
+    for (auto planes : arrangement.unique_planes) {
+        std::sort(planes.begin(), planes.end());
+        std::string key = "=";
+        for (const auto& plane : planes) {
+            const bool is_consistent = arrangement.unique_plane_orientations[plane] ==
+                                       arrangement.unique_plane_orientations[planes.front()];
+            key += " " + std::to_string(plane) + (is_consistent ? "+" : "-");
+        }
+        unique_plane_records.emplace_back(key);
+    }
+    std::sort(unique_plane_records.begin(), unique_plane_records.end());
+    for (const auto& record : unique_plane_records) description += record + "\n";
+    return description;
+}
+
+// the compact arrangements are described by the arrangement_t that they encode
+inline std::string describe(const compact_arrangement_t& arrangement) { return describe(arrangement.decode()); }
\ No newline at end of file
@@ -0,0 +1,60 @@
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+#include <timer/scoped_timer.hpp>
+
+#include "describe_arrangement.hpp"
+
+// checks the tabulated 3 plane arrangements against add_plane(), and compares their timings
+// usage: implicit_arrangements.LUT.three_plane_test
+// HINT: the references are computed before load_lut(), so the test is only meaningful without embed_ia_lut
+
+static constexpr uint32_t sample_count = 100'000;
+
+int main()
+{
+    labelled_timers_manager timer{};
+
+    // planes crossing the tet, as they are passed for the active functions of a tet
+    std::vector<stl_vector_mp<plane_t>>    samples{};
+    std::mt19937_64                        random_engine{};
+    std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+    while (samples.size() < sample_count) {
+        stl_vector_mp<plane_t> planes(3);
+        for (auto& plane : planes)
+            for (auto& value : plane) value = distribution(random_engine);
+
+        if (std::all_of(planes.begin(), planes.end(), is_active)) samples.emplace_back(std::move(planes));
+    }
+
+    std::vector<arrangement_t> references{};
+    references.reserve(sample_count);
+    timer.push_timer("3 planes (add_plane)");
+    for (const auto& planes : samples) references.emplace_back(compute_arrangement(planes));
+    timer.pop_timer("3 planes (add_plane)");
+
+    if (!load_lut()) {
+        std::cerr << "Error: failed to load the lookup table" << std::endl;
+        return 1;
+    }
+
+    std::vector<arrangement_t> results{};
+    results.reserve(sample_count);
+    timer.push_timer("3 planes (LUT)");
+    for (const auto& planes : samples) results.emplace_back(compute_arrangement(planes));
+    timer.pop_timer("3 planes (LUT)");
+
+    uint32_t mismatch_count{};
+    for (uint32_t i = 0; i < sample_count; ++i)
+        if (describe(references[i]) != describe(results[i])) mismatch_count++;
+    if (mismatch_count != 0) {
+        std::cerr << "Error: " << mismatch_count << " of " << sample_count << " arrangements differ from add_plane()"
+                  << std::endl;
+        return 1;
+    }
+    timer.print();
+
+    return 0;
+}
\ No newline at end of file
@@ -1,11 +1,39 @@
 add_requires("nlohmann_json")
 
+-- compiles data/ia_lut.bin into the library, so that no LUT file has to be shipped next to the binaries
+option("embed_ia_lut")
+    set_default(false)
+    set_description("Embed the arrangement lookup table into implicit_arrangements")
+option_end()
+
 internal_library("implicit_arrangements", "IA", os.scriptdir())
     add_rules("config.indirect_predicates.flags")
     add_deps("implicit_predicates", "shared_module")
     add_packages("nlohmann_json")
+    on_config(function (target)
+        if not has_config("embed_ia_lut") then return end
+
+        -- the table is included as a list of byte literals, regenerated only when ia_lut.bin changes
+        local lutfile = path.join(os.projectdir(), "data", "ia_lut.bin")
+        local outputdir = path.join(target:autogendir(), "embedded_lut")
+        local outputfile = path.join(outputdir, "ia_lut_embedded.inc")
+        if not os.isfile(outputfile) or os.mtime(outputfile) < os.mtime(lutfile) then
+            local data = io.readfile(lutfile, {encoding = "binary"})
+            local lines = {}
+            for offset = 1, #data, 32 do
+                local bytes = {string.byte(data, offset, math.min(offset + 31, #data))}
+                table.insert(lines, table.concat(bytes, ",") .. ",")
+            end
+            os.mkdir(outputdir)
+            io.writefile(outputfile, table.concat(lines, "\n") .. "\n")
+        end
+        target:add("includedirs", outputdir)
+        target:add("defines", "IA_EMBED_LUT")
+    end)
     after_build(function (target)
+        if has_config("embed_ia_lut") then return end
         os.cp(path.join(os.projectdir(), "data", "ia_lut.msgpack"), target:targetdir())
+        os.cp(path.join(os.projectdir(), "data", "ia_lut.bin"), target:targetdir())
     end)
 
 target("implicit_arrangements.LUT.load_test")
@@ -13,4 +41,32 @@ target("implicit_arrangements.LUT.load_test")
     add_rules("config.indirect_predicates.flags")
     add_deps("implicit_arrangements")
     add_files("./test_lut/main.cpp")
+target_end()
+
+target("implicit_arrangements.LUT.three_plane_test")
+    set_kind("binary")
+    add_rules("config.indirect_predicates.flags")
+    add_deps("implicit_arrangements")
+    add_files("./test_lut/three_plane_test.cpp")
+target_end()
+
+target("implicit_arrangements.cache.performance_test")
+    set_kind("binary")
+    add_rules("config.indirect_predicates.flags")
+    add_deps("implicit_arrangements")
+    add_files("./test_lut/cache_test.cpp")
+target_end()
+
+target("implicit_arrangements.batch.performance_test")
+    set_kind("binary")
+    add_rules("config.indirect_predicates.flags")
+    add_deps("implicit_arrangements")
+    add_files("./test_lut/batch_test.cpp")
+target_end()
+
+target("implicit_arrangements.LUT.generate")
+    set_kind("binary")
+    add_rules("config.indirect_predicates.flags")
+    add_deps("implicit_arrangements")
+    add_files("./lut_generator/main.cpp")
 target_end()
\ No newline at end of file
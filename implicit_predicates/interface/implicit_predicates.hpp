@@ -100,4 +100,57 @@ EXTERN_C IP_API orientation orient3d_nonrobust(const double f0[4], const double
 EXTERN_C IP_API orientation
     orient4d(const double f0[5], const double f1[5], const double f2[5], const double f3[5], const double f4[5]);
 EXTERN_C IP_API orientation
-    orient4d_nonrobust(const double f0[5], const double f1[5], const double f2[5], const double f3[5], const double f4[5]);
\ No newline at end of file
+    orient4d_nonrobust(const double f0[5], const double f1[5], const double f2[5], const double f3[5], const double f4[5]);
+
+/**
+ * Compute the sign of the determinant of the matrix whose rows are the given
+ * function values, i.e. the exact sign that the orientations above are built
+ * from, without normalizing it by the sign of their denominator.
+ *
+ * @returns POSITIVE, NEGATIVE or ZERO, never INVALID.
+ */
+EXTERN_C IP_API orientation det2_sign(const double f0[2], const double f1[2]);
+EXTERN_C IP_API orientation det3_sign(const double f0[3], const double f1[3], const double f2[3]);
+EXTERN_C IP_API orientation det4_sign(const double f0[4], const double f1[4], const double f2[4], const double f3[4]);
+
+/**
+ * Batch versions of orient1d, orient2d and orient3d, which compute the orientations of count instances at once, with
+ * the same results. The function values are given as structure of arrays: the value of function i at corner k of instance
+ * n is fi[k][n]. The floating-point filters of consecutive instances are evaluated together in SIMD lanes where the build
+ * enables AVX2, and the instances they cannot certify fall back to the exact stages one at a time.
+ *
+ * @param[in]  count         Number of instances.
+ * @param[out] orientations  Orientation of each instance, as returned by the scalar predicate.
+ */
+EXTERN_C IP_API void
+    orient1d_batch(uint32_t count, const double* const f0[2], const double* const f1[2], orientation* orientations);
+EXTERN_C IP_API void orient2d_batch(uint32_t            count,
+                                    const double* const f0[3],
+                                    const double* const f1[3],
+                                    const double* const f2[3],
+                                    orientation*        orientations);
+EXTERN_C IP_API void orient3d_batch(uint32_t            count,
+                                    const double* const f0[4],
+                                    const double* const f1[4],
+                                    const double* const f2[4],
+                                    const double* const f3[4],
+                                    orientation*        orientations);
+
+/**
+ * Number of determinant evaluations of the robust predicates above that reached each stage. Every determinant is first
+ * evaluated in floating point under a semi-static error bound, which certifies the sign of almost all of them; only the
+ * uncertain ones fall back to interval arithmetic, and then to exact expansions.
+ */
+struct predicate_filter_counters_t {
+    uint64_t filtered; ///< Evaluations, all of which start with the floating-point filter.
+    uint64_t interval; ///< Evaluations whose sign the filter could not certify.
+    uint64_t exact;    ///< Evaluations whose sign interval arithmetic could not certify either.
+};
+
+/**
+ * The counters are kept per thread and summed over all threads, including the ones that exited, when they are read. A
+ * reset concurrent with predicate evaluations may miss some of them. They are only counted when the library is built with
+ * the implicit_predicates_stage_stats option, and read as zero otherwise.
+ */
+EXTERN_C IP_API predicate_filter_counters_t get_predicate_filter_counters();
+EXTERN_C IP_API void                        reset_predicate_filter_counters();
\ No newline at end of file
@@ -1,9 +1,94 @@
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cassert>
+#include <mutex>
 #include <type_traits>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 #include <implicit_predicates.hpp>
 
+/* =============================================================================================
+ * filter statistics
+ * ============================================================================================= */
+
+// the generated determinants below try a semi-static floating-point filter, then interval arithmetic, then exact
+// expansions, and count the evaluations reaching each stage per thread
+// CAUTION: the counters of a thread register themselves on construction, so every evaluation goes through the
+// initialization guard of a thread_local; they are only compiled in when IMPLICIT_PREDICATES_STAGE_STATS is defined by the
+// implicit_predicates_stage_stats option
+#ifdef IMPLICIT_PREDICATES_STAGE_STATS
+struct predicate_stage_counter_t {
+    std::atomic<uint64_t> value{};
+
+    // only the owning thread writes, so a relaxed load and store are enough, without a locked increment
+    void operator++(int) noexcept { value.store(value.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+
+    void operator+=(uint64_t count) noexcept
+    {
+        value.store(value.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+    }
+
+    uint64_t load() const noexcept { return value.load(std::memory_order_relaxed); }
+
+    void reset() noexcept { value.store(0, std::memory_order_relaxed); }
+};
+
+struct predicate_stage_counters_t {
+    predicate_stage_counter_t filtered{};
+    predicate_stage_counter_t interval{};
+    predicate_stage_counter_t exact{};
+
+    predicate_stage_counters_t();
+    ~predicate_stage_counters_t();
+};
+
+struct predicate_stage_registry_t {
+    std::mutex                               mutex{};
+    std::vector<predicate_stage_counters_t*> live_counters{};
+    predicate_filter_counters_t              retired_counters{};
+};
+
+// a function local static, since it must outlive the counters of every thread
+static predicate_stage_registry_t& predicate_stage_registry()
+{
+    static predicate_stage_registry_t registry{};
+    return registry;
+}
+
+predicate_stage_counters_t::predicate_stage_counters_t()
+{
+    auto&                       registry = predicate_stage_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.live_counters.emplace_back(this);
+}
+
+predicate_stage_counters_t::~predicate_stage_counters_t()
+{
+    auto&                       registry = predicate_stage_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.retired_counters.filtered += filtered.load();
+    registry.retired_counters.interval += interval.load();
+    registry.retired_counters.exact    += exact.load();
+    auto& live_counters = registry.live_counters;
+    live_counters.erase(std::remove(live_counters.begin(), live_counters.end(), this), live_counters.end());
+}
+
+static inline predicate_stage_counters_t& thread_predicate_stage_counters()
+{
+    static thread_local predicate_stage_counters_t counters{};
+    return counters;
+}
+
+#define semi_static_filter_stage  thread_predicate_stage_counters().filtered
+#define interval_arithmetic_stage thread_predicate_stage_counters().interval
+#define exact_computation_stage   thread_predicate_stage_counters().exact
+#endif
+
 #include "internal/det2.cpp"
 #include "internal/det3.cpp"
 #include "internal/det4.cpp"
@@ -29,8 +114,227 @@ orientation sign_of(T val)
         return orientation::zero;
 }
 
+/* =============================================================================================
+ * batches
+ * ============================================================================================= */
+
+// the batch predicates run the floating-point filters of 4 instances in the lanes of AVX2 registers, in the order of
+// the scalar filters so that their error bounds hold; uncertain lanes fall back to the scalar stages one at a time
+
+// the stages of the determinants after the filter, for the instances that the filter of a batch left uncertain
+static int det2_unfiltered(double p0, double p1, double q0, double q1)
+{
+#ifdef IMPLICIT_PREDICATES_STAGE_STATS
+    interval_arithmetic_stage++;
+#endif
+    const auto ret = det2_interval(p0, p1, q0, q1);
+    if (ret != Filtered_Sign::UNCERTAIN) return ret;
+
+#ifdef IMPLICIT_PREDICATES_STAGE_STATS
+    exact_computation_stage++;
+#endif
+    return det2_exact(p0, p1, q0, q1);
+}
+
+static int det3_unfiltered(const double m[9])
+{
+#ifdef IMPLICIT_PREDICATES_STAGE_STATS
+    interval_arithmetic_stage++;
+#endif
+    const auto ret = det3_interval(m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7], m[8]);
+    if (ret != Filtered_Sign::UNCERTAIN) return ret;
+
+#ifdef IMPLICIT_PREDICATES_STAGE_STATS
+    exact_computation_stage++;
+#endif
+    return det3_exact(m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7], m[8]);
+}
+
+static int det4_unfiltered(const double m[16])
+{
+#ifdef IMPLICIT_PREDICATES_STAGE_STATS
+    interval_arithmetic_stage++;
+#endif
+    // clang-format off
+    const auto ret = det4_interval(m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7],
+                                   m[8], m[9], m[10], m[11], m[12], m[13], m[14], m[15]);
+    // clang-format on
+    if (ret != Filtered_Sign::UNCERTAIN) return ret;
+
+#ifdef IMPLICIT_PREDICATES_STAGE_STATS
+    exact_computation_stage++;
+#endif
+    return det4_exact(m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7], m[8], m[9], m[10], m[11], m[12], m[13], m[14], m[15]);
+}
+
+#if defined(__AVX2__)
+static constexpr uint32_t batch_width = 4;
+
+// the largest absolute value of the entries in each lane, starting from 0 as the scalar filters do
+template <size_t N>
+static inline __m256d max_abs_x4(const __m256d (&m)[N])
+{
+    const auto sign_mask = _mm256_set1_pd(-0.0);
+    auto       max_var   = _mm256_setzero_pd();
+    for (const auto& entry : m) max_var = _mm256_max_pd(max_var, _mm256_andnot_pd(sign_mask, entry));
+    return max_var;
+}
+
+// the sign of each lane that the scalar filter returns for the same value and error bound
+static inline void filtered_signs_x4(__m256d value, __m256d epsilon, int signs[batch_width])
+{
+    const auto negated  = _mm256_xor_pd(value, _mm256_set1_pd(-0.0));
+    const int  positive = _mm256_movemask_pd(_mm256_cmp_pd(value, epsilon, _CMP_GT_OQ));
+    const int  negative = _mm256_movemask_pd(_mm256_cmp_pd(negated, epsilon, _CMP_GT_OQ));
+    for (uint32_t l = 0; l < batch_width; ++l) {
+        if ((positive >> l) & 1)
+            signs[l] = IP_Sign::POSITIVE;
+        else if ((negative >> l) & 1)
+            signs[l] = IP_Sign::NEGATIVE;
+        else
+            signs[l] = Filtered_Sign::UNCERTAIN;
+    }
+}
+
+// det2_filtered of the 2x2 matrices m, in row-major order
+static inline void det2_filtered_x4(const __m256d (&m)[4], int signs[batch_width])
+{
+    const auto d1 = _mm256_mul_pd(m[0], m[3]);
+    const auto d2 = _mm256_mul_pd(m[1], m[2]);
+    const auto v  = _mm256_sub_pd(d1, d2);
+
+    const auto max_var = max_abs_x4(m);
+    auto       epsilon = _mm256_mul_pd(max_var, max_var);
+    epsilon            = _mm256_mul_pd(epsilon, _mm256_set1_pd(4.440892098500627e-16));
+    filtered_signs_x4(v, epsilon, signs);
+}
+
+// det3_filtered of the 3x3 matrices m, in row-major order
+static inline void det3_filtered_x4(const __m256d (&m)[9], int signs[batch_width])
+{
+    const auto &p0 = m[0], &p1 = m[1], &p2 = m[2];
+    const auto &q0 = m[3], &q1 = m[4], &q2 = m[5];
+    const auto &r0 = m[6], &r1 = m[7], &r2 = m[8];
+
+    const auto q0r1 = _mm256_mul_pd(q0, r1);
+    const auto q1r0 = _mm256_mul_pd(q1, r0);
+    const auto q1r2 = _mm256_mul_pd(q1, r2);
+    const auto q2r1 = _mm256_mul_pd(q2, r1);
+    const auto q2r0 = _mm256_mul_pd(q2, r0);
+    const auto q0r2 = _mm256_mul_pd(q0, r2);
+    const auto d0   = _mm256_sub_pd(q1r2, q2r1);
+    const auto d1   = _mm256_sub_pd(q2r0, q0r2);
+    const auto d2   = _mm256_sub_pd(q0r1, q1r0);
+    const auto m0   = _mm256_mul_pd(p0, d0);
+    const auto m1   = _mm256_mul_pd(p1, d1);
+    const auto m2   = _mm256_mul_pd(p2, d2);
+    const auto m01  = _mm256_add_pd(m0, m1);
+    const auto v    = _mm256_add_pd(m01, m2);
+
+    const auto max_var = max_abs_x4(m);
+    auto       epsilon = _mm256_mul_pd(max_var, max_var);
+    epsilon            = _mm256_mul_pd(epsilon, max_var);
+    epsilon            = _mm256_mul_pd(epsilon, _mm256_set1_pd(2.886579864025408e-15));
+    filtered_signs_x4(v, epsilon, signs);
+}
+
+// det4_filtered of the 4x4 matrices m, in row-major order
+static inline void det4_filtered_x4(const __m256d (&m)[16], int signs[batch_width])
+{
+    const auto &a_ = m[0], &b_ = m[1], &c_ = m[2], &d_ = m[3];
+    const auto &e_ = m[4], &f_ = m[5], &g_ = m[6], &h_ = m[7];
+    const auto &i_ = m[8], &j_ = m[9], &k_ = m[10], &l_ = m[11];
+    const auto &m_ = m[12], &n_ = m[13], &o_ = m[14], &p_ = m[15];
+
+    const auto af      = _mm256_mul_pd(a_, f_);
+    const auto be      = _mm256_mul_pd(b_, e_);
+    const auto kp      = _mm256_mul_pd(k_, p_);
+    const auto lo      = _mm256_mul_pd(l_, o_);
+    const auto ce      = _mm256_mul_pd(c_, e_);
+    const auto ag      = _mm256_mul_pd(a_, g_);
+    const auto jp      = _mm256_mul_pd(j_, p_);
+    const auto ln      = _mm256_mul_pd(l_, n_);
+    const auto ah      = _mm256_mul_pd(a_, h_);
+    const auto de      = _mm256_mul_pd(d_, e_);
+    const auto jo      = _mm256_mul_pd(j_, o_);
+    const auto kn      = _mm256_mul_pd(k_, n_);
+    const auto bg      = _mm256_mul_pd(b_, g_);
+    const auto cf      = _mm256_mul_pd(c_, f_);
+    const auto ip      = _mm256_mul_pd(i_, p_);
+    const auto lm      = _mm256_mul_pd(l_, m_);
+    const auto df      = _mm256_mul_pd(d_, f_);
+    const auto bh      = _mm256_mul_pd(b_, h_);
+    const auto io      = _mm256_mul_pd(i_, o_);
+    const auto km      = _mm256_mul_pd(k_, m_);
+    const auto ch      = _mm256_mul_pd(c_, h_);
+    const auto dg      = _mm256_mul_pd(d_, g_);
+    const auto in      = _mm256_mul_pd(i_, n_);
+    const auto jm      = _mm256_mul_pd(j_, m_);
+    const auto d1      = _mm256_sub_pd(af, be);
+    const auto d2      = _mm256_sub_pd(kp, lo);
+    const auto d3      = _mm256_sub_pd(ce, ag);
+    const auto d4      = _mm256_sub_pd(jp, ln);
+    const auto d5      = _mm256_sub_pd(ah, de);
+    const auto d6      = _mm256_sub_pd(jo, kn);
+    const auto d7      = _mm256_sub_pd(bg, cf);
+    const auto d8      = _mm256_sub_pd(ip, lm);
+    const auto d9      = _mm256_sub_pd(df, bh);
+    const auto d10     = _mm256_sub_pd(io, km);
+    const auto d11     = _mm256_sub_pd(ch, dg);
+    const auto d12     = _mm256_sub_pd(in, jm);
+    const auto t1      = _mm256_mul_pd(d1, d2);
+    const auto t2      = _mm256_mul_pd(d3, d4);
+    const auto t3      = _mm256_mul_pd(d5, d6);
+    const auto t4      = _mm256_mul_pd(d7, d8);
+    const auto t5      = _mm256_mul_pd(d9, d10);
+    const auto t6      = _mm256_mul_pd(d11, d12);
+    const auto r12     = _mm256_add_pd(t1, t2);
+    const auto r34     = _mm256_add_pd(t3, t4);
+    const auto r56     = _mm256_add_pd(t5, t6);
+    const auto r1234   = _mm256_add_pd(r12, r34);
+    const auto r123456 = _mm256_add_pd(r1234, r56);
+
+    const auto max_var = max_abs_x4(m);
+    auto       epsilon = _mm256_mul_pd(max_var, max_var);
+    epsilon            = _mm256_mul_pd(epsilon, epsilon);
+    epsilon            = _mm256_mul_pd(epsilon, _mm256_set1_pd(1.953992523340277e-14));
+    filtered_signs_x4(r123456, epsilon, signs);
+}
+#endif
+
 EXTERN_C_BEGIN
 
+IP_API predicate_filter_counters_t get_predicate_filter_counters()
+{
+#ifdef IMPLICIT_PREDICATES_STAGE_STATS
+    auto&                       registry = predicate_stage_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto                        result = registry.retired_counters;
+    for (const auto* counters : registry.live_counters) {
+        result.filtered += counters->filtered.load();
+        result.interval += counters->interval.load();
+        result.exact    += counters->exact.load();
+    }
+    return result;
+#else
+    return {};
+#endif
+}
+
+IP_API void reset_predicate_filter_counters()
+{
+#ifdef IMPLICIT_PREDICATES_STAGE_STATS
+    auto&                       registry = predicate_stage_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.retired_counters = {};
+    for (auto* counters : registry.live_counters) {
+        counters->filtered.reset();
+        counters->interval.reset();
+        counters->exact.reset();
+    }
+#endif
+}
+
 IP_API orientation orient1d(const double f0[2], const double f1[2])
 {
     if (f0[0] == f0[1]) {
@@ -218,4 +522,184 @@ IP_API orientation
     }
 }
 
+IP_API orientation det2_sign(const double f0[2], const double f1[2])
+{
+    return sign_of(det2(f0[0], f0[1], f1[0], f1[1]));
+}
+
+IP_API orientation det3_sign(const double f0[3], const double f1[3], const double f2[3])
+{
+    // clang-format off
+    return sign_of(det3(
+            f0[0], f0[1], f0[2],
+            f1[0], f1[1], f1[2],
+            f2[0], f2[1], f2[2]));
+    // clang-format on
+}
+
+IP_API orientation det4_sign(const double f0[4], const double f1[4], const double f2[4], const double f3[4])
+{
+    // clang-format off
+    return sign_of(det4(
+            f0[0], f0[1], f0[2], f0[3],
+            f1[0], f1[1], f1[2], f1[3],
+            f2[0], f2[1], f2[2], f2[3],
+            f3[0], f3[1], f3[2], f3[3]));
+    // clang-format on
+}
+
+IP_API void orient1d_batch(uint32_t count, const double* const f0[2], const double* const f1[2], orientation* orientations)
+{
+    uint32_t n = 0;
+#if defined(__AVX2__)
+    for (; n + batch_width <= count; n += batch_width) {
+        const __m256d m[4] = {_mm256_loadu_pd(f0[0] + n),
+                              _mm256_loadu_pd(f0[1] + n),
+                              _mm256_loadu_pd(f1[0] + n),
+                              _mm256_loadu_pd(f1[1] + n)};
+        int           signs[batch_width];
+        det2_filtered_x4(m, signs);
+
+        for (uint32_t l = 0; l < batch_width; ++l) {
+            const auto i = n + l;
+            if (f0[0][i] == f0[1][i]) {
+                // Function 0 is constant.
+                orientations[i] = orientation::invalid;
+                continue;
+            }
+
+            auto sign = signs[l];
+            if (sign == Filtered_Sign::UNCERTAIN) sign = det2_unfiltered(f0[0][i], f0[1][i], f1[0][i], f1[1][i]);
+            orientations[i] = f0[1][i] < f0[0][i] ? sign_of(sign) : sign_of(-sign);
+        }
+    }
+#ifdef IMPLICIT_PREDICATES_STAGE_STATS
+    semi_static_filter_stage += n;
+#endif
+#endif
+
+    for (; n < count; ++n) {
+        const double g0[2] = {f0[0][n], f0[1][n]};
+        const double g1[2] = {f1[0][n], f1[1][n]};
+        orientations[n]   = orient1d(g0, g1);
+    }
+}
+
+IP_API void orient2d_batch(uint32_t            count,
+                           const double* const f0[3],
+                           const double* const f1[3],
+                           const double* const f2[3],
+                           orientation*        orientations)
+{
+    uint32_t n = 0;
+#if defined(__AVX2__)
+    const auto one = _mm256_set1_pd(1);
+    for (; n + batch_width <= count; n += batch_width) {
+        __m256d m[9];
+        for (uint32_t k = 0; k < 3; ++k) {
+            m[k]     = _mm256_loadu_pd(f0[k] + n);
+            m[3 + k] = _mm256_loadu_pd(f1[k] + n);
+            m[6 + k] = one;
+        }
+        int denominators[batch_width];
+        det3_filtered_x4(m, denominators);
+        for (uint32_t k = 0; k < 3; ++k) m[6 + k] = _mm256_loadu_pd(f2[k] + n);
+        int numerators[batch_width];
+        det3_filtered_x4(m, numerators);
+
+        for (uint32_t l = 0; l < batch_width; ++l) {
+            const auto i              = n + l;
+            double     lane_matrix[9] = {f0[0][i], f0[1][i], f0[2][i], f1[0][i], f1[1][i], f1[2][i], 1, 1, 1};
+
+            auto denominator = denominators[l];
+            if (denominator == Filtered_Sign::UNCERTAIN) denominator = det3_unfiltered(lane_matrix);
+            if (denominator == 0) {
+                orientations[i] = orientation::invalid;
+                continue;
+            }
+
+            auto numerator = numerators[l];
+            if (numerator == Filtered_Sign::UNCERTAIN) {
+                for (uint32_t k = 0; k < 3; ++k) lane_matrix[6 + k] = f2[k][i];
+                numerator = det3_unfiltered(lane_matrix);
+            }
+            orientations[i] = denominator > 0 ? sign_of(numerator) : sign_of(-numerator);
+        }
+    }
+#ifdef IMPLICIT_PREDICATES_STAGE_STATS
+    semi_static_filter_stage += 2 * n;
+#endif
+#endif
+
+    for (; n < count; ++n) {
+        const double g0[3] = {f0[0][n], f0[1][n], f0[2][n]};
+        const double g1[3] = {f1[0][n], f1[1][n], f1[2][n]};
+        const double g2[3] = {f2[0][n], f2[1][n], f2[2][n]};
+        orientations[n]   = orient2d(g0, g1, g2);
+    }
+}
+
+IP_API void orient3d_batch(uint32_t            count,
+                           const double* const f0[4],
+                           const double* const f1[4],
+                           const double* const f2[4],
+                           const double* const f3[4],
+                           orientation*        orientations)
+{
+    uint32_t n = 0;
+#if defined(__AVX2__)
+    const auto one = _mm256_set1_pd(1);
+    for (; n + batch_width <= count; n += batch_width) {
+        __m256d m[16];
+        for (uint32_t k = 0; k < 4; ++k) {
+            m[k]      = _mm256_loadu_pd(f0[k] + n);
+            m[4 + k]  = _mm256_loadu_pd(f1[k] + n);
+            m[8 + k]  = _mm256_loadu_pd(f2[k] + n);
+            m[12 + k] = one;
+        }
+        int denominators[batch_width];
+        det4_filtered_x4(m, denominators);
+        for (uint32_t k = 0; k < 4; ++k) m[12 + k] = _mm256_loadu_pd(f3[k] + n);
+        int numerators[batch_width];
+        det4_filtered_x4(m, numerators);
+
+        for (uint32_t l = 0; l < batch_width; ++l) {
+            const auto i = n + l;
+            double     lane_matrix[16];
+            for (uint32_t k = 0; k < 4; ++k) {
+                lane_matrix[k]      = f0[k][i];
+                lane_matrix[4 + k]  = f1[k][i];
+                lane_matrix[8 + k]  = f2[k][i];
+                lane_matrix[12 + k] = 1;
+            }
+
+            auto denominator = denominators[l];
+            if (denominator == Filtered_Sign::UNCERTAIN) denominator = det4_unfiltered(lane_matrix);
+            if (denominator == 0) {
+                orientations[i] = orientation::invalid;
+                continue;
+            }
+
+            auto numerator = numerators[l];
+            if (numerator == Filtered_Sign::UNCERTAIN) {
+                for (uint32_t k = 0; k < 4; ++k) lane_matrix[12 + k] = f3[k][i];
+                numerator = det4_unfiltered(lane_matrix);
+            }
+            orientations[i] = denominator > 0 ? sign_of(numerator) : sign_of(-numerator);
+        }
+    }
+#ifdef IMPLICIT_PREDICATES_STAGE_STATS
+    semi_static_filter_stage += 2 * n;
+#endif
+#endif
+
+    for (; n < count; ++n) {
+        const double g0[4] = {f0[0][n], f0[1][n], f0[2][n], f0[3][n]};
+        const double g1[4] = {f1[0][n], f1[1][n], f1[2][n], f1[3][n]};
+        const double g2[4] = {f2[0][n], f2[1][n], f2[2][n], f2[3][n]};
+        const double g3[4] = {f3[0][n], f3[1][n], f3[2][n], f3[3][n]};
+        orientations[n]   = orient3d(g0, g1, g2, g3);
+    }
+}
+
 EXTERN_C_END
\ No newline at end of file
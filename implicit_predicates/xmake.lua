@@ -1,3 +1,14 @@
+-- counts the determinant evaluations reaching each stage of the predicates, at the cost of a thread_local on every one
+option("implicit_predicates_stage_stats")
+    set_default(false)
+    set_description("Count the filter stages of the implicit predicates")
+option_end()
+
 internal_library("implicit_predicates", "IP", os.scriptdir())
     add_rules("config.indirect_predicates.flags")
-    add_deps("indirect_predicates", "shared_module")
\ No newline at end of file
+    add_deps("indirect_predicates", "shared_module")
+    on_config(function (target)
+        if has_config("implicit_predicates_stage_stats") then
+            target:add("defines", "IMPLICIT_PREDICATES_STAGE_STATS")
+        end
+    end)
\ No newline at end of file
@@ -3,17 +3,17 @@
 #include <utils/fwd_types.hpp>
 
 // extract iso-mesh (topology only)
-ISNP_API void extract_iso_mesh(uint32_t                                             num_1_func,
-                               uint32_t                                             num_2_func,
-                               uint32_t                                             num_more_func,
-                               const stl_vector_mp<std::shared_ptr<arrangement_t>>& cut_results,
-                               const stl_vector_mp<uint32_t>&                       func_in_tet,
-                               const stl_vector_mp<uint32_t>&                       start_index_of_tet,
-                               const tetrahedron_mesh_t&                            background_mesh,
-                               const stl_vector_mp<stl_vector_mp<double>>&          func_vals,
-                               stl_vector_mp<raw_point_t>&                          iso_pts,
-                               stl_vector_mp<iso_vertex_t>&                         iso_verts,
-                               stl_vector_mp<polygon_face_t>&                       iso_faces);
+ISNP_API void extract_iso_mesh(uint32_t                                                           num_1_func,
+                               uint32_t                                                           num_2_func,
+                               uint32_t                                                           num_more_func,
+                               const stl_vector_mp<std::shared_ptr<const compact_arrangement_t>>& cut_results,
+                               const stl_vector_mp<uint32_t>&                                     func_in_tet,
+                               const stl_vector_mp<uint32_t>&                                     start_index_of_tet,
+                               const tetrahedron_mesh_t&                                          background_mesh,
+                               const stl_vector_mp<stl_vector_mp<double>>&                        func_vals,
+                               stl_vector_mp<raw_point_t>&                                        iso_pts,
+                               stl_vector_mp<iso_vertex_t>&                                       iso_verts,
+                               stl_vector_mp<polygon_face_t>&                                     iso_faces);
 
 // given the list of vertex indices of a face, return the unique key of the face: (the smallest vert Id,
 // second-smallest vert Id, the largest vert Id) assume: face_verts is a list of non-duplicate natural
@@ -74,17 +74,17 @@ struct equal_to<face_with_orient_t> {
 } // namespace std
 
 // topological ray shooting for implicit arrangement
-ISNP_API void topo_ray_shooting(const tetrahedron_mesh_t                            &tet_mesh,
-                                const stl_vector_mp<std::shared_ptr<arrangement_t>> &cut_results,
-                                const stl_vector_mp<iso_vertex_t>                   &iso_verts,
-                                const stl_vector_mp<polygon_face_t>                 &iso_faces,
-                                const stl_vector_mp<stl_vector_mp<uint32_t>>        &patches,
-                                const stl_vector_mp<uint32_t>                       &patch_of_face,
-                                const stl_vector_mp<stl_vector_mp<uint32_t>>        &shells,
-                                const stl_vector_mp<uint32_t>                       &shell_of_half_patch,
-                                const stl_vector_mp<stl_vector_mp<uint32_t>>        &components,
-                                const stl_vector_mp<uint32_t>                       &component_of_patch,
-                                stl_vector_mp<std::pair<uint32_t, uint32_t>>        &shell_links);
+ISNP_API void topo_ray_shooting(const tetrahedron_mesh_t                                          &tet_mesh,
+                                const stl_vector_mp<std::shared_ptr<const compact_arrangement_t>> &cut_results,
+                                const stl_vector_mp<iso_vertex_t>                                 &iso_verts,
+                                const stl_vector_mp<polygon_face_t>                               &iso_faces,
+                                const stl_vector_mp<stl_vector_mp<uint32_t>>                      &patches,
+                                const stl_vector_mp<uint32_t>                                     &patch_of_face,
+                                const stl_vector_mp<stl_vector_mp<uint32_t>>                      &shells,
+                                const stl_vector_mp<uint32_t>                                     &shell_of_half_patch,
+                                const stl_vector_mp<stl_vector_mp<uint32_t>>                      &components,
+                                const stl_vector_mp<uint32_t>                                     &component_of_patch,
+                                stl_vector_mp<std::pair<uint32_t, uint32_t>>                      &shell_links);
 
 // Given tet mesh,
 // build the map: v-->v_next, where v_next has lower order than v
@@ -109,23 +109,23 @@ ISNP_API void find_extremal_edges(const stl_vector_mp<raw_point_t>
 
 // compute the order of iso-vertices on a tet edge v->u, v,u in {0,1,2,3}
 // return a list of sorted vertex indices {v_id, i1, i2, ..., u_id}
-ISNP_API void compute_edge_intersection_order(const arrangement_t     &tet_cut_result,
-                                              uint32_t                 v,
-                                              uint32_t                 u,
-                                              stl_vector_mp<uint32_t> &vert_indices);
+ISNP_API void compute_edge_intersection_order(const compact_arrangement_t &tet_cut_result,
+                                              uint32_t                     v,
+                                              uint32_t                     u,
+                                              stl_vector_mp<uint32_t>     &vert_indices);
 
 // find the two faces passing v1 and v2, v1->v2 is part of a tet edge
-ISNP_API void compute_passing_face_pair(const arrangement_t &tet_cut_result,
-                                        uint32_t             v1,
-                                        uint32_t             v2,
-                                        face_with_orient_t  &face_orient1,
-                                        face_with_orient_t  &face_orient2);
+ISNP_API void compute_passing_face_pair(const compact_arrangement_t &tet_cut_result,
+                                        uint32_t                     v1,
+                                        uint32_t                     v2,
+                                        face_with_orient_t          &face_orient1,
+                                        face_with_orient_t          &face_orient2);
 
 // find the face passing v, v->u is part of a tet edge, and u is a tet vertex
-ISNP_API void compute_passing_face(const arrangement_t &tet_cut_result,
-                                   uint32_t             v,
-                                   uint32_t             u,
-                                   face_with_orient_t  &face_orient);
+ISNP_API void compute_passing_face(const compact_arrangement_t &tet_cut_result,
+                                   uint32_t                     v,
+                                   uint32_t                     u,
+                                   face_with_orient_t          &face_orient);
 
 // point (x,y,z): dictionary order
 inline bool point_xyz_less(const raw_point_t &p, const raw_point_t &q)
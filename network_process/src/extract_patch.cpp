@@ -4,17 +4,17 @@
 
 /// EDIT: swap the 1st and the 2nd indices of func_vals
 /// TODO: compress implicit function indices into uint16_t instead of uint32_t
-ISNP_API void extract_iso_mesh(uint32_t                                             num_1_func,
-                               uint32_t                                             num_2_func,
-                               uint32_t                                             num_more_func,
-                               const stl_vector_mp<std::shared_ptr<arrangement_t>>& cut_results,
-                               const stl_vector_mp<uint32_t>&                       func_in_tet,
-                               const stl_vector_mp<uint32_t>&                       start_index_of_tet,
-                               const tetrahedron_mesh_t&                            background_mesh,
-                               const stl_vector_mp<stl_vector_mp<double>>&          func_vals,
-                               stl_vector_mp<raw_point_t>&                          iso_pts,
-                               stl_vector_mp<iso_vertex_t>&                         iso_verts,
-                               stl_vector_mp<polygon_face_t>&                       iso_faces)
+ISNP_API void extract_iso_mesh(uint32_t                                                           num_1_func,
+                               uint32_t                                                           num_2_func,
+                               uint32_t                                                           num_more_func,
+                               const stl_vector_mp<std::shared_ptr<const compact_arrangement_t>>& cut_results,
+                               const stl_vector_mp<uint32_t>&                                     func_in_tet,
+                               const stl_vector_mp<uint32_t>&                                     start_index_of_tet,
+                               const tetrahedron_mesh_t&                                          background_mesh,
+                               const stl_vector_mp<stl_vector_mp<double>>&                        func_vals,
+                               stl_vector_mp<raw_point_t>&                                        iso_pts,
+                               stl_vector_mp<iso_vertex_t>&                                       iso_verts,
+                               stl_vector_mp<polygon_face_t>&                                     iso_faces)
 {
     const auto& pts  = background_mesh.vertices;
     const auto& tets = background_mesh.indices;
@@ -58,8 +58,8 @@ ISNP_API void extract_iso_mesh(uint32_t
     for (uint32_t i = 0; i < n_tets; i++) {
         if (cut_results[i]) {
             const auto& arrangement = *cut_results[i].get();
-            const auto& vertices    = arrangement.vertices;
-            const auto& faces       = arrangement.faces;
+            const auto  vertices    = arrangement.vertices();
+            const auto  faces       = arrangement.faces();
             auto        start_index = start_index_of_tet[i];
             auto        num_func    = start_index_of_tet[i + 1] - start_index;
 
@@ -67,7 +67,7 @@ ISNP_API void extract_iso_mesh(uint32_t
             is_iso_vert.assign(vertices.size(), false);
             is_iso_face.clear();
             is_iso_face.reserve(faces.size());
-            if (arrangement.unique_planes.empty()) { // all planes are unique
+            if (arrangement.unique_planes().empty()) { // all planes are unique
                 for (const auto& face : faces) {
                     is_iso_face.emplace_back(false);
                     if (face.supporting_plane > 3) { // plane 0,1,2,3 are tet boundaries
@@ -79,8 +79,8 @@ ISNP_API void extract_iso_mesh(uint32_t
                 for (const auto& face : faces) {
                     is_iso_face.emplace_back(false);
                     auto pid = face.supporting_plane;
-                    auto uid = arrangement.unique_plane_indices[pid];
-                    for (const auto& plane_id : arrangement.unique_planes[uid]) {
+                    auto uid = arrangement.unique_plane_indices()[pid];
+                    for (const auto& plane_id : arrangement.unique_planes()[uid]) {
                         if (plane_id > 3) { // plane 0,1,2,3 are tet boundaries
                             is_iso_face.back() = true;
                             for (const auto& vid : face.vertices) { is_iso_vert[vid] = true; }
@@ -5,16 +5,16 @@
 #include <pair_faces.hpp>
 #include "utils/fwd_types.hpp"
 
-ISNP_API void compute_patch_order(const iso_edge_t                                          &iso_edge,
-                                  const stl_vector_mp<tetrahedron_vertex_indices_t>         &tets,
-                                  const stl_vector_mp<iso_vertex_t>                         &iso_verts,
-                                  const stl_vector_mp<polygon_face_t>                       &iso_faces,
-                                  const stl_vector_mp<std::shared_ptr<arrangement_t>>       &cut_results,
-                                  const stl_vector_mp<uint32_t>                             &func_in_tet,
-                                  const stl_vector_mp<uint32_t>                             &start_index_of_tet,
-                                  const flat_hash_map_mp<uint32_t, stl_vector_mp<uint32_t>> &incident_tets,
-                                  const stl_vector_mp<uint32_t>                             &patch_of_face_mapping,
-                                  stl_vector_mp<stl_vector_mp<uint32_t>>                    &half_patch_adj_list)
+ISNP_API void compute_patch_order(const iso_edge_t                                                  &iso_edge,
+                                  const stl_vector_mp<tetrahedron_vertex_indices_t>                 &tets,
+                                  const stl_vector_mp<iso_vertex_t>                                 &iso_verts,
+                                  const stl_vector_mp<polygon_face_t>                               &iso_faces,
+                                  const stl_vector_mp<std::shared_ptr<const compact_arrangement_t>> &cut_results,
+                                  const stl_vector_mp<uint32_t>                                     &func_in_tet,
+                                  const stl_vector_mp<uint32_t>                                     &start_index_of_tet,
+                                  const flat_hash_map_mp<uint32_t, stl_vector_mp<uint32_t>>         &incident_tets,
+                                  const stl_vector_mp<uint32_t>                                     &patch_of_face_mapping,
+                                  stl_vector_mp<stl_vector_mp<uint32_t>>                            &half_patch_adj_list)
 {
     using unordered_set_mp_of_index_t =
         std::unordered_set<uint32_t, std::hash<uint32_t>, std::equal_to<uint32_t>, ScalableMemoryPoolAllocator<uint32_t>>;
@@ -110,16 +110,16 @@ ISNP_API void compute_patch_order(const iso_edge_t
 
 // ===============================================================================================
 
-ISNP_API void pair_patches_in_one_tet(const arrangement_t                    &tet_cut_result,
+ISNP_API void pair_patches_in_one_tet(const compact_arrangement_t            &tet_cut_result,
                                       const stl_vector_mp<polygon_face_t>    &iso_faces,
                                       const iso_edge_t                       &iso_edge,
                                       const stl_vector_mp<uint32_t>          &patch_of_face_mapping,
                                       stl_vector_mp<stl_vector_mp<uint32_t>> &half_patch_adj_list)
 {
     // find tet faces that are incident to the iso_edge
-    stl_vector_mp<bool>     is_incident_faces(tet_cut_result.faces.size(), false);
+    stl_vector_mp<bool>     is_incident_faces(tet_cut_result.faces().size(), false);
     // map: tet face id --> iso face id
-    stl_vector_mp<uint32_t> iso_face_Id_of_face(tet_cut_result.faces.size(), invalid_index);
+    stl_vector_mp<uint32_t> iso_face_Id_of_face(tet_cut_result.faces().size(), invalid_index);
     for (const auto &fId_eId_pair : iso_edge.headers) {
         const auto iso_face_id       = fId_eId_pair.face_index;
         const auto face_id           = iso_faces[iso_face_id].headers[0].local_face_index;
@@ -128,7 +128,7 @@ ISNP_API void pair_patches_in_one_tet(const arrangement_t                    &te
     }
 
     // travel around the edge
-    stl_vector_mp<bool> visited_cell(tet_cut_result.cells.size(), false);
+    stl_vector_mp<bool> visited_cell(tet_cut_result.cells().size(), false);
 
     struct travel_info_t {
         uint32_t iso_face_id{invalid_index};
@@ -154,7 +154,7 @@ ISNP_API void pair_patches_in_one_tet(const arrangement_t                    &te
         while (cell_id != invalid_index && !visited_cell[cell_id]) {
             visited_cell[cell_id] = true;
             // find next face
-            for (const auto &fId : tet_cut_result.cells[cell_id].faces) {
+            for (const auto &fId : tet_cut_result.cells()[cell_id].faces) {
                 if (is_incident_faces[fId] && fId != info1.face_id) { info2.face_id = fId; }
             }
             if (info2.face_id == invalid_index) {
@@ -162,11 +162,11 @@ ISNP_API void pair_patches_in_one_tet(const arrangement_t                    &te
                 break;
             } else {
                 // get sign of face2 and find next cell
-                if (tet_cut_result.faces[info2.face_id].positive_cell == cell_id) {
-                    cell_id         = tet_cut_result.faces[info2.face_id].negative_cell;
+                if (tet_cut_result.faces()[info2.face_id].positive_cell == cell_id) {
+                    cell_id         = tet_cut_result.faces()[info2.face_id].negative_cell;
                     info2.face_sign = 1;
                 } else {
-                    cell_id         = tet_cut_result.faces[info2.face_id].positive_cell;
+                    cell_id         = tet_cut_result.faces()[info2.face_id].positive_cell;
                     info2.face_sign = -1;
                 }
                 // add (face1, face2) to the list of face pairs
@@ -188,29 +188,29 @@ ISNP_API void pair_patches_in_one_tet(const arrangement_t                    &te
                         iso_faces[iso_edge.headers[0].face_index].headers[0].local_face_index,
                         1};
     travel_info_t info2{};
-    auto          cell_id = tet_cut_result.faces[info1.face_id].positive_cell;
+    auto          cell_id = tet_cut_result.faces()[info1.face_id].positive_cell;
     travel_func(cell_id, info1, info2);
     // travel in a different direction
     info1 = {iso_edge.headers[0].face_index,                                        //
              iso_faces[iso_edge.headers[0].face_index].headers[0].local_face_index, //
              -1};
     info2.clear();
-    cell_id = tet_cut_result.faces[info1.face_id].negative_cell;
+    cell_id = tet_cut_result.faces()[info1.face_id].negative_cell;
     travel_func(cell_id, info1, info2);
 }
 
 // ===============================================================================================
 
-ISNP_API void pair_patches_in_tets(const iso_edge_t                                    &iso_edge,
-                                   const stl_vector_mp<uint32_t>                       &containing_simplex,
-                                   const stl_vector_mp<uint32_t>                       &containing_tetIds,
-                                   const stl_vector_mp<tetrahedron_vertex_indices_t>   &tets,
-                                   const stl_vector_mp<polygon_face_t>                 &iso_faces,
-                                   const stl_vector_mp<std::shared_ptr<arrangement_t>> &cut_results,
-                                   const stl_vector_mp<uint32_t>                       &func_in_tet,
-                                   const stl_vector_mp<uint32_t>                       &start_index_of_tet,
-                                   const stl_vector_mp<uint32_t>                       &patch_of_face_mapping,
-                                   stl_vector_mp<stl_vector_mp<uint32_t>>              &half_patch_adj_list)
+ISNP_API void pair_patches_in_tets(const iso_edge_t                                                  &iso_edge,
+                                   const stl_vector_mp<uint32_t>                                     &containing_simplex,
+                                   const stl_vector_mp<uint32_t>                                     &containing_tetIds,
+                                   const stl_vector_mp<tetrahedron_vertex_indices_t>                 &tets,
+                                   const stl_vector_mp<polygon_face_t>                               &iso_faces,
+                                   const stl_vector_mp<std::shared_ptr<const compact_arrangement_t>> &cut_results,
+                                   const stl_vector_mp<uint32_t>                                     &func_in_tet,
+                                   const stl_vector_mp<uint32_t>                                     &start_index_of_tet,
+                                   const stl_vector_mp<uint32_t>                                     &patch_of_face_mapping,
+                                   stl_vector_mp<stl_vector_mp<uint32_t>>                            &half_patch_adj_list)
 {
     //// pre-processing
     // collect all iso-faces incident to the iso-edge
@@ -322,12 +322,12 @@ ISNP_API void pair_patches_in_tets(const iso_edge_t
         } else {
             // non-empty tet i
             const auto &arrangement = *cut_results[i].get();
-            const auto &vertices    = arrangement.vertices;
-            const auto &faces       = arrangement.faces;
+            const auto  vertices    = arrangement.vertices();
+            const auto  faces       = arrangement.faces();
             auto        start_index = start_index_of_tet[i];
             auto        num_func    = start_index_of_tet[i + 1] - start_index;
             // find vertices and faces on tet boundary incident to iso-edge
-            is_boundary_vert.assign(arrangement.vertices.size(), false);
+            is_boundary_vert.assign(arrangement.vertices().size(), false);
             is_boundary_face.clear();
             is_boundary_face.reserve(faces.size());
             for (const auto &face : faces) {
@@ -443,7 +443,7 @@ ISNP_API void pair_patches_in_tets(const iso_edge_t
     auto get_half_iso_face = [&](face_header_t tet_face, int8_t orient, uint32_t &iso_face_id, int8_t &iso_orient) {
         iso_face_id              = iso_face_Id_of_face[tet_face];
         const auto &cell_complex = *cut_results[tet_face.volume_index].get();
-        const auto &faces        = cell_complex.faces;
+        const auto  faces        = cell_complex.faces();
         auto        supp_pId     = faces[tet_face.local_face_index].supporting_plane;
         if (supp_pId > 3) { // plane 0,1,2,3 are tet boundary planes
             // supporting plane is not a tet boundary plane
@@ -451,15 +451,15 @@ ISNP_API void pair_patches_in_tets(const iso_edge_t
             iso_orient = orient;
         } else {
             // supporting plane is a tet boundary plane, must be duplicate planes
-            const auto uid     = cell_complex.unique_plane_indices[supp_pId];
+            const auto uid     = cell_complex.unique_plane_indices()[supp_pId];
             // find the smallest-index non-boundary plane
             uint32_t   min_pId = std::numeric_limits<uint32_t>::max();
-            for (auto pId : cell_complex.unique_planes[uid]) {
+            for (auto pId : cell_complex.unique_planes()[uid]) {
                 if (pId > 3 && pId < min_pId) { min_pId = pId; }
             }
             // orient is the orientation of supporting plane
             // flip orientation if smallest-index non-boundary plane has different orientation
-            if (cell_complex.unique_plane_orientations[min_pId] != cell_complex.unique_plane_orientations[supp_pId]) {
+            if (cell_complex.unique_plane_orientations()[min_pId] != cell_complex.unique_plane_orientations()[supp_pId]) {
                 iso_orient = -orient;
             } else {
                 iso_orient = orient;
@@ -487,10 +487,10 @@ ISNP_API void pair_patches_in_tets(const iso_edge_t
         } else {
             // non-empty tet
             const auto &cell_complex = *cut_results[tet_id].get();
-            uint32_t    cell_id =
-                (orient == 1 ? cell_complex.faces[tet_face_id].positive_cell : cell_complex.faces[tet_face_id].negative_cell);
+            const auto  tet_face     = cell_complex.faces()[tet_face_id];
+            uint32_t    cell_id      = (orient == 1 ? tet_face.positive_cell : tet_face.negative_cell);
             if (cell_id != invalid_index) {
-                for (auto fi : cell_complex.cells[cell_id].faces) {
+                for (auto fi : cell_complex.cells()[cell_id].faces) {
                     if (fi != tet_face_id
                         && (iso_face_Id_of_face.find({tet_id, fi}) != iso_face_Id_of_face.end()
                             || opposite_face.find({tet_id, fi}) != opposite_face.end())) {
@@ -498,7 +498,7 @@ ISNP_API void pair_patches_in_tets(const iso_edge_t
                         break;
                     }
                 }
-                orient_next = cell_complex.faces[face_next.local_face_index].positive_cell == cell_id ? 1 : -1;
+                orient_next = cell_complex.faces()[face_next.local_face_index].positive_cell == cell_id ? 1 : -1;
             } else {
                 // cell is None, so the face lies on tet boundary
                 find_next(opposite_face[face], 1, face_next, orient_next, find_next);
@@ -1,17 +1,17 @@
 #include <topology_ray_shooting.hpp>
 #include <patch_connectivity.hpp>
 
-ISNP_API void topo_ray_shooting(const tetrahedron_mesh_t                            &tet_mesh,
-                                const stl_vector_mp<std::shared_ptr<arrangement_t>> &cut_results,
-                                const stl_vector_mp<iso_vertex_t>                   &iso_verts,
-                                const stl_vector_mp<polygon_face_t>                 &iso_faces,
-                                const stl_vector_mp<stl_vector_mp<uint32_t>>        &patches,
-                                const stl_vector_mp<uint32_t>                       &patch_of_face,
-                                const stl_vector_mp<stl_vector_mp<uint32_t>>        &shells,
-                                const stl_vector_mp<uint32_t>                       &shell_of_half_patch,
-                                const stl_vector_mp<stl_vector_mp<uint32_t>>        &components,
-                                const stl_vector_mp<uint32_t>                       &component_of_patch,
-                                stl_vector_mp<std::pair<uint32_t, uint32_t>>        &shell_links)
+ISNP_API void topo_ray_shooting(const tetrahedron_mesh_t                                          &tet_mesh,
+                                const stl_vector_mp<std::shared_ptr<const compact_arrangement_t>> &cut_results,
+                                const stl_vector_mp<iso_vertex_t>                                 &iso_verts,
+                                const stl_vector_mp<polygon_face_t>                               &iso_faces,
+                                const stl_vector_mp<stl_vector_mp<uint32_t>>                      &patches,
+                                const stl_vector_mp<uint32_t>                                     &patch_of_face,
+                                const stl_vector_mp<stl_vector_mp<uint32_t>>                      &shells,
+                                const stl_vector_mp<uint32_t>                                     &shell_of_half_patch,
+                                const stl_vector_mp<stl_vector_mp<uint32_t>>                      &components,
+                                const stl_vector_mp<uint32_t>                                     &component_of_patch,
+                                stl_vector_mp<std::pair<uint32_t, uint32_t>>                      &shell_links)
 {
     // map: tet vert index --> index of next vert (with smaller (x,y,z))
     stl_vector_mp<uint32_t> next_vert{};
@@ -234,13 +234,13 @@ ISNP_API void find_extremal_edges(const stl_vector_mp<raw_point_t>
     }
 }
 
-ISNP_API void compute_edge_intersection_order(const arrangement_t     &tet_cut_result,
-                                              uint32_t                 v,
-                                              uint32_t                 u,
-                                              stl_vector_mp<uint32_t> &vert_indices)
+ISNP_API void compute_edge_intersection_order(const compact_arrangement_t &tet_cut_result,
+                                              uint32_t                     v,
+                                              uint32_t                     u,
+                                              stl_vector_mp<uint32_t>     &vert_indices)
 {
-    const auto &vertices = tet_cut_result.vertices;
-    const auto &faces    = tet_cut_result.faces;
+    const auto  vertices = tet_cut_result.vertices();
+    const auto  faces    = tet_cut_result.faces();
 
     std::array<bool, 4> edge_flag{true, true, true, true};
     edge_flag[v] = false;
@@ -307,8 +307,8 @@ ISNP_API void compute_edge_intersection_order(const arrangement_t     &tet_cut_r
         const auto  num_vert = face.vertices.size();
         for (uint32_t i = 0; i < num_vert; ++i) {
             const auto i_next  = (i + 1) % num_vert;
-            const auto vi      = tet_cut_result.vertices[fId][i];
-            const auto vi_next = tet_cut_result.vertices[fId][i_next];
+            const auto vi      = tet_cut_result.vertices()[fId][i];
+            const auto vi_next = tet_cut_result.vertices()[fId][i_next];
             // add fId to edge (vi, vi_next)
             auto iter_inserted = faces_of_edge.try_emplace(std::make_pair(vi, vi_next), std::make_pair(fId, invalid_index));
             if (!iter_inserted.second) { // inserted before
@@ -359,8 +359,8 @@ ISNP_API void compute_edge_intersection_order(const arrangement_t     &tet_cut_r
         // visit all edges of face, find edge_prev, edge_next and edge_on_vu
         for (uint32_t i = 0; i < num_vert; ++i) {
             const auto i_next  = (i + 1) % num_vert;
-            const auto vi      = tet_cut_result.vertices[f_curr][i];
-            const auto vi_next = tet_cut_result.vertices[f_curr][i_next];
+            const auto vi      = tet_cut_result.vertices()[f_curr][i];
+            const auto vi_next = tet_cut_result.vertices()[f_curr][i_next];
             if (is_on_edge_vu[vi] && !is_on_edge_vu[vi_next]) {
                 auto &two_faces  = faces_of_edge[std::make_pair(vi, vi_next)];
                 auto  other_face = (two_faces.first == f_curr) ? two_faces.second : two_faces.first;
@@ -406,14 +406,14 @@ ISNP_API void compute_edge_intersection_order(const arrangement_t     &tet_cut_r
     }
 }
 
-ISNP_API void compute_passing_face_pair(const arrangement_t &tet_cut_result,
-                                        uint32_t             v1,
-                                        uint32_t             v2,
-                                        face_with_orient_t  &face_orient1,
-                                        face_with_orient_t  &face_orient2)
+ISNP_API void compute_passing_face_pair(const compact_arrangement_t &tet_cut_result,
+                                        uint32_t                     v1,
+                                        uint32_t                     v2,
+                                        face_with_orient_t          &face_orient1,
+                                        face_with_orient_t          &face_orient2)
 {
     // find a face incident to edge v1 -> v2
-    const auto &faces = tet_cut_result.faces;
+    const auto  faces = tet_cut_result.faces();
     uint32_t    incident_face_id;
     bool        found_incident_face = false;
     for (uint32_t i = 0; i < faces.size(); ++i) {
@@ -432,7 +432,7 @@ ISNP_API void compute_passing_face_pair(const arrangement_t &tet_cut_result,
     }
     // assert: found_incident_face == true
     const auto  cell_id = faces[incident_face_id].positive_cell;
-    const auto &cell    = tet_cut_result.cells[cell_id];
+    const auto  cell    = tet_cut_result.cells()[cell_id];
 
     // find the two faces
     // 1. bounding the cell
@@ -460,10 +460,13 @@ ISNP_API void compute_passing_face_pair(const arrangement_t &tet_cut_result,
     }
 }
 
-ISNP_API void compute_passing_face(const arrangement_t &tet_cut_result, uint32_t v, uint32_t u, face_with_orient_t &face_orient)
+ISNP_API void compute_passing_face(const compact_arrangement_t &tet_cut_result,
+                                   uint32_t                     v,
+                                   uint32_t                     u,
+                                   face_with_orient_t          &face_orient)
 {
     // find a face incident to edge v -> u
-    const auto &faces = tet_cut_result.faces;
+    const auto  faces = tet_cut_result.faces();
     uint32_t    incident_face_id;
     bool        found_incident_face = false;
     for (uint32_t i = 0; i < faces.size(); ++i) {
@@ -482,7 +485,7 @@ ISNP_API void compute_passing_face(const arrangement_t &tet_cut_result, uint32_t
     }
     // assert: found_incident_face == true
     const auto  cell_id = faces[incident_face_id].positive_cell;
-    const auto &cell    = tet_cut_result.cells[cell_id];
+    const auto  cell    = tet_cut_result.cells()[cell_id];
 
     // find the face
     // 1. bounding the cell
@@ -8,7 +8,7 @@ inline auto evaluate(Routine&& tag, const constant_descriptor_t& desc, const Eig
     if constexpr (is_evaluation_routine_v<Routine>)
         return desc.value;
     else
-        return point;
+        return Eigen::Vector3d{point};
 }
 
 template <typename Routine>
@@ -19,7 +19,7 @@ inline auto evaluate(Routine&& tag, const plane_descriptor_t& desc, const Eigen:
     if constexpr (is_evaluation_routine_v<Routine>)
         return distance;
     else
-        return point - distance * normal;
+        return Eigen::Vector3d{point - distance * normal};
 }
 
 template <typename Routine>
@@ -30,46 +30,11 @@ inline auto evaluate(Routine&& tag, const sphere_descriptor_t& desc, const Eigen
     auto p_vec_norm = p_vec.norm();
     if constexpr (is_evaluation_routine_v<Routine>)
         return p_vec_norm - desc.radius;
+    else if (p_vec_norm < std::numeric_limits<double>::epsilon())
+        // every surface point is equally close to the center, so pick a fixed one
+        return Eigen::Vector3d{center + x_direction * desc.radius};
     else
-        return center + (p_vec / std::abs(p_vec_norm)) * desc.radius;
-}
-
-inline auto evaluate(const cylinder_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point)
-{
-    auto        bottom_center = vec3d_conversion(desc.bottom_origion);
-    auto        offset        = vec3d_conversion(desc.offset);
-    const auto& radius        = desc.radius;
-
-    Eigen::Vector3d ba   = -offset;
-    Eigen::Vector3d pa   = point - (bottom_center + offset);
-    auto            baba = ba.squaredNorm();
-    auto            paba = pa.dot(ba);
-    auto            x    = (pa * baba - ba * paba).norm() - radius * baba;
-    auto            y    = abs(paba - baba * 0.5) - baba * 0.5;
-    auto            x2   = x * x;
-    auto            y2   = y * y * baba;
-    auto            d    = (std::max(x, y) < 0.0) ? -std::min(x2, y2) : (((x > 0.0) ? x2 : 0.0) + ((y > 0.0) ? y2 : 0.0));
-    return sign(d) * std::sqrt(abs(d)) / baba;
-}
-
-inline auto evaluate(const cone_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point)
-{
-    Eigen::Vector3d ba = vec3d_conversion(desc.bottom_point) - vec3d_conversion(desc.top_point);
-    Eigen::Vector3d pa = point - vec3d_conversion(desc.bottom_point);
-
-    auto rba  = desc.radius2 - desc.radius1;
-    auto baba = ba.squaredNorm();
-    auto paba = pa.dot(ba) / baba;
-    auto papa = pa.squaredNorm();
-    auto x    = std::sqrt(papa - paba * paba * baba);
-    auto cax  = std::max(0.0, x - ((paba < 0.5) ? desc.radius1 : desc.radius2));
-    auto cay  = abs(paba - 0.5) - 0.5;
-    auto k    = rba * rba + baba;
-    auto f    = std::clamp((rba * (x - desc.radius1) + paba * baba) / k, 0.0, 1.0);
-    auto cbx  = x - desc.radius1 - f * rba;
-    auto cby  = paba - f;
-    auto s    = (cbx < 0.0 && cay < 0.0) ? -1.0 : 1.0;
-    return s * std::sqrt(std::min(cax * cax + cay * cay * baba, cbx * cbx + cby * cby * baba));
+        return Eigen::Vector3d{center + (p_vec / std::abs(p_vec_norm)) * desc.radius};
 }
 
 template <typename Routine>
@@ -95,7 +60,7 @@ inline auto evaluate(Routine&& tag, const box_descriptor_t& desc, const Eigen::R
             result[min_distance_face_mask] += (-dis_vec[0] <= dis_vec[1]) ? dis_vec[0] : dis_vec[1];
             return result;
         } else { // i.e. on surface or outside the box
-            return point.cwiseMin(center + half_size).cwiseMax(center - half_size);
+            return Eigen::Vector3d{point.cwiseMin(center + half_size).cwiseMax(center - half_size)};
         }
     }
 }
@@ -135,7 +100,7 @@ inline auto evaluate(Routine&& tag, const mesh_descriptor_t& desc, const Eigen::
     }
 
     if constexpr (is_evaluation_routine_v<Routine>) {
-        if (min_distance < 1e-8) { return 0; }
+        if (min_distance < 1e-8) { return 0.0; }
         if (count % 2 == 1) {
             return -min_distance;
         } else {
@@ -13,19 +13,26 @@ struct closest_point_routine_tag {
 };
 
 template <typename T>
-static constexpr bool is_process_routine_tag_v = false;
+struct is_process_routine_tag : std::false_type {
+};
 
 template <>
-static constexpr bool is_process_routine_tag_v<evaluation_routine_tag> = true;
+struct is_process_routine_tag<evaluation_routine_tag> : std::true_type {
+};
 
 template <>
-static constexpr bool is_process_routine_tag_v<closest_point_routine_tag> = true;
+struct is_process_routine_tag<closest_point_routine_tag> : std::true_type {
+};
+
+// tags are usually passed as const lvalues, so strip cv-ref qualifiers before checking
+template <typename T>
+static constexpr bool is_process_routine_tag_v = is_process_routine_tag<std::decay_t<T>>::value;
 
 template <typename T>
-static constexpr bool is_evaluation_routine_v = std::is_same_v<T, evaluation_routine_tag>;
+static constexpr bool is_evaluation_routine_v = std::is_same_v<std::decay_t<T>, evaluation_routine_tag>;
 
 template <typename T>
-static constexpr bool is_closest_point_routine_v = std::is_same_v<T, closest_point_routine_tag>;
+static constexpr bool is_closest_point_routine_v = std::is_same_v<std::decay_t<T>, closest_point_routine_tag>;
 
 static constexpr evaluation_routine_tag    evaluation_tag{};
 static constexpr closest_point_routine_tag closest_point_tag{};
@@ -55,9 +62,9 @@ inline auto triangle_sdf(Routine&&                                tag,
                                  sign(pb.dot(cb.cross(nor))), //
                                  sign(pc.dot(ac.cross(nor)))};
     if (test_vals.sum() < 2.0) {
-        std::array closest_points = {a + ba * std::clamp(ba.dot(pa) / ba.squaredNorm(), 0.0, 1.0),
-                                     b + cb * std::clamp(cb.dot(pb) / cb.squaredNorm(), 0.0, 1.0),
-                                     c + ac * std::clamp(ac.dot(pc) / ac.squaredNorm(), 0.0, 1.0)};
+        std::array<Eigen::Vector3d, 3> closest_points = {a + ba * std::clamp(ba.dot(pa) / ba.squaredNorm(), 0.0, 1.0),
+                                                         b + cb * std::clamp(cb.dot(pb) / cb.squaredNorm(), 0.0, 1.0),
+                                                         c + ac * std::clamp(ac.dot(pc) / ac.squaredNorm(), 0.0, 1.0)};
         std::array distance = {(closest_points[0] - p).norm(), (closest_points[1] - p).norm(), (closest_points[2] - p).norm()};
         auto       min_iter = std::min_element(distance.begin(), distance.end());
         if constexpr (is_evaluation_routine_v<Routine>)
@@ -69,7 +76,7 @@ inline auto triangle_sdf(Routine&&                                tag,
         if constexpr (is_evaluation_routine_v<Routine>)
             return std::abs(distance);
         else
-            return p - distance * nor.normalized();
+            return Eigen::Vector3d{p - distance * nor.normalized()};
     }
 }
 
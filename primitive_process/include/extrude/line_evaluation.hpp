@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cassert>
 #include <limits>
 #define _USE_MATH_DEFINES
 #include <cmath>
@@ -25,12 +26,6 @@ struct line_closest_param_t {
     friend inline bool operator<(const line_closest_param_t& lhs, const line_closest_param_t& rhs);
 };
 
-struct line_simple_distance_param_t {
-    double t{};
-    bool   need_refine{false};
-    bool   is_peak_value{true};
-};
-
 inline bool operator<(const line_closest_param_t& lhs, const line_closest_param_t& rhs) { return lhs.distance < rhs.distance; }
 
 // =============================================================
@@ -254,145 +249,109 @@ static constexpr auto INV_TWO_PI = 1. / TWO_PI;
         .normalized();
 }
 
+// HINT: inv_total_theta and height_per_radian are derived by the constructors, refresh them with
+// update_cached_constants() after changing the fields
 [[nodiscard]] static inline line_closest_param_t calculate_closest_param(const helixline& line, const Eigen::Vector3d& p)
 {
-    const auto h_p             = p.z();
-    const auto theta_p         = std::atan2(p.y(), p.x());
-    const auto r_p             = p.topRows<2>().norm();
-    const auto theta_intersect = line.total_theta * h_p / line.height;
-    const auto k               = (theta_intersect - theta_p) * INV_TWO_PI;
-    const auto rounded_k       = std::round(k);
-
-    // early exit case: point p is on the helix
-    if (std::abs(k - rounded_k) <= EPSILON) {
-        const auto theta = theta_p + rounded_k * TWO_PI;
-        if (theta >= 0 && theta <= line.total_theta)
-            return {p, theta / line.total_theta, 0., true};
-        else {
-            // for points two sides away from the helix, this may cause slight numerical error
-            // but it should be fine since this kind of points are rare
-            const auto clipped_theta = std::clamp(theta, 0., line.total_theta);
-            const auto t             = clipped_theta / line.total_theta;
-            const auto closest_point = evaluate(line, t);
-            const auto dist          = (closest_point - p).norm();
-            return {std::move(closest_point), std::move(t), std::move(dist), false};
+    // use phi = t * total_theta as the parameter, so that the helix is c(phi) = {r*cos(phi), r*sin(phi), k*phi}
+    // then the squared distance is D(phi) = r^2 + r_p^2 - 2*r*r_p*cos(phi-theta_p) + (k*phi-h_p)^2
+    // and the half derivative is g(phi) = r*r_p*sin(phi-theta_p) + k*(k*phi-h_p)
+    assert(line.inv_total_theta == (line.total_theta > 0 ? 1. / line.total_theta : 0.)
+           && line.height_per_radian == line.height * line.inv_total_theta);
+    const auto h_p     = p.z();
+    const auto theta_p = std::atan2(p.y(), p.x());
+    const auto r_p     = p.topRows<2>().norm();
+    const auto alpha   = line.radius * r_p;
+    const auto k       = line.height_per_radian;
+    const auto k2      = k * k;
+
+    const auto squared_distance = [&](double phi) {
+        const auto dh = k * phi - h_p;
+        return line.radius * line.radius + r_p * r_p - 2 * alpha * std::cos(phi - theta_p) + dh * dh;
+    };
+    const auto g       = [&](double phi) { return alpha * std::sin(phi - theta_p) + k * (k * phi - h_p); };
+    const auto g_deriv = [&](double phi) { return alpha * std::cos(phi - theta_p) + k2; };
+
+    // step 1: bound the search window
+    // D(phi) >= (r-r_p)^2 + k^2*(phi-phi_axial)^2, and equality holds at every phi_m = theta_p + 2*m*pi,
+    // so the global minimum cannot be farther from phi_axial than the in-domain phi_m nearest to it;
+    // the window clipped by [0, total_theta] is therefore at most two turns wide, whatever the turn count is
+    double window_start{}, window_end{std::min(line.total_theta, TWO_PI)};
+    if (k > EPSILON) {
+        const auto phi_axial = h_p / k;
+        const auto m_min     = std::ceil(-theta_p * INV_TWO_PI);
+        const auto m_max     = std::floor((line.total_theta - theta_p) * INV_TWO_PI);
+        if (m_min <= m_max) {
+            const auto m          = std::clamp(std::round((phi_axial - theta_p) * INV_TWO_PI), m_min, m_max);
+            const auto half_width = std::abs(theta_p + m * TWO_PI - phi_axial);
+            window_start          = std::max(0., phi_axial - half_width);
+            window_end            = std::min(line.total_theta, phi_axial + half_width);
+        } else {
+            // less than one turn, the whole domain is small enough
+            window_end = line.total_theta;
         }
     }
 
-    const auto times_p             = -theta_p * (1 + line.total_theta) * INV_PI;
-    const auto times_line          = line.total_theta * line.total_theta * INV_PI;
-    const auto rounded_times_start = std::ceil(times_p - 0.5);
-    const auto rounded_times_end   = std::floor(times_line + times_p - 0.5);
-
-    const auto line_theta_r   = line.total_theta * line.radius;
-    const auto inv_line_theta = 1. / line.total_theta;
-    const auto t_intersect    = std::sqrt((theta_intersect * theta_intersect * line.radius * line.radius + h_p * h_p)
-                                       / (line_theta_r * line_theta_r + line.height * line.height));
-
-    // collect all peak values of f(t) in domain [0, 1], and then find the interval which:
-    // 1. has one root as extreme minimum point
-    // 2. the root has smallest distance to t_intersect
-    line_simple_distance_param_t peak_value_param{};
-    {
-        const auto                             alpha = line.total_theta * line.radius * r_p;
-        std::vector<std::pair<double, double>> peak_values(rounded_times_end - rounded_times_start + 1 + 2);
-        peak_values.front() = {.0, -line_theta_r * r_p * std::sin(theta_p) - h_p};
-        peak_values.back()  = {1., line_theta_r * r_p * std::sin(line.total_theta - theta_p) + line.height - h_p};
-        algorithm::transform(counting_iterator<size_t>(rounded_times_start),
-                             counting_iterator<size_t>(rounded_times_end + 1),
-                             peak_values.begin() + 1,
-                             [&](size_t k_) -> std::pair<double, double> {
-                                 const auto t = (theta_p + PI2 + k_ * M_PI) * inv_line_theta;
-                                 return {std::move(t),
-                                         alpha * std::sin(t * line.total_theta - theta_p) + t * line.height - h_p};
-                             });
-        peak_value_param = algorithm::transform_reduce(
-            counting_iterator<size_t>{},
-            counting_iterator<size_t>{peak_values.size() - 1},
-            line_simple_distance_param_t{},
-            [&](const line_simple_distance_param_t& lhs, const line_simple_distance_param_t& rhs) {
-                return std::abs(lhs.t - t_intersect) < std::abs(rhs.t - t_intersect);
-            },
-            [&](size_t index) -> line_simple_distance_param_t {
-                const auto& [t0, f0] = peak_values[index];
-                const auto& [t1, f1] = peak_values[index + 1];
-                bool increasing_flag = (f0 > 0 && f1 > 0);
-                bool decreasing_flag = (f0 < 0 && f1 < 0);
-                // i.e. has a root t=t0, or distance is always increasing as t increases
-                if ((f0 >= -EPSILON && f0 <= EPSILON) || increasing_flag) return {t0, false, !increasing_flag};
-                // i.e. has a root t=t1, or distance is always decreasing as t increases
-                if ((f1 >= -EPSILON && f1 <= EPSILON) || decreasing_flag) return {t1, false, !decreasing_flag};
-                // i.e. has a root t in (0, 1)
-                // in this case, we use linear interpolation as a guess
-                return {f0 / (f0 - f1), true, true};
-            });
+    // step 2: split the window into intervals on which g is monotonic
+    // g'(phi) = 0 iff cos(phi-theta_p) = -k^2/(r*r_p), and there are at most 2 such points per turn
+    std::array<double, 8> bounds{};
+    uint32_t              bound_count{};
+    bounds[bound_count++] = window_start;
+    if (alpha > k2) {
+        const auto beta = std::acos(-k2 / alpha);
+        for (auto n = std::floor((window_start - theta_p - beta) * INV_TWO_PI); bound_count < bounds.size() - 1; n += 1.) {
+            const auto turn_start = theta_p + n * TWO_PI;
+            if (turn_start - beta >= window_end) break;
+            for (const auto peak : {turn_start - beta, turn_start + beta}) {
+                if (peak > window_start && peak < window_end && bound_count < bounds.size() - 1) bounds[bound_count++] = peak;
+            }
+        }
     }
+    bounds[bound_count++] = window_end;
+
+    // step 3: every local minimum of D is a root of g where g crosses from negative to positive,
+    // solve them by Newton iterations safeguarded by bisection, plus the window ends as candidates
+    line_closest_param_t result{};
+    double               min_squared_distance{std::numeric_limits<double>::max()};
+    const auto           update_result = [&](double phi, bool is_peak_value) {
+        const auto dist2 = squared_distance(phi);
+        if (dist2 < min_squared_distance) {
+            min_squared_distance = dist2;
+            result.t             = phi * line.inv_total_theta;
+            result.is_peak_value = is_peak_value;
+        }
+    };
 
-    // if we need to refine the guess, just do it!!!
-    if (peak_value_param.need_refine) {
-        auto&      t = peak_value_param.t;
-        double     delta_t{std::numeric_limits<double>::max()};
-        const auto alpha       = line.total_theta * line.radius * r_p;
-        const auto alpha_deriv = alpha * line.total_theta;
-        while (std::abs(delta_t) >= EPSILON) {
-            // origin equation: f(t)=theta_all*r_all*r_p*sin(t*theta_all-theta_p)+t*height_all-h_p=0
-            // derivative: f'(t)=theta_all^2*r_all*r_p*cos(t*theta_all-theta_p)+height_all=0
-            const auto f        = alpha * std::sin(t * line.total_theta - theta_p) + t * line.height - h_p;
-            const auto f_deriv  = alpha_deriv * std::cos(t * line.total_theta - theta_p) + line.height;
-            delta_t             = f / f_deriv;
-            t                  -= delta_t;
+    update_result(window_start, false);
+    update_result(window_end, false);
+    for (uint32_t i = 0; i < bound_count - 1; ++i) {
+        auto       lower = bounds[i], upper = bounds[i + 1];
+        const auto f_lower = g(lower), f_upper = g(upper);
+        if (f_lower >= 0 || f_upper <= 0) continue;
+
+        auto phi = lower + f_lower / (f_lower - f_upper) * (upper - lower);
+        for (uint32_t iter = 0; iter < 64 && upper - lower > EPSILON; ++iter) {
+            const auto f = g(phi);
+            if (f < 0)
+                lower = phi;
+            else
+                upper = phi;
+
+            const auto f_deriv = g_deriv(phi);
+            auto       next    = phi - f / f_deriv;
+            if (!(f_deriv > 0) || next <= lower || next >= upper) next = (lower + upper) * 0.5;
+            if (std::abs(next - phi) <= EPSILON) {
+                phi = next;
+                break;
+            }
+            phi = next;
         }
+        update_result(phi, true);
     }
 
     // get the final result
-    const auto closest_point = evaluate(line, peak_value_param.t);
-    const auto dist          = (closest_point - p).norm();
-    return {std::move(closest_point), peak_value_param.t, dist, peak_value_param.is_peak_value};
-
-
-    // if (true) // complex case: we have at least one (peak) minimum point in domain [0, 1]
-    // {
-    //     // see if we can get an initial guess in domain t \in [0, 1]
-    //     const auto domain_start_theta    = -h_p * line.height / line_theta_r_r;
-    //     const auto domain_theta_interval = line_total_length_square / line.height;
-    //     const auto domain_k_start        = std::round((domain_start_theta - theta_p) * INV_TWO_PI);
-    //     const auto domain_k_end          = std::round((domain_start_theta + domain_theta_interval - theta_p) * INV_TWO_PI);
-
-    //     double t_init;
-    //     if (domain_k_start <= domain_k_end) {
-    //         // we can get at least one initial guess
-    //         const auto selected_k  = std::clamp(rounded_k, domain_k_start, domain_k_end);
-    //         const auto theta_guess = theta_p + selected_k * TWO_PI;
-    //         t_init                 = (theta_guess * line.radius * line_theta_r + h_p * line.height)
-    //                  / (line_theta_r * line_theta_r + line.height * line.height);
-    //     } else {
-    //         // we got global minimum in domain [0, 1], but has no initial guess in domain [0, 1]
-    //         // that means we only have one minimum point, use linear interpolation as initial guess
-    //         const auto f0 = -line_theta_r * r_p * std::sin(theta_p) - h_p;
-    //         const auto f1 = line_theta_r * r_p * std::sin(line.total_theta - theta_p) + line.height - h_p;
-    //         t_init        = f0 / (f0 - f1);
-    //     }
-
-    //     // use Newton method to refine the guess
-    //     double     t{t_init}, delta_t{std::numeric_limits<double>::max()};
-    //     const auto alpha       = line.total_theta * line.radius * r_p;
-    //     const auto alpha_deriv = alpha * line.total_theta;
-    //     while (std::abs(delta_t) >= EPSILON) {
-    //         // origin equation: f(t)=theta_all*r_all*r_p*sin(t*theta_all-theta_p)+t*height_all-h_p=0
-    //         // derivative: f'(t)=theta_all^2*r_all*r_p*cos(t*theta_all-theta_p)+height_all=0
-    //         const auto f        = alpha * std::sin(t * line.total_theta - theta_p) + t * line.height - h_p;
-    //         const auto f_deriv  = alpha_deriv * std::cos(t * line.total_theta - theta_p) + line.height;
-    //         delta_t             = f / f_deriv;
-    //         t                  -= delta_t;
-    //     }
-
-    //     const auto closest_point = t * line.height * line.axis_direction                                  //
-    //                                + line.radius * std::cos(t * line.total_theta) * line.base_direction_u //
-    //                                + line.radius * std::sin(t * line.total_theta) * line.base_direction_v;
-    //     return {closest_point, t, (p_vec - closest_point).norm(), true};
-    // } else {
-    //     // f(t) is always increasing or decreasing in domain [0, 1]
-    //     // which means that closest point is either the start or end point of the helix
-    // }
+    result.point    = evaluate(line, result.t);
+    result.distance = (result.point - p).norm();
+    return result;
 }
 } // namespace internal
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include <macros.h>
 #include <utils/eigen_alias.hpp>
 
+#include "primitive_process.hpp"
+
 #include <primitive_descriptor.h>
 
 PE_API double evaluate(const constant_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point);
@@ -13,3 +15,28 @@ PE_API double evaluate(const cone_descriptor_t& desc, const Eigen::Ref<const Eig
 PE_API double evaluate(const box_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point);
 PE_API double evaluate(const mesh_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point);
 PE_API double evaluate(const extrude_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point);
+// instances evaluate their base through its primitive index in the blobtree
+PE_API double evaluate(const instance_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point);
+
+PE_API value_bounds_t evaluate_bounds(const constant_descriptor_t& desc, const aabb_t& aabb);
+PE_API value_bounds_t evaluate_bounds(const plane_descriptor_t& desc, const aabb_t& aabb);
+PE_API value_bounds_t evaluate_bounds(const sphere_descriptor_t& desc, const aabb_t& aabb);
+PE_API value_bounds_t evaluate_bounds(const box_descriptor_t& desc, const aabb_t& aabb);
+
+PE_API value_gradient_t evaluate_with_gradient(const constant_descriptor_t&             desc,
+                                               const Eigen::Ref<const Eigen::Vector3d>& point);
+PE_API value_gradient_t evaluate_with_gradient(const plane_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point);
+PE_API value_gradient_t evaluate_with_gradient(const sphere_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point);
+PE_API value_gradient_t evaluate_with_gradient(const cylinder_descriptor_t&             desc,
+                                               const Eigen::Ref<const Eigen::Vector3d>& point);
+PE_API value_gradient_t evaluate_with_gradient(const cone_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point);
+PE_API value_gradient_t evaluate_with_gradient(const box_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point);
+PE_API value_gradient_t evaluate_with_gradient(const instance_descriptor_t&             desc,
+                                               const Eigen::Ref<const Eigen::Vector3d>& point);
+
+PE_API closest_point_result_t closest_point(const constant_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point);
+PE_API closest_point_result_t closest_point(const plane_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point);
+PE_API closest_point_result_t closest_point(const sphere_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point);
+PE_API closest_point_result_t closest_point(const box_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point);
+PE_API closest_point_result_t closest_point(const mesh_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point);
+PE_API closest_point_result_t closest_point(const instance_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point);
\ No newline at end of file
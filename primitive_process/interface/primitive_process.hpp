@@ -3,4 +3,52 @@
 #include <macros.h>
 #include <utils/eigen_alias.hpp>
 
-PE_API double evaluate(uint32_t index, const Eigen::Ref<const Eigen::Vector3d>& point);
\ No newline at end of file
+#include <primitive_descriptor.h>
+#include <internal_structs.hpp>
+#include <blobtree.h>
+
+// conservative range of an implicit function over a region
+struct value_bounds_t {
+    double min{};
+    double max{};
+};
+
+// implicit function value together with its gradient at the same point
+struct value_gradient_t {
+    double          value{};
+    Eigen::Vector3d gradient{Eigen::Vector3d::Zero()};
+};
+
+// nearest point on the zero set of an implicit function, the distance is signed (negative inside)
+struct closest_point_result_t {
+    Eigen::Vector3d point{};
+    double          distance{};
+    uint32_t        primitive_index{invalid_primitive_index};
+};
+
+PE_API double evaluate(uint32_t index, const Eigen::Ref<const Eigen::Vector3d>& point);
+
+// without a dedicated implementation, the bounds follow from the SDF being 1-Lipschitz
+PE_API value_bounds_t evaluate_bounds(uint32_t index, const aabb_t& aabb);
+
+// without a dedicated implementation, the gradient is estimated by central differences
+PE_API value_gradient_t evaluate_with_gradient(uint32_t index, const Eigen::Ref<const Eigen::Vector3d>& point);
+// batched version: points/gradients are stored column-wise, and values/gradients should be presized to points.cols()
+PE_API void             evaluate_with_gradient(uint32_t                                 index,
+                                               const Eigen::Ref<const Eigen::Matrix3Xd>& points,
+                                               Eigen::Ref<Eigen::VectorXd>               values,
+                                               Eigen::Ref<Eigen::Matrix3Xd>              gradients);
+
+PE_API closest_point_result_t closest_point(uint32_t index, const Eigen::Ref<const Eigen::Vector3d>& point);
+PE_API void                   closest_point(uint32_t                                  index,
+                                            const Eigen::Ref<const Eigen::Matrix3Xd>& points,
+                                            Eigen::Ref<Eigen::Matrix3Xd>              closest_points,
+                                            Eigen::Ref<Eigen::VectorXd>               distances);
+// for a blobtree, the nearest closest point of the leaves that lies on the combined surface wins, otherwise the point
+// is projected along the gradient; a failed projection gives a NaN distance and invalid_primitive_index
+PE_API closest_point_result_t closest_point(const virtual_node_t& tree_node, const Eigen::Ref<const Eigen::Vector3d>& point);
+PE_API void                   closest_point(const virtual_node_t&                                  tree_node,
+                                            const Eigen::Ref<const Eigen::Matrix3Xd>&              points,
+                                            Eigen::Ref<Eigen::Matrix3Xd>                           closest_points,
+                                            Eigen::Ref<Eigen::VectorXd>                            distances,
+                                            Eigen::Ref<Eigen::Matrix<uint32_t, Eigen::Dynamic, 1>> primitive_indices);
\ No newline at end of file
@@ -1,102 +1,24 @@
 #include <internal_api.hpp>
 
 #include "primitive_process.hpp"
+#include "internal_process_api.hpp"
+#include "evaluation_impl.hpp"
 
 // =========================================================================================================================
 
-struct evaluation_routine_tag;
-struct closest_point_routine_tag;
-
-template <typename T>
-static constexpr bool is_process_routine_tag_v = false;
-
-template <>
-static constexpr bool is_process_routine_tag_v<evaluation_routine_tag> = true;
-
-template <>
-static constexpr bool is_process_routine_tag_v<closest_point_routine_tag> = true;
-
-template <typename T>
-static constexpr bool is_evaluation_routine_v = std::is_same_v<T, evaluation_routine_tag>;
-
-template <typename T>
-static constexpr bool is_closest_point_routine_v = std::is_same_v<T, closest_point_routine_tag>;
-
-// =========================================================================================================================
-
-inline auto vec3d_conversion(const raw_vector3d_t& p) { return Eigen::Map<const Eigen::Vector3d>(&p.x); }
-
-inline double sign(const double t) { return t >= 0.0 ? 1.0 : -1.0; }
-
-template <typename Routine, typename = std::enable_if_t<is_process_routine_tag_v<Routine>>>
-inline auto triangle_sdf(Routine&&                                tag,
-                         const Eigen::Ref<const Eigen::Vector3d>& p,
-                         const Eigen::Ref<const Eigen::Vector3d>& a,
-                         const Eigen::Ref<const Eigen::Vector3d>& b,
-                         const Eigen::Ref<const Eigen::Vector3d>& c)
-{
-    auto ba  = b - a;
-    auto pa  = p - a;
-    auto cb  = c - b;
-    auto pb  = p - b;
-    auto ac  = a - c;
-    auto pc  = p - c;
-    auto nor = ba.cross(ac);
-
-    Eigen::Vector3d test_vals = {sign(pa.dot(ba.cross(nor))), //
-                                 sign(pb.dot(cb.cross(nor))), //
-                                 sign(pc.dot(ac.cross(nor)))};
-    if (test_vals.sum() < 2.0) {
-        std::array closest_points = {a + ba * std::clamp(ba.dot(pa) / ba.squaredNorm(), 0.0, 1.0),
-                                     b + cb * std::clamp(cb.dot(pb) / cb.squaredNorm(), 0.0, 1.0),
-                                     c + ac * std::clamp(ac.dot(pc) / ac.squaredNorm(), 0.0, 1.0)};
-        std::array distance = {(closest_points[0] - p).norm(), (closest_points[1] - p).norm(), (closest_points[2] - p).norm()};
-        auto       min_iter = std::min_element(distance.begin(), distance.end());
-        if constexpr (is_evaluation_routine_v<Routine>)
-            return *min_iter;
-        else
-            return closest_points[std::distance(distance.begin(), min_iter)];
-    } else {
-        auto distance = pa.dot(nor) / nor.norm();
-        if constexpr (is_evaluation_routine_v<Routine>)
-            return std::abs(distance);
-        else
-            return p - distance * nor.normalized();
-    }
-}
-
-inline bool ray_intersects_triangle(const Eigen::Ref<const Eigen::Vector3d>& point,
-                                    const Eigen::Ref<const Eigen::Vector3d>& dir,
-                                    const Eigen::Ref<const Eigen::Vector3d>& v0,
-                                    const Eigen::Ref<const Eigen::Vector3d>& v1,
-                                    const Eigen::Ref<const Eigen::Vector3d>& v2)
+PE_API double evaluate(const constant_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point)
 {
-    auto e1    = v1 - v0;
-    auto e2    = v2 - v0;
-    auto s     = point - v0;
-    auto s1    = dir.cross(e2);
-    auto s2    = s.cross(e1);
-    auto coeff = 1.0 / s1.dot(e1);
-    auto t     = coeff * s2.dot(e2);
-    auto b1    = coeff * s1.dot(s);
-    auto b2    = coeff * s2.dot(dir);
-    return t >= 0 && b1 >= 0 && b2 >= 0 && (1 - b1 - b2) >= 0;
+    return evaluate(evaluation_tag, desc, point);
 }
 
-static const auto x_direction = Eigen::Vector3d{1.0, 0.0, 0.0};
-
-// =========================================================================================================================
-
-PE_API double evaluate(const constant_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point) { return desc.value; }
-
 PE_API double evaluate(const plane_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point)
 {
-    return vec3d_conversion(desc.normal).dot(point - vec3d_conversion(desc.point));
+    return evaluate(evaluation_tag, desc, point);
 }
 
 PE_API double evaluate(const sphere_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point)
 {
-    return (point - vec3d_conversion(desc.center)).norm() - desc.radius;
+    return evaluate(evaluation_tag, desc, point);
 }
 
 PE_API double evaluate(const cylinder_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point)
@@ -139,47 +61,268 @@ PE_API double evaluate(const cone_descriptor_t& desc, const Eigen::Ref<const Eig
 
 PE_API double evaluate(const box_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point)
 {
-    // HINT: this method is not ACCURATE for OUTSIDE OF THE BOX, but it saves time
+    return evaluate(evaluation_tag, desc, point);
+}
+
+PE_API double evaluate(const mesh_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point)
+{
+    return evaluate(evaluation_tag, desc, point);
+}
+
+// an instance is rigid, so its base is evaluated in the frame of the base and distances are kept as they are
+using row_major_matrix3d = Eigen::Matrix<double, 3, 3, Eigen::RowMajor>;
+
+static inline Eigen::Map<const row_major_matrix3d> instance_rotation(const instance_descriptor_t& desc)
+{
+    return Eigen::Map<const row_major_matrix3d>(desc.rotation);
+}
+
+static inline Eigen::Vector3d to_base_frame(const instance_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point)
+{
+    return instance_rotation(desc).transpose() * (point - vec3d_conversion(desc.translation));
+}
+
+PE_API double evaluate(const instance_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point)
+{
+    return evaluate(desc.base_index, to_base_frame(desc, point));
+}
+
+// =========================================================================================================================
+
+static inline value_bounds_t lipschitz_bounds(double center_value, double lipschitz_constant, const aabb_t& aabb)
+{
+    const auto radius = lipschitz_constant * 0.5 * (aabb.max - aabb.min).norm();
+    return {center_value - radius, center_value + radius};
+}
+
+PE_API value_bounds_t evaluate_bounds(const constant_descriptor_t& desc, const aabb_t& aabb)
+{
+    return {desc.value, desc.value};
+}
+
+PE_API value_bounds_t evaluate_bounds(const plane_descriptor_t& desc, const aabb_t& aabb)
+{
+    // linear function, so the extreme values are reached at the corners
+    auto            normal      = vec3d_conversion(desc.normal);
+    Eigen::Vector3d center      = 0.5 * (aabb.min + aabb.max);
+    Eigen::Vector3d half_size   = 0.5 * (aabb.max - aabb.min);
+    const auto      center_dist = normal.dot(center - vec3d_conversion(desc.point));
+    const auto      radius      = normal.cwiseAbs().dot(half_size);
+    return {center_dist - radius, center_dist + radius};
+}
+
+PE_API value_bounds_t evaluate_bounds(const sphere_descriptor_t& desc, const aabb_t& aabb)
+{
+    auto            center       = vec3d_conversion(desc.center);
+    Eigen::Vector3d nearest_vec  = center.cwiseMax(aabb.min).cwiseMin(aabb.max) - center;
+    Eigen::Vector3d farthest_vec = (aabb.min - center).cwiseAbs().cwiseMax((aabb.max - center).cwiseAbs());
+    return {nearest_vec.norm() - desc.radius, farthest_vec.norm() - desc.radius};
+}
+
+PE_API value_bounds_t evaluate_bounds(const box_descriptor_t& desc, const aabb_t& aabb)
+{
+    // same (inaccurate outside) metric as evaluate(), i.e. max_i(|p_i - c_i| - h_i), which is bounded per axis
     auto            center    = vec3d_conversion(desc.center);
     auto            half_size = vec3d_conversion(desc.half_size);
-    Eigen::Vector3d d         = (point - center).cwiseAbs() - half_size;
-    return d.maxCoeff();
+    Eigen::Vector3d lower_vec = aabb.min - center;
+    Eigen::Vector3d upper_vec = aabb.max - center;
+    Eigen::Vector3d max_abs   = lower_vec.cwiseAbs().cwiseMax(upper_vec.cwiseAbs());
+    Eigen::Vector3d min_abs   = lower_vec.cwiseMax(0.0).cwiseMax(-upper_vec);
+    return {(min_abs - half_size).maxCoeff(), (max_abs - half_size).maxCoeff()};
 }
 
-PE_API double evaluate(const mesh_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point)
+// =========================================================================================================================
+
+PE_API value_gradient_t evaluate_with_gradient(const constant_descriptor_t&             desc,
+                                               const Eigen::Ref<const Eigen::Vector3d>& point)
 {
-    // Note: There is no check for out-of-bounds access to points, indexes and faces
-    auto points  = desc.points;
-    auto indices = desc.indices;
-    auto face    = desc.faces;
-
-    double   min_distance{std::numeric_limits<double>::infinity()};
-    uint32_t count{};
-
-    for (auto i = 0; i < desc.face_number; i++) {
-        const auto& begin_index = face[i].begin_index;
-        const auto& length      = face[i].vertex_count;
-
-        auto point0 = vec3d_conversion(points[indices[begin_index]]);
-        bool flag{};
-        for (auto j = 1; j < length - 1; j++) {
-            auto point1  = vec3d_conversion(points[indices[begin_index + j]]);
-            auto point2  = vec3d_conversion(points[indices[begin_index + j + 1]]);
-            auto temp    = triangle_sdf(point, point0, point1, point2);
-            min_distance = std::min(min_distance, temp);
-            if (!flag && ray_intersects_triangle(point, x_direction, point0, point1, point2)) { flag = true; }
-        }
-        if (flag) { count++; }
+    return {desc.value, Eigen::Vector3d::Zero()};
+}
+
+PE_API value_gradient_t evaluate_with_gradient(const plane_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point)
+{
+    auto normal = vec3d_conversion(desc.normal);
+    return {normal.dot(point - vec3d_conversion(desc.point)), normal};
+}
+
+PE_API value_gradient_t evaluate_with_gradient(const sphere_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point)
+{
+    Eigen::Vector3d offset = point - vec3d_conversion(desc.center);
+    const auto      dist   = offset.norm();
+    // the gradient is undefined at the center, so just pick any unit direction there
+    if (dist < std::numeric_limits<double>::epsilon()) return {-desc.radius, x_direction};
+    return {dist - desc.radius, offset / dist};
+}
+
+// splits an offset into its component along a unit axis and its (unit) radial direction around that axis
+struct axial_decomposition_t {
+    double          axial{};
+    double          radial{};
+    Eigen::Vector3d radial_direction{};
+};
+
+static inline axial_decomposition_t decompose_axially(const Eigen::Vector3d& offset, const Eigen::Vector3d& axis)
+{
+    axial_decomposition_t result{offset.dot(axis)};
+    result.radial_direction = offset - result.axial * axis;
+    result.radial           = result.radial_direction.norm();
+    // on the axis itself every radial direction is equally valid
+    if (result.radial < std::numeric_limits<double>::epsilon())
+        result.radial_direction = axis.unitOrthogonal();
+    else
+        result.radial_direction /= result.radial;
+    return result;
+}
+
+PE_API value_gradient_t evaluate_with_gradient(const cylinder_descriptor_t&             desc,
+                                               const Eigen::Ref<const Eigen::Vector3d>& point)
+{
+    auto            bottom_center = vec3d_conversion(desc.bottom_origion);
+    auto            offset        = vec3d_conversion(desc.offset);
+    const auto      height        = offset.norm();
+    Eigen::Vector3d axis          = offset / height;
+
+    const auto [axial, radial, radial_direction] = decompose_axially(point - bottom_center, axis);
+    const auto axial_sign                        = sign(axial - 0.5 * height);
+    const auto dr                                = radial - desc.radius;
+    const auto dy                                = abs(axial - 0.5 * height) - 0.5 * height;
+
+    value_gradient_t result{evaluate(desc, point), Eigen::Vector3d::Zero()};
+    if (std::max(dr, dy) > 0.0) {
+        // outside: direction from the nearest point on the side/cap/rim
+        result.gradient = std::max(dr, 0.0) * radial_direction + std::max(dy, 0.0) * axial_sign * axis;
+        result.gradient.normalize();
+    } else {
+        // inside (or on the surface): normal of the nearest face
+        result.gradient = (dr > dy) ? radial_direction : Eigen::Vector3d(axial_sign * axis);
     }
+    return result;
+}
+
+PE_API value_gradient_t evaluate_with_gradient(const cone_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point)
+{
+    // same 2D (radial, axial) reduction as evaluate(), differentiated per candidate; f is optimal for the side candidate,
+    // so it does not contribute to the derivative
+    auto            bottom_point = vec3d_conversion(desc.bottom_point);
+    Eigen::Vector3d ba           = bottom_point - vec3d_conversion(desc.top_point);
+    const auto      length       = ba.norm();
+    Eigen::Vector3d axis         = ba / length;
 
-    if (min_distance < 1e-8) { return 0; }
-    if (count % 2 == 1) {
-        return -min_distance;
+    const auto [axial, x, radial_direction] = decompose_axially(point - bottom_point, axis);
+    const auto rba                          = desc.radius2 - desc.radius1;
+    const auto paba                         = axial / length;
+    const auto cax                          = std::max(0.0, x - ((paba < 0.5) ? desc.radius1 : desc.radius2));
+    const auto cay                          = (abs(paba - 0.5) - 0.5) * length;
+    const auto k                            = rba * rba + length * length;
+    const auto f                            = std::clamp((rba * (x - desc.radius1) + paba * length * length) / k, 0.0, 1.0);
+    const auto cbx                          = x - desc.radius1 - f * rba;
+    const auto cby                          = (paba - f) * length;
+    const auto s                            = (cbx < 0.0 && (cay < 0.0)) ? -1.0 : 1.0;
+    const auto cap_dist2                    = cax * cax + cay * cay;
+    const auto side_dist2                   = cbx * cbx + cby * cby;
+
+    value_gradient_t result{s * std::sqrt(std::min(cap_dist2, side_dist2)), Eigen::Vector3d::Zero()};
+    if (cap_dist2 <= side_dist2) {
+        const auto axial_sign = sign(paba - 0.5);
+        if (cap_dist2 > 0.0)
+            result.gradient = s * (cax * radial_direction + cay * axial_sign * axis) / std::sqrt(cap_dist2);
+        else
+            result.gradient = axial_sign * axis;
     } else {
-        return min_distance;
+        if (side_dist2 > 0.0)
+            result.gradient = s * (cbx * radial_direction + cby * axis) / std::sqrt(side_dist2);
+        else
+            result.gradient = (length * radial_direction - rba * axis) / std::sqrt(k);
+    }
+    return result;
+}
+
+PE_API value_gradient_t evaluate_with_gradient(const box_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point)
+{
+    // gradient of max_i(|p_i - c_i| - h_i), i.e. the signed axis direction of the dominant term
+    Eigen::Vector3d offset = point - vec3d_conversion(desc.center);
+    Eigen::Vector3d d      = offset.cwiseAbs() - vec3d_conversion(desc.half_size);
+    Eigen::Index    axis{};
+    const auto      value = d.maxCoeff(&axis);
+
+    value_gradient_t result{value, Eigen::Vector3d::Zero()};
+    result.gradient[axis] = sign(offset[axis]);
+    return result;
+}
+
+PE_API value_gradient_t evaluate_with_gradient(const instance_descriptor_t&             desc,
+                                               const Eigen::Ref<const Eigen::Vector3d>& point)
+{
+    auto result     = evaluate_with_gradient(desc.base_index, to_base_frame(desc, point));
+    result.gradient = instance_rotation(desc) * result.gradient;
+    return result;
+}
+
+static inline value_gradient_t central_difference_gradient(uint32_t index, const Eigen::Ref<const Eigen::Vector3d>& point)
+{
+    // step scaled with the magnitude of the point, so that the relative rounding error stays balanced
+    const auto step     = 1e-6 * std::max(1.0, point.cwiseAbs().maxCoeff());
+    const auto inv_step = 0.5 / step;
+
+    value_gradient_t result{evaluate(index, point), Eigen::Vector3d::Zero()};
+    Eigen::Vector3d  probe = point;
+    for (Eigen::Index i = 0; i < 3; ++i) {
+        probe[i]           = point[i] + step;
+        const auto forward = evaluate(index, probe);
+        probe[i]           = point[i] - step;
+        const auto back    = evaluate(index, probe);
+        probe[i]           = point[i];
+        result.gradient[i] = (forward - back) * inv_step;
     }
+    return result;
+}
+
+// =========================================================================================================================
+
+template <typename Descriptor>
+static inline closest_point_result_t closest_point_by_routine(const Descriptor&                        desc,
+                                                              const Eigen::Ref<const Eigen::Vector3d>& point)
+{
+    const auto      value  = evaluate(evaluation_tag, desc, point);
+    Eigen::Vector3d result = evaluate(closest_point_tag, desc, point);
+    return {result, sign(value) * (result - point).norm()};
+}
+
+PE_API closest_point_result_t closest_point(const constant_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point)
+{
+    // a constant field has no zero set at all
+    return {point, std::numeric_limits<double>::infinity()};
+}
+
+PE_API closest_point_result_t closest_point(const plane_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point)
+{
+    return closest_point_by_routine(desc, point);
+}
+
+PE_API closest_point_result_t closest_point(const sphere_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point)
+{
+    return closest_point_by_routine(desc, point);
+}
+
+PE_API closest_point_result_t closest_point(const box_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point)
+{
+    return closest_point_by_routine(desc, point);
+}
+
+PE_API closest_point_result_t closest_point(const mesh_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point)
+{
+    return closest_point_by_routine(desc, point);
+}
+
+PE_API closest_point_result_t closest_point(const instance_descriptor_t& desc, const Eigen::Ref<const Eigen::Vector3d>& point)
+{
+    auto result  = closest_point(desc.base_index, to_base_frame(desc, point));
+    result.point = instance_rotation(desc) * result.point + vec3d_conversion(desc.translation);
+    return result;
 }
 
+// =========================================================================================================================
+
 PE_API double evaluate(uint32_t index, const Eigen::Ref<const Eigen::Vector3d>& point)
 {
     const auto& primitive = get_primitive_node(index);
@@ -192,5 +335,307 @@ PE_API double evaluate(uint32_t index, const Eigen::Ref<const Eigen::Vector3d>&
         case PRIMITIVE_TYPE_BOX:      return evaluate(*(const box_descriptor_t*)primitive.desc, point);
         case PRIMITIVE_TYPE_MESH:     return evaluate(*(const mesh_descriptor_t*)primitive.desc, point);
         case PRIMITIVE_TYPE_EXTRUDE:  return evaluate(*(const extrude_descriptor_t*)primitive.desc, point);
+        case PRIMITIVE_TYPE_INSTANCE: return evaluate(*(const instance_descriptor_t*)primitive.desc, point);
+    }
+}
+
+PE_API value_bounds_t evaluate_bounds(uint32_t index, const aabb_t& aabb)
+{
+    const auto& primitive = get_primitive_node(index);
+    switch (primitive.type) {
+        case PRIMITIVE_TYPE_CONSTANT: return evaluate_bounds(*(const constant_descriptor_t*)primitive.desc, aabb);
+        case PRIMITIVE_TYPE_PLANE:    return evaluate_bounds(*(const plane_descriptor_t*)primitive.desc, aabb);
+        case PRIMITIVE_TYPE_SPHERE:   return evaluate_bounds(*(const sphere_descriptor_t*)primitive.desc, aabb);
+        case PRIMITIVE_TYPE_BOX:      return evaluate_bounds(*(const box_descriptor_t*)primitive.desc, aabb);
+        default:                      return lipschitz_bounds(evaluate(index, 0.5 * (aabb.min + aabb.max)), 1.0, aabb);
+    }
+}
+
+PE_API value_gradient_t evaluate_with_gradient(uint32_t index, const Eigen::Ref<const Eigen::Vector3d>& point)
+{
+    const auto& primitive = get_primitive_node(index);
+    switch (primitive.type) {
+        case PRIMITIVE_TYPE_CONSTANT: return evaluate_with_gradient(*(const constant_descriptor_t*)primitive.desc, point);
+        case PRIMITIVE_TYPE_PLANE:    return evaluate_with_gradient(*(const plane_descriptor_t*)primitive.desc, point);
+        case PRIMITIVE_TYPE_SPHERE:   return evaluate_with_gradient(*(const sphere_descriptor_t*)primitive.desc, point);
+        case PRIMITIVE_TYPE_CYLINDER: return evaluate_with_gradient(*(const cylinder_descriptor_t*)primitive.desc, point);
+        case PRIMITIVE_TYPE_CONE:     return evaluate_with_gradient(*(const cone_descriptor_t*)primitive.desc, point);
+        case PRIMITIVE_TYPE_BOX:      return evaluate_with_gradient(*(const box_descriptor_t*)primitive.desc, point);
+        case PRIMITIVE_TYPE_INSTANCE: return evaluate_with_gradient(*(const instance_descriptor_t*)primitive.desc, point);
+        default:                      return central_difference_gradient(index, point);
+    }
+}
+
+template <typename Descriptor>
+static inline void evaluate_with_gradient_batch(const Descriptor&                         desc,
+                                                const Eigen::Ref<const Eigen::Matrix3Xd>& points,
+                                                Eigen::Ref<Eigen::VectorXd>               values,
+                                                Eigen::Ref<Eigen::Matrix3Xd>              gradients)
+{
+    for (Eigen::Index i = 0; i < points.cols(); ++i) {
+        const auto [value, gradient] = evaluate_with_gradient(desc, points.col(i));
+        values[i]                    = value;
+        gradients.col(i)             = gradient;
+    }
+}
+
+PE_API void evaluate_with_gradient(uint32_t                                  index,
+                                   const Eigen::Ref<const Eigen::Matrix3Xd>& points,
+                                   Eigen::Ref<Eigen::VectorXd>               values,
+                                   Eigen::Ref<Eigen::Matrix3Xd>              gradients)
+{
+    // dispatch once per batch instead of once per point
+    const auto& primitive = get_primitive_node(index);
+    switch (primitive.type) {
+        case PRIMITIVE_TYPE_CONSTANT:
+            evaluate_with_gradient_batch(*(const constant_descriptor_t*)primitive.desc, points, values, gradients);
+            break;
+        case PRIMITIVE_TYPE_PLANE:
+            evaluate_with_gradient_batch(*(const plane_descriptor_t*)primitive.desc, points, values, gradients);
+            break;
+        case PRIMITIVE_TYPE_SPHERE:
+            evaluate_with_gradient_batch(*(const sphere_descriptor_t*)primitive.desc, points, values, gradients);
+            break;
+        case PRIMITIVE_TYPE_CYLINDER:
+            evaluate_with_gradient_batch(*(const cylinder_descriptor_t*)primitive.desc, points, values, gradients);
+            break;
+        case PRIMITIVE_TYPE_CONE:
+            evaluate_with_gradient_batch(*(const cone_descriptor_t*)primitive.desc, points, values, gradients);
+            break;
+        case PRIMITIVE_TYPE_BOX:
+            evaluate_with_gradient_batch(*(const box_descriptor_t*)primitive.desc, points, values, gradients);
+            break;
+        case PRIMITIVE_TYPE_INSTANCE:
+            evaluate_with_gradient_batch(*(const instance_descriptor_t*)primitive.desc, points, values, gradients);
+            break;
+        default:
+            for (Eigen::Index i = 0; i < points.cols(); ++i) {
+                const auto [value, gradient] = central_difference_gradient(index, points.col(i));
+                values[i]                    = value;
+                gradients.col(i)             = gradient;
+            }
+            break;
+    }
+}
+
+// =========================================================================================================================
+
+PE_API closest_point_result_t closest_point(uint32_t index, const Eigen::Ref<const Eigen::Vector3d>& point)
+{
+    closest_point_result_t result{};
+    const auto&            primitive = get_primitive_node(index);
+    switch (primitive.type) {
+        case PRIMITIVE_TYPE_CONSTANT: result = closest_point(*(const constant_descriptor_t*)primitive.desc, point); break;
+        case PRIMITIVE_TYPE_PLANE:    result = closest_point(*(const plane_descriptor_t*)primitive.desc, point); break;
+        case PRIMITIVE_TYPE_SPHERE:   result = closest_point(*(const sphere_descriptor_t*)primitive.desc, point); break;
+        case PRIMITIVE_TYPE_BOX:      result = closest_point(*(const box_descriptor_t*)primitive.desc, point); break;
+        case PRIMITIVE_TYPE_MESH:     result = closest_point(*(const mesh_descriptor_t*)primitive.desc, point); break;
+        case PRIMITIVE_TYPE_INSTANCE: result = closest_point(*(const instance_descriptor_t*)primitive.desc, point); break;
+        default:                      {
+            // exact for true SDFs: step back along the normalized gradient by the signed distance
+            const auto [value, gradient] = evaluate_with_gradient(index, point);
+            const auto gradient_norm     = gradient.norm();
+            result.point    = point;
+            if (gradient_norm > 0) result.point -= value / gradient_norm * gradient;
+            result.distance = value;
+            break;
+        }
+    }
+    result.primitive_index = index;
+    return result;
+}
+
+PE_API void closest_point(uint32_t                                  index,
+                          const Eigen::Ref<const Eigen::Matrix3Xd>& points,
+                          Eigen::Ref<Eigen::Matrix3Xd>              closest_points,
+                          Eigen::Ref<Eigen::VectorXd>               distances)
+{
+    tbb::parallel_for(tbb::blocked_range<Eigen::Index>(0, points.cols()), [&](const tbb::blocked_range<Eigen::Index>& range) {
+        for (auto i = range.begin(); i < range.end(); ++i) {
+            const auto result     = closest_point(index, points.col(i));
+            closest_points.col(i) = result.point;
+            distances[i]          = result.distance;
+        }
+    });
+}
+
+// =========================================================================================================================
+
+// combined implicit function of the subtree rooted at node_index, following the usual min/max rules of CSG on SDFs
+static double evaluate_subtree(uint32_t main_index, uint32_t node_index, const Eigen::Ref<const Eigen::Vector3d>& point)
+{
+    const auto& node = blobtree_get_node({main_index, node_index});
+    if (node.is_primitive()) return evaluate(node.primitive_index(), point);
+
+    if (node.is_nary()) {
+        const auto children = blobtree_get_node_children(node);
+        auto       value    = evaluate_subtree(main_index, children.front(), point);
+        for (const auto& child_index : children.subspan(1)) {
+            if (node.operation() == eNodeOperation::unionOp) {
+                value = std::min(value, evaluate_subtree(main_index, child_index, point));
+            } else {
+                value = std::max(value, evaluate_subtree(main_index, child_index, point));
+            }
+        }
+        return value;
+    }
+
+    const auto left_value  = evaluate_subtree(main_index, node.left_child_index, point);
+    const auto right_value = evaluate_subtree(main_index, node.right_child_index, point);
+    switch (node.operation()) {
+        case eNodeOperation::unionOp:        return std::min(left_value, right_value);
+        case eNodeOperation::intersectionOp: return std::max(left_value, right_value);
+        case eNodeOperation::differenceOp:   return std::max(left_value, -right_value);
+        default:                             throw std::runtime_error("ERROR: Node operation set to unknown.");
+    }
+}
+
+// same as evaluate_subtree(), but also returns the gradient of the combined function together with the leaf primitive
+// that is active at the point
+static value_gradient_t evaluate_subtree_with_gradient(uint32_t                                 main_index,
+                                                       uint32_t                                 node_index,
+                                                       const Eigen::Ref<const Eigen::Vector3d>& point,
+                                                       uint32_t&                                active_primitive_index)
+{
+    const auto& node = blobtree_get_node({main_index, node_index});
+    if (node.is_primitive()) {
+        active_primitive_index = node.primitive_index();
+        return evaluate_with_gradient(active_primitive_index, point);
+    }
+
+    const auto combine = [&](value_gradient_t& lhs, uint32_t& lhs_index, uint32_t child_index, eNodeOperation operation) {
+        uint32_t rhs_index{};
+        auto     rhs = evaluate_subtree_with_gradient(main_index, child_index, point, rhs_index);
+        if (operation == eNodeOperation::differenceOp) {
+            rhs.value    = -rhs.value;
+            rhs.gradient = -rhs.gradient;
+        }
+        const bool take_rhs = (operation == eNodeOperation::unionOp) ? (rhs.value < lhs.value) : (rhs.value > lhs.value);
+        if (take_rhs) {
+            lhs       = rhs;
+            lhs_index = rhs_index;
+        }
+    };
+
+    if (node.is_nary()) {
+        const auto children = blobtree_get_node_children(node);
+        auto       result   = evaluate_subtree_with_gradient(main_index, children.front(), point, active_primitive_index);
+        for (const auto& child_index : children.subspan(1))
+            combine(result, active_primitive_index, child_index, node.operation());
+        return result;
+    }
+
+    if (node.operation() != eNodeOperation::unionOp && node.operation() != eNodeOperation::intersectionOp
+        && node.operation() != eNodeOperation::differenceOp)
+        throw std::runtime_error("ERROR: Node operation set to unknown.");
+    auto result = evaluate_subtree_with_gradient(main_index, node.left_child_index, point, active_primitive_index);
+    combine(result, active_primitive_index, node.right_child_index, node.operation());
+    return result;
+}
+
+// candidate points whose combined value exceeds this are considered to be swallowed by other primitives
+static constexpr double   csg_surface_tolerance    = 1e-6;
+static constexpr uint32_t csg_projection_max_steps = 32;
+
+// used when none of the leaf candidates survives the boolean operations: Newton steps along the gradient of the combined
+// function bring the point onto the surface, after which it slides towards the foot point of the query on the local
+// tangent plane, so that the offset to the query ends up parallel to the normal; a projection that never reaches the
+// surface is reported as NaN distance and invalid primitive index
+static inline closest_point_result_t project_onto_blobtree(const virtual_node_t&                    tree_node,
+                                                           const Eigen::Ref<const Eigen::Vector3d>& point,
+                                                           double                                   tolerance)
+{
+    closest_point_result_t result{point, std::numeric_limits<double>::quiet_NaN(), invalid_primitive_index};
+    Eigen::Vector3d        current = point;
+    for (uint32_t step = 0; step < csg_projection_max_steps; ++step) {
+        uint32_t   active_primitive_index{invalid_primitive_index};
+        const auto [value, gradient] =
+            evaluate_subtree_with_gradient(tree_node.main_index, tree_node.inner_index, current, active_primitive_index);
+        const auto gradient_norm2 = gradient.squaredNorm();
+        if (gradient_norm2 < std::numeric_limits<double>::epsilon()) break;
+
+        if (std::abs(value) > tolerance) {
+            current -= value / gradient_norm2 * gradient;
+            continue;
+        }
+
+        const auto distance = (current - point).norm();
+        if (!(distance >= result.distance)) result = {current, distance, active_primitive_index};
+        const Eigen::Vector3d foot = point + gradient.dot(current - point) / gradient_norm2 * gradient;
+        if ((foot - current).norm() <= tolerance) break;
+        current = foot;
+    }
+    return result;
+}
+
+static inline closest_point_result_t closest_point_on_blobtree(const virtual_node_t&                    tree_node,
+                                                               const std::vector<uint32_t>&             primitive_indices,
+                                                               const Eigen::Ref<const Eigen::Vector3d>& point,
+                                                               std::vector<closest_point_result_t>&     candidates)
+{
+    candidates.clear();
+    for (const auto& primitive_index : primitive_indices) {
+        auto& candidate    = candidates.emplace_back(closest_point(primitive_index, point));
+        candidate.distance = std::abs(candidate.distance);
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.distance < rhs.distance;
+    });
+
+    // the nearest candidate that survives the boolean operations lies on the combined surface
+    const auto scale = csg_surface_tolerance * std::max(1.0, point.cwiseAbs().maxCoeff());
+    auto       iter  = std::find_if(candidates.begin(), candidates.end(), [&](const auto& candidate) {
+        return std::abs(evaluate_subtree(tree_node.main_index, tree_node.inner_index, candidate.point)) <= scale;
+    });
+    auto result = (iter != candidates.end()) ? *iter : project_onto_blobtree(tree_node, point, scale);
+    if (evaluate_subtree(tree_node.main_index, tree_node.inner_index, point) < 0) result.distance = -result.distance;
+    return result;
+}
+
+static inline std::vector<uint32_t> collect_primitive_indices(const virtual_node_t& tree_node)
+{
+    std::vector<uint32_t> primitive_indices{};
+    for (const auto& leaf_index : blobtree_get_leaf_nodes(tree_node.main_index)) {
+        const auto primitive_index = blobtree_get_node({tree_node.main_index, leaf_index}).primitive_index();
+        // constants do not contribute any surface
+        if (get_primitive_node(primitive_index).type == PRIMITIVE_TYPE_CONSTANT) continue;
+        primitive_indices.emplace_back(primitive_index);
+    }
+    return primitive_indices;
+}
+
+PE_API closest_point_result_t closest_point(const virtual_node_t& tree_node, const Eigen::Ref<const Eigen::Vector3d>& point)
+{
+    const auto                         primitive_indices = collect_primitive_indices(tree_node);
+    std::vector<closest_point_result_t> candidates{};
+    if (primitive_indices.empty()) return {point, std::numeric_limits<double>::infinity(), invalid_primitive_index};
+    candidates.reserve(primitive_indices.size());
+    return closest_point_on_blobtree(tree_node, primitive_indices, point, candidates);
+}
+
+PE_API void closest_point(const virtual_node_t&                                  tree_node,
+                          const Eigen::Ref<const Eigen::Matrix3Xd>&              points,
+                          Eigen::Ref<Eigen::Matrix3Xd>                           closest_points,
+                          Eigen::Ref<Eigen::VectorXd>                            distances,
+                          Eigen::Ref<Eigen::Matrix<uint32_t, Eigen::Dynamic, 1>> primitive_indices)
+{
+    // the leaves are shared by all points, so only gather them once per batch
+    const auto leaf_primitive_indices = collect_primitive_indices(tree_node);
+    if (leaf_primitive_indices.empty()) {
+        closest_points = points;
+        distances.setConstant(std::numeric_limits<double>::infinity());
+        primitive_indices.setConstant(invalid_primitive_index);
+        return;
     }
+
+    tbb::parallel_for(tbb::blocked_range<Eigen::Index>(0, points.cols()), [&](const tbb::blocked_range<Eigen::Index>& range) {
+        std::vector<closest_point_result_t> candidates{};
+        candidates.reserve(leaf_primitive_indices.size());
+        for (auto i = range.begin(); i < range.end(); ++i) {
+            const auto result     = closest_point_on_blobtree(tree_node, leaf_primitive_indices, points.col(i), candidates);
+            closest_points.col(i) = result.point;
+            distances[i]          = result.distance;
+            primitive_indices[i]  = result.primitive_index;
+        }
+    });
 }
\ No newline at end of file
@@ -1,23 +1,238 @@
-#include <timer/scoped_timer.hpp>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+
+#include <tbb/blocked_range.h>
+#include <tbb/global_control.h>
+#include <tbb/parallel_for.h>
+#include <tbb/tick_count.h>
 
 #include <internal_process_api.hpp>
+#include <extrude/solid_evaluation.hpp>
+
+// usage: primitive_process.evaluation.performance_test [output.json]
+// every (primitive, distribution, grain size, thread count) combination evaluates the same number of points one by one,
+// and the timings are written as a JSON array so that results of different builds can be diffed directly
+
+static constexpr size_t total_point_count = 1 << 20;
+static constexpr size_t grain_sizes[]     = {1, 64, 4096, 1 << 16};
+
+enum class point_distribution_t { uniform_box, near_surface, far_field };
+
+static const char* to_string(point_distribution_t distribution)
+{
+    switch (distribution) {
+        case point_distribution_t::uniform_box:  return "uniform_box";
+        case point_distribution_t::near_surface: return "near_surface";
+        case point_distribution_t::far_field:    return "far_field";
+    }
+    return "unknown";
+}
+
+struct benchmark_record_t {
+    std::string          primitive{};
+    point_distribution_t distribution{};
+    size_t               grain_size{};
+    size_t               thread_count{};
+    double               seconds{};
+    double               checksum{};
+};
+
+// =========================================================================================================================
+
+template <typename Evaluator>
+static Eigen::Matrix3Xd generate_points(const Evaluator& evaluator, const aabb_t& aabb, point_distribution_t distribution)
+{
+    std::mt19937                           engine{20240501u};
+    std::uniform_real_distribution<double> unit{0.0, 1.0};
+
+    const Eigen::Vector3d center    = 0.5 * (aabb.min + aabb.max);
+    const Eigen::Vector3d half_size = 0.5 * (aabb.max - aabb.min);
+    const double          diagonal  = 2.0 * half_size.norm();
+    auto                  uniform   = [&]() -> Eigen::Vector3d {
+        // box enlarged by 50% on each side, so that outside points are sampled as well
+        return center + 1.5 * half_size.cwiseProduct(Eigen::Vector3d{2 * unit(engine) - 1, //
+                                                                     2 * unit(engine) - 1,
+                                                                     2 * unit(engine) - 1});
+    };
+
+    Eigen::Matrix3Xd points(3, total_point_count);
+    for (size_t i = 0; i < total_point_count; ++i) {
+        switch (distribution) {
+            case point_distribution_t::uniform_box: points.col(i) = uniform(); break;
+            case point_distribution_t::near_surface: {
+                // rejection sampling inside a thin shell; give up after a few tries for primitives without a zero set
+                Eigen::Vector3d candidate = uniform();
+                for (uint32_t trial = 0; trial < 256 && std::abs(evaluator(candidate)) > 0.02 * diagonal; ++trial)
+                    candidate = uniform();
+                points.col(i) = candidate;
+                break;
+            }
+            case point_distribution_t::far_field: {
+                Eigen::Vector3d direction{2 * unit(engine) - 1, 2 * unit(engine) - 1, 2 * unit(engine) - 1};
+                if (direction.squaredNorm() < 1e-12) direction = Eigen::Vector3d::UnitX();
+                points.col(i) = center + (10.0 + 90.0 * unit(engine)) * diagonal * direction.normalized();
+                break;
+            }
+        }
+    }
+    return points;
+}
+
+template <typename Evaluator>
+static void run_primitive(std::vector<benchmark_record_t>& records,
+                          const char*                      name,
+                          const aabb_t&                    aabb,
+                          const Evaluator&                 evaluator)
+{
+    const size_t max_thread_count = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<size_t> thread_counts{};
+    for (size_t count = 1; count < max_thread_count; count *= 2) thread_counts.emplace_back(count);
+    thread_counts.emplace_back(max_thread_count);
+
+    std::vector<double> values(total_point_count);
+    for (const auto distribution :
+         {point_distribution_t::uniform_box, point_distribution_t::near_surface, point_distribution_t::far_field}) {
+        const auto points = generate_points(evaluator, aabb, distribution);
+        for (const auto grain_size : grain_sizes) {
+            for (const auto thread_count : thread_counts) {
+                tbb::global_control control{tbb::global_control::max_allowed_parallelism, thread_count};
+
+                const auto tic = tbb::tick_count::now();
+                tbb::parallel_for(tbb::blocked_range<size_t>(0, total_point_count, grain_size),
+                                  [&](const tbb::blocked_range<size_t>& range) {
+                                      for (auto i = range.begin(); i < range.end(); ++i) values[i] = evaluator(points.col(i));
+                                  });
+                const auto seconds = (tbb::tick_count::now() - tic).seconds();
+
+                // the checksum keeps the evaluations from being optimized away, and catches diverging results
+                double checksum{};
+                for (const auto& value : values) checksum += std::isfinite(value) ? value : 0.0;
+                records.emplace_back(benchmark_record_t{name, distribution, grain_size, thread_count, seconds, checksum});
+            }
+        }
+        std::cerr << name << " / " << to_string(distribution) << " done" << std::endl;
+    }
+}
 
-int main()
+static void write_json(std::ostream& out, const std::vector<benchmark_record_t>& records)
 {
-    labelled_timers_manager timer{};
+    out << "[\n";
+    for (size_t i = 0; i < records.size(); ++i) {
+        const auto& record = records[i];
+        out << "  {\"primitive\": \"" << record.primitive << "\", \"distribution\": \"" << to_string(record.distribution)
+            << "\", \"grain_size\": " << record.grain_size << ", \"threads\": " << record.thread_count
+            << ", \"evals\": " << total_point_count << ", \"seconds\": " << record.seconds
+            << ", \"ns_per_eval\": " << record.seconds * 1e9 / total_point_count
+            << ", \"evals_per_second\": " << total_point_count / record.seconds << ", \"checksum\": " << record.checksum
+            << "}" << (i + 1 < records.size() ? ",\n" : "\n");
+    }
+    out << "]" << std::endl;
+}
+
+// =========================================================================================================================
+
+int main(int argc, char** argv)
+{
+    std::vector<benchmark_record_t> records{};
+
+    const aabb_t unit_aabb{-Eigen::Vector3d::Ones(), Eigen::Vector3d::Ones()};
+
+    constant_descriptor_t constant{1.0};
+    run_primitive(records, "constant", unit_aabb, [&](const auto& p) { return evaluate(constant, p); });
+
+    plane_descriptor_t plane{
+        {0., 0., 0.},
+        {0., 0., 1.}
+    };
+    run_primitive(records, "plane", unit_aabb, [&](const auto& p) { return evaluate(plane, p); });
+
+    sphere_descriptor_t sphere{
+        {0., 0., 0.},
+        1.
+    };
+    run_primitive(records, "sphere", unit_aabb, [&](const auto& p) { return evaluate(sphere, p); });
+
+    cylinder_descriptor_t cylinder{
+        {0., 0., -1.},
+        1.,
+        {0., 0., 2.}
+    };
+    run_primitive(records, "cylinder", unit_aabb, [&](const auto& p) { return evaluate(cylinder, p); });
+
+    cone_descriptor_t cone{
+        {0., 0., 1.},
+        {0., 0., -1.},
+        0.5,
+        1.
+    };
+    run_primitive(records, "cone", unit_aabb, [&](const auto& p) { return evaluate(cone, p); });
 
     box_descriptor_t box{
         {0., 0., 0.},
         {1., 1., 1.}
     };
+    run_primitive(records, "box", unit_aabb, [&](const auto& p) { return evaluate(box, p); });
 
-    timer.push_timer("run-time under 10^6 loops (old)");
+    // unit cube as a quad mesh
+    std::array<raw_vector3d_t, 8> cube_points{
+        raw_vector3d_t{-1., -1., -1.},
+        raw_vector3d_t{1.,  -1., -1.},
+        raw_vector3d_t{1.,  1.,  -1.},
+        raw_vector3d_t{-1., 1.,  -1.},
+        raw_vector3d_t{-1., -1., 1. },
+        raw_vector3d_t{1.,  -1., 1. },
+        raw_vector3d_t{1.,  1.,  1. },
+        raw_vector3d_t{-1., 1.,  1. }
+    };
+    std::array<uint32_t, 24> cube_indices{0, 3, 2, 1, 4, 5, 6, 7, 0, 1, 5, 4, 1, 2, 6, 5, 2, 3, 7, 6, 3, 0, 4, 7};
+    std::array<polygon_face_descriptor_t, 6> cube_faces{
+        polygon_face_descriptor_t{0,  4},
+        polygon_face_descriptor_t{4,  4},
+        polygon_face_descriptor_t{8,  4},
+        polygon_face_descriptor_t{12, 4},
+        polygon_face_descriptor_t{16, 4},
+        polygon_face_descriptor_t{20, 4}
+    };
+    mesh_descriptor_t mesh{8, 6, cube_points.data(), cube_indices.data(), cube_faces.data()};
+    run_primitive(records, "mesh", unit_aabb, [&](const auto& p) { return evaluate(mesh, p); });
 
-    for (auto i = 0; i < 1'000'000; ++i) { auto result = evaluate(box, Eigen::Vector3d::Ones() * 2); }
+    // polyline extrusions have no solid evaluation yet, so only the closest-point query on the profile is measured
+    internal::polyline square_profile{};
+    square_profile.vertices      = {Eigen::Vector2d{-1., -1.},
+                                    Eigen::Vector2d{1., -1.},
+                                    Eigen::Vector2d{1., 1.},
+                                    Eigen::Vector2d{-1., 1.},
+                                    Eigen::Vector2d{-1., -1.}};
+    square_profile.thetas        = {0., 0., 0., 0.};
+    square_profile.start_indices = {0, 1, 2, 3};
+    run_primitive(records, "extrude_polyline (profile)", unit_aabb, [&](const auto& p) {
+        return internal::calculate_closest_param(square_profile, p).distance;
+    });
 
-    timer.pop_timer("run-time under 10^6 loops (old)");
+    internal::extrude_helixline helix{};
+    helix.world_to_axis.setIdentity();
+    helix.axis = internal::helixline{1., 4. * M_PI, 2.};
+    helix.profile.vertices      = {Eigen::Vector2d{-.2, -.2},
+                                   Eigen::Vector2d{.2, -.2},
+                                   Eigen::Vector2d{.2, .2},
+                                   Eigen::Vector2d{-.2, .2},
+                                   Eigen::Vector2d{-.2, -.2}};
+    helix.profile.thetas        = {0., 0., 0., 0.};
+    helix.profile.start_indices = {0, 1, 2, 3};
+    const aabb_t helix_aabb{Eigen::Vector3d{-1.2, -1.2, -.2}, Eigen::Vector3d{1.2, 1.2, 2.2}};
+    run_primitive(records, "extrude_helixline", helix_aabb, [&](const auto& p) {
+        return internal::calculate_closest_param(helix, p).distance;
+    });
 
-    timer.print();
+    if (argc > 1) {
+        std::ofstream file{argv[1]};
+        write_json(file, records);
+    } else {
+        write_json(std::cout, records);
+    }
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,171 @@
+#include <cmath>
+#include <random>
+
+#include <internal_api.hpp>
+#include <internal_process_api.hpp>
+#include <utils/test_check.hpp>
+
+// checks that an instance behaves as its base moved rigidly, that descriptors which are not rigid are refused, and that
+// base handles survive compaction until they are released
+// usage: primitive_process.instance.evaluation_test
+
+static constexpr double tolerance = 1e-9;
+
+// a cube of half size 1 around the origin, with outward quads
+static raw_vector3d_t            cube_points[8]   = {{-1., -1., -1.},
+                                                     {1., -1., -1.},
+                                                     {1., 1., -1.},
+                                                     {-1., 1., -1.},
+                                                     {-1., -1., 1.},
+                                                     {1., -1., 1.},
+                                                     {1., 1., 1.},
+                                                     {-1., 1., 1.}};
+static uint32_t                  cube_indices[24] = {0, 3, 2, 1, 4, 5, 6, 7, 0, 1, 5, 4, 1, 2, 6, 5, 2, 3, 7, 6, 3, 0, 4, 7};
+static polygon_face_descriptor_t cube_faces[6]    = {{0, 4}, {4, 4}, {8, 4}, {12, 4}, {16, 4}, {20, 4}};
+
+// rotation by angle around z, row-major
+static instance_descriptor_t rotated_instance(uint32_t base_index, double angle, const raw_vector3d_t& translation)
+{
+    const auto c = std::cos(angle), s = std::sin(angle);
+    return {base_index, {c, -s, 0., s, c, 0., 0., 0., 1.}, translation};
+}
+
+// the primitive an instance is bound to, which differs from the handle once primitives are compacted
+static uint32_t base_primitive_of(uint32_t primitive_index)
+{
+    return static_cast<const instance_descriptor_t*>(get_primitive_node(primitive_index).desc)->base_index;
+}
+
+static void test_evaluation(uint32_t base_handle)
+{
+    const auto instance = rotated_instance(base_handle, EIGEN_PI / 4, {10., 0., 0.});
+    const auto node     = blobtree_new_virtual_node(instance);
+    check(node.main_index != invalid_node_index, "a proper rotation is accepted");
+    const auto primitive_index = blobtree_get_node(node).primitive_index();
+    const auto base_index      = base_primitive_of(primitive_index);
+
+    // the half size of the box becomes |R| * (1, 1, 1)
+    const auto&           aabb      = get_aabb(primitive_index);
+    const Eigen::Vector3d half_size = {std::sqrt(2.), std::sqrt(2.), 1.};
+    check((aabb.min - (Eigen::Vector3d{10., 0., 0.} - half_size)).norm() < tolerance
+              && (aabb.max - (Eigen::Vector3d{10., 0., 0.} + half_size)).norm() < tolerance,
+          "the box of the instance is the rotated box of the base");
+
+    using row_major_matrix = Eigen::Matrix<double, 3, 3, Eigen::RowMajor>;
+    Eigen::Map<const row_major_matrix> rotation(instance.rotation);
+    const Eigen::Vector3d              translation{10., 0., 0.};
+
+    std::mt19937                           engine{20240501u};
+    std::uniform_real_distribution<double> unit{-3., 3.};
+    for (int i = 0; i < 1000; ++i) {
+        const Eigen::Vector3d point      = translation + Eigen::Vector3d{unit(engine), unit(engine), unit(engine)};
+        const Eigen::Vector3d base_point = rotation.transpose() * (point - translation);
+
+        const auto value = evaluate(primitive_index, point);
+        check(std::abs(value - evaluate(base_index, base_point)) < tolerance, "an instance keeps the distances of its base");
+
+        const auto [gradient_value, gradient] = evaluate_with_gradient(primitive_index, point);
+        const auto base_gradient              = evaluate_with_gradient(base_index, base_point).gradient;
+        check(std::abs(gradient_value - value) < tolerance && (gradient - rotation * base_gradient).norm() < 1e-6,
+              "the gradient of an instance is the rotated gradient of its base");
+
+        const auto closest = closest_point(primitive_index, point);
+        check(std::abs(std::abs(closest.distance) - std::abs(value)) < 1e-6
+                  && std::abs(evaluate(primitive_index, closest.point)) < 1e-6,
+              "the closest point of an instance lies on its surface");
+    }
+
+    // inside the rotated cube, the distance to the surface is 1 - sqrt(2) / 2 along the x axis of the scene
+    check(std::abs(std::abs(evaluate(primitive_index, Eigen::Vector3d{11., 0., 0.})) - (1. - std::sqrt(.5))) < tolerance,
+          "the instance is placed by rotation and translation");
+}
+
+static void test_rejection(uint32_t base_index)
+{
+    const auto primitive_count = get_primitive_count();
+
+    auto scaled = rotated_instance(base_index, 0., {0., 0., 0.});
+    for (auto& value : scaled.rotation) value *= 2.;
+    auto reflected         = rotated_instance(base_index, 0., {0., 0., 0.});
+    reflected.rotation[8]  = -1.;
+    auto sheared           = rotated_instance(base_index, 0., {0., 0., 0.});
+    sheared.rotation[1]    = .5;
+    auto not_finite        = rotated_instance(base_index, 0., {0., 0., 0.});
+    not_finite.rotation[4] = std::nan("");
+
+    for (const auto& desc : {scaled, reflected, sheared, not_finite})
+        check(blobtree_new_virtual_node(desc).main_index == invalid_node_index, "a non-rigid instance is refused");
+    check(get_primitive_count() == primitive_count, "refused instances add no primitive");
+
+    // rounding noise of a rotation built in floating point is still accepted
+    auto noisy = rotated_instance(base_index, .3, {0., 0., 0.});
+    noisy.rotation[0] += 1e-9;
+    const auto node = blobtree_new_virtual_node(noisy);
+    check(node.main_index != invalid_node_index, "a rotation with rounding noise is accepted");
+
+    const auto primitive_index = blobtree_get_node(node).primitive_index();
+    const auto aabb            = get_aabb(primitive_index);
+    check(!virtual_node_replace_primitive(node, reflected), "replacing by a reflected instance is refused");
+    check(get_aabb(primitive_index).min == aabb.min && get_aabb(primitive_index).max == aabb.max,
+          "a refused replacement keeps the instance");
+
+    const primitive_node_t descs[2]   = {{PRIMITIVE_TYPE_INSTANCE, &noisy}, {PRIMITIVE_TYPE_INSTANCE, &sheared}};
+    const scene_op_t       program[3] = {{SCENE_OP_PRIMITIVE, 0}, {SCENE_OP_PRIMITIVE, 1}, {SCENE_OP_UNION, 0}};
+    const auto             count_before_scene = get_primitive_count();
+    check(blobtree_new_scene(descs, program).main_index == invalid_node_index, "a scene with a sheared instance is refused");
+    check(get_primitive_count() == count_before_scene, "a refused scene adds no primitive");
+
+    // the type comes from C callers as a plain integer
+    const primitive_node_t unknown_descs[2] = {
+        {PRIMITIVE_TYPE_INSTANCE,         &noisy},
+        {static_cast<primitive_type>(64), &noisy}
+    };
+    check(blobtree_new_scene(unknown_descs, program).main_index == invalid_node_index, "a scene with an unknown type is refused");
+    check(get_primitive_count() == count_before_scene, "a scene with an unknown type adds no primitive");
+}
+
+static void test_handles(uint32_t base_handle)
+{
+    // a primitive created before the base is dropped by the compaction, which moves the base down
+    const auto sphere = blobtree_new_virtual_node(sphere_descriptor_t{{0., 0., 0.}, 1.});
+    mesh_descriptor_t cube{8, 6, cube_points, cube_indices, cube_faces};
+    const auto        moved_handle = blobtree_new_instance_base(primitive_node_t{PRIMITIVE_TYPE_MESH, &cube});
+    const auto        old_index    = get_primitive_count() - 1;
+    blobtree_free_virtual_node(sphere);
+    compact_blobtree();
+
+    const auto node = blobtree_new_virtual_node(rotated_instance(moved_handle, 0., {0., 0., 5.}));
+    check(node.main_index != invalid_node_index, "a base handle stays valid across compaction");
+    const auto base_index = base_primitive_of(blobtree_get_node(node).primitive_index());
+    check(base_index < old_index && get_primitive_node(base_index).type == PRIMITIVE_TYPE_MESH,
+          "an instance created after compaction refers to the moved base");
+    check(std::abs(evaluate(blobtree_get_node(node).primitive_index(), Eigen::Vector3d{0., 0., 5.})
+                   - evaluate(base_index, Eigen::Vector3d{0., 0., 0.}))
+              < tolerance,
+          "an instance created after compaction evaluates its base");
+    check(blobtree_new_virtual_node(rotated_instance(base_handle, 0., {0., 0., 0.})).main_index != invalid_node_index,
+          "a base created before compaction is kept");
+
+    // a released base without instances is reclaimed, and its handle is refused
+    const auto released_handle = blobtree_new_instance_base(primitive_node_t{PRIMITIVE_TYPE_MESH, &cube});
+    const auto primitive_count = get_primitive_count();
+    blobtree_release_instance_base(released_handle);
+    compact_blobtree();
+    check(get_primitive_count() == primitive_count - 1, "a released base is reclaimed by compaction");
+    check(blobtree_new_virtual_node(rotated_instance(released_handle, 0., {0., 0., 0.})).main_index == invalid_node_index,
+          "a released handle is refused");
+}
+
+int main()
+{
+    clear_blobtree();
+    mesh_descriptor_t cube{8, 6, cube_points, cube_indices, cube_faces};
+    const auto        base_index = blobtree_new_instance_base(primitive_node_t{PRIMITIVE_TYPE_MESH, &cube});
+    check(base_index != invalid_primitive_index, "a mesh can be instanced");
+
+    test_evaluation(base_index);
+    test_rejection(base_index);
+    test_handles(base_index);
+
+    return test_exit_code("instance");
+}
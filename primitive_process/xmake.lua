@@ -7,5 +7,14 @@ target("primitive_process.evaluation.performance_test")
     set_kind("binary")
     add_rules("config.indirect_predicates.flags")
     add_deps("primitive_process")
+    -- the benchmark also measures the internal extrusion kernels
+    add_includedirs("./include")
     add_files("./test/evaluation_performance_test.cpp")
+target_end()
+
+target("primitive_process.instance.evaluation_test")
+    set_kind("binary")
+    add_rules("config.indirect_predicates.flags")
+    add_deps("primitive_process")
+    add_files("./test/instance_test.cpp")
 target_end()
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+// a non-owning view over a contiguous range, i.e. the subset of C++20 std::span (with dynamic extent) that is needed
+// while the project is built as C++17
+template <typename T>
+class span
+{
+public:
+    using element_type     = T;
+    using value_type       = std::remove_cv_t<T>;
+    using size_type        = std::size_t;
+    using pointer          = T*;
+    using reference        = T&;
+    using iterator         = T*;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+
+    constexpr span() noexcept = default;
+
+    constexpr span(pointer data, size_type size) noexcept : m_data(data), m_size(size) {}
+
+    // from any contiguous container, e.g. std::vector or std::array
+    template <typename Container,
+              typename = std::enable_if_t<!std::is_same_v<std::decay_t<Container>, span> &&
+                                          std::is_convertible_v<decltype(std::data(std::declval<Container&>())), pointer>>>
+    constexpr span(Container& container) noexcept : m_data(std::data(container)), m_size(std::size(container))
+    {
+    }
+
+    constexpr iterator         begin() const noexcept { return m_data; }
+    constexpr iterator         end() const noexcept { return m_data + m_size; }
+    constexpr reverse_iterator rbegin() const noexcept { return reverse_iterator(end()); }
+    constexpr reverse_iterator rend() const noexcept { return reverse_iterator(begin()); }
+
+    constexpr pointer   data() const noexcept { return m_data; }
+    constexpr size_type size() const noexcept { return m_size; }
+    constexpr bool      empty() const noexcept { return m_size == 0; }
+
+    constexpr reference operator[](size_type index) const noexcept
+    {
+        assert(index < m_size);
+        return m_data[index];
+    }
+
+    constexpr reference front() const noexcept { return (*this)[0]; }
+
+    constexpr reference back() const noexcept { return (*this)[m_size - 1]; }
+
+    constexpr span subspan(size_type offset) const noexcept
+    {
+        assert(offset <= m_size);
+        return {m_data + offset, m_size - offset};
+    }
+
+private:
+    pointer   m_data{};
+    size_type m_size{};
+};
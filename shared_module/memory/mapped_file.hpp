@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// how the mapped bytes are going to be read, which only tunes the read-ahead of the OS
+enum class file_access_pattern_t { sequential, random };
+
+// read-only mapping of a whole file, empty if the file cannot be mapped
+class mapped_file_t
+{
+public:
+    explicit mapped_file_t(const char* path, file_access_pattern_t pattern = file_access_pattern_t::sequential) noexcept
+    {
+#if defined(_WIN32)
+        const DWORD flags = pattern == file_access_pattern_t::sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS;
+        file_handle       = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+        if (file_handle == INVALID_HANDLE_VALUE) return;
+        LARGE_INTEGER file_size{};
+        if (!GetFileSizeEx(file_handle, &file_size) || file_size.QuadPart == 0) return;
+        mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping_handle == nullptr) return;
+        const auto view = MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+        if (view == nullptr) return;
+        m_data = static_cast<const char*>(view);
+        m_size = static_cast<size_t>(file_size.QuadPart);
+#else
+        const auto file_descriptor = ::open(path, O_RDONLY);
+        if (file_descriptor < 0) return;
+        struct stat file_status {};
+        if (::fstat(file_descriptor, &file_status) == 0 && file_status.st_size > 0) {
+            const auto file_size = static_cast<size_t>(file_status.st_size);
+            const auto view      = ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+            if (view != MAP_FAILED) {
+                ::madvise(view, file_size, pattern == file_access_pattern_t::sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+                m_data = static_cast<const char*>(view);
+                m_size = file_size;
+            }
+        }
+        ::close(file_descriptor);
+#endif
+    }
+
+    mapped_file_t(const mapped_file_t&)            = delete;
+    mapped_file_t& operator=(const mapped_file_t&) = delete;
+
+    ~mapped_file_t()
+    {
+#if defined(_WIN32)
+        if (m_data != nullptr) UnmapViewOfFile(m_data);
+        if (mapping_handle != nullptr) CloseHandle(mapping_handle);
+        if (file_handle != INVALID_HANDLE_VALUE) CloseHandle(file_handle);
+#else
+        if (m_data != nullptr) ::munmap(const_cast<char*>(m_data), m_size);
+#endif
+    }
+
+    const char* data() const noexcept { return m_data; }
+
+    size_t size() const noexcept { return m_size; }
+
+private:
+    const char* m_data{};
+    size_t      m_size{};
+#if defined(_WIN32)
+    HANDLE file_handle{INVALID_HANDLE_VALUE};
+    HANDLE mapping_handle{};
+#endif
+};
\ No newline at end of file
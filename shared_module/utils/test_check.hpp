@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdlib>
+#include <iostream>
+
+// the assertions of the test binaries: a failed check is reported and counted instead of aborting, so that one run lists
+// every failure, and the exit code of the binary tells whether any check failed
+inline int test_failure_count = 0;
+
+inline void check(bool condition, const char* message)
+{
+    if (!condition) {
+        std::cout << "FAILED: " << message << std::endl;
+        test_failure_count++;
+    }
+}
+
+// to be returned from main
+inline int test_exit_code(const char* suite_name)
+{
+    if (test_failure_count == 0) std::cout << "all " << suite_name << " tests passed" << std::endl;
+    return test_failure_count == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}